@@ -1,9 +1,13 @@
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <cstdlib>
+
 #include "Head.pb.h"
 #include "ytrpc_zero_copy_stream.hpp"
 
 #include "ytlib/ytrpc/rpc_util/buffer.hpp"
+#include "ytlib/ytrpc/rpc_util/buffer_pool.hpp"
 
 inline ytlib::ytrpc::ReqHead g_req_head;
 inline boost::asio::streambuf g_req_head_buf;
@@ -32,7 +36,7 @@ BENCHMARK(BM_PB_Serialize_ostream);
 static void BM_PB_Serialize_BufferVecZeroCopyOutputStream(benchmark::State& state) {
   for (auto _ : state) {
     ytlib::ytrpc::BufferVec buffer_vec;
-    ytlib::ytrpc::BufferVecZeroCopyOutputStream<1024> os(buffer_vec);
+    ytlib::ytrpc::BufferVecZeroCopyOutputStream os(buffer_vec);
     if (!g_req_head.SerializeToZeroCopyStream(&os)) [[unlikely]]
       throw std::runtime_error("XXXXXXXXXX");
     buffer_vec.CommitLastBuf(os.LastBufSize());
@@ -40,6 +44,42 @@ static void BM_PB_Serialize_BufferVecZeroCopyOutputStream(benchmark::State& stat
 }
 BENCHMARK(BM_PB_Serialize_BufferVecZeroCopyOutputStream);
 
+// 按BufferVecZeroCopyOutputStream的块大小倍增策略，为一个msg_size大小的包申请并释放全部内存块
+template <typename AllocFunc, typename FreeFunc>
+void BufferVecAllocFree(size_t msg_size, AllocFunc alloc_func, FreeFunc free_func) {
+  std::pair<void*, size_t> buffer_vec[64];
+  size_t buffer_num = 0;
+
+  size_t block_size = ytlib::ytrpc::BufferPool::kMinBlockSize;
+  for (size_t total_size = 0; total_size < msg_size; total_size += block_size) {
+    if (buffer_num > 0) block_size = std::min(block_size << 1, ytlib::ytrpc::BufferPool::kMaxBlockSize);
+    buffer_vec[buffer_num].first = alloc_func(block_size);
+    buffer_vec[buffer_num].second = block_size;
+    static_cast<char*>(buffer_vec[buffer_num].first)[0] = '0';
+    ++buffer_num;
+  }
+
+  benchmark::DoNotOptimize(buffer_vec);
+
+  for (size_t ii = 0; ii < buffer_num; ++ii) {
+    free_func(buffer_vec[ii].first);
+  }
+}
+
+static void BM_BufferVec_Malloc(benchmark::State& state) {
+  for (auto _ : state) {
+    BufferVecAllocFree(state.range(0), std::malloc, std::free);
+  }
+}
+BENCHMARK(BM_BufferVec_Malloc)->Arg(16)->Arg(4 * 1024)->Arg(10 * 1024)->Arg(100 * 1024)->Arg(200 * 1024);
+
+static void BM_BufferVec_BufferPool(benchmark::State& state) {
+  for (auto _ : state) {
+    BufferVecAllocFree(state.range(0), ytlib::ytrpc::BufferPool::Allocate, ytlib::ytrpc::BufferPool::Deallocate);
+  }
+}
+BENCHMARK(BM_BufferVec_BufferPool)->Arg(16)->Arg(4 * 1024)->Arg(10 * 1024)->Arg(100 * 1024)->Arg(200 * 1024);
+
 static void BM_PB_Parse_ParseFromArray(benchmark::State& state) {
   for (auto _ : state) {
     ytlib::ytrpc::ReqHead req_head;
@@ -129,7 +169,7 @@ void PbBenchInit() {
   }
 
   {
-    ytlib::ytrpc::BufferVecZeroCopyOutputStream<1024> os(g_buffer_vec);
+    ytlib::ytrpc::BufferVecZeroCopyOutputStream os(g_buffer_vec);
     g_req_head.SerializeToZeroCopyStream(&os);
     g_buffer_vec.CommitLastBuf(os.LastBufSize());
   }
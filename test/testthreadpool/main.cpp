@@ -15,6 +15,7 @@
 #include "ytlib/misc/misc_macro.h"
 #include "ytlib/thread/block_queue.hpp"
 #include "ytlib/thread/channel.hpp"
+#include "ytlib/thread/work_stealing_executor.hpp"
 
 using namespace std::chrono_literals;
 
@@ -144,6 +145,67 @@ void TestYtlibChannel() {
          g_val.load(), std::chrono::duration_cast<std::chrono::milliseconds>(t).count());
 }
 
+void TestYtlibChannelExecutor() {
+  std::chrono::steady_clock::time_point start_time;
+  g_val.store(0);
+
+  {
+    ytlib::WorkStealingExecutor executor(thread_num);
+    executor.Start();
+
+    ytlib::Channel<uint32_t> ch;
+    ch.InitExecutor([](uint32_t val) { TestTask(val); }, executor);
+    ch.StartProcess();
+
+    std::this_thread::sleep_for(100ms);
+
+    start_time = std::chrono::steady_clock::now();
+
+    for (uint32_t ii = 0; ii < loop_count; ++ii) {
+      ch.Enqueue(ii);
+    }
+
+    auto t = std::chrono::steady_clock::now() - start_time;
+    printf("TestYtlibChannelExecutor post time : %lu ms\n", std::chrono::duration_cast<std::chrono::milliseconds>(t).count());
+
+    ch.StopProcess();
+  }
+
+  auto t = std::chrono::steady_clock::now() - start_time;
+  printf("TestYtlibChannelExecutor cal result: %u, cal time : %lu ms\n",
+         g_val.load(), std::chrono::duration_cast<std::chrono::milliseconds>(t).count());
+}
+
+void TestYtlibWorkStealing() {
+  std::chrono::steady_clock::time_point start_time;
+  g_val.store(0);
+
+  {
+    ytlib::WorkStealingExecutor executor(thread_num);
+    executor.Start();
+
+    std::this_thread::sleep_for(100ms);
+
+    start_time = std::chrono::steady_clock::now();
+
+    for (uint32_t ii = 0; ii < loop_count; ++ii) {
+      executor.Post([ii]() {
+        TestTask(ii);
+      });
+    }
+
+    auto t = std::chrono::steady_clock::now() - start_time;
+    printf("TestYtlibWorkStealing post time : %lu ms\n", std::chrono::duration_cast<std::chrono::milliseconds>(t).count());
+
+    executor.Stop();
+    executor.Join();
+  }
+
+  auto t = std::chrono::steady_clock::now() - start_time;
+  printf("TestYtlibWorkStealing cal result: %u, cal time : %lu ms\n",
+         g_val.load(), std::chrono::duration_cast<std::chrono::milliseconds>(t).count());
+}
+
 class TbbChannel {
  public:
   using TaskType = ytlib::Function<void()>;
@@ -278,6 +340,10 @@ int32_t main(int32_t argc, char **argv) {
 
     TestYtlibChannel();
 
+    TestYtlibChannelExecutor();
+
+    TestYtlibWorkStealing();
+
     TestTbb();
 
     printf("\n");
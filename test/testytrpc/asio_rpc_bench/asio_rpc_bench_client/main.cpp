@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <cstdlib>
 #include <string>
+#include <vector>
 
 #include <boost/asio/experimental/promise.hpp>
 
@@ -15,85 +18,117 @@
 using namespace std;
 using namespace ytlib;
 
+// 用法：asio_rpc_bench_client [并发数，默认1000] [轮数，默认100] [发送合并窗口us，默认0] [连接数，默认1，为0时依次测试1/2/4/8/16] [负载均衡策略，rr为轮询，默认最少调用数]
 int32_t main(int32_t argc, char** argv) {
   AsioDebugTool::Ins().Reset();
 
+  const uint32_t concurrency_num = (argc > 1) ? std::max(std::atoi(argv[1]), 1) : 1000;
+  const uint32_t try_num = (argc > 2) ? std::max(std::atoi(argv[2]), 1) : 100;
+  const uint32_t send_coalesce_window_us = (argc > 3) ? std::max(std::atoi(argv[3]), 0) : 0;
+  const uint32_t conn_num = (argc > 4) ? std::max(std::atoi(argv[4]), 0) : 1;
+  const bool round_robin_flag = (argc > 5) && (std::string(argv[5]) == "rr");
+
+  const std::vector<uint32_t> conn_num_vec = (conn_num == 0) ? std::vector<uint32_t>{1, 2, 4, 8, 16} : std::vector<uint32_t>{conn_num};
+
   auto asio_sys_ptr = std::make_shared<AsioExecutor>(8);
   asio_sys_ptr->EnableStopSignal();
 
-  ytrpc::AsioRpcClient::Cfg cfg;
-  cfg.svr_ep = boost::asio::ip::tcp::endpoint{boost::asio::ip::address_v4({127, 0, 0, 1}), 55399};
-  auto cli_ptr = std::make_shared<ytrpc::AsioRpcClient>(asio_sys_ptr->IO(), cfg);
+  std::vector<std::shared_ptr<ytrpc::AsioRpcClient>> cli_ptr_vec;
+  for (uint32_t cur_conn_num : conn_num_vec) {
+    ytrpc::AsioRpcClient::Cfg cfg;
+    cfg.svr_ep = boost::asio::ip::tcp::endpoint{boost::asio::ip::address_v4({127, 0, 0, 1}), 55399};
+    cfg.conn_num_per_ep = cur_conn_num;
+    cfg.lb_policy = round_robin_flag ? ytrpc::AsioRpcClient::LbPolicy::kRoundRobin : ytrpc::AsioRpcClient::LbPolicy::kLeastPending;
+    cfg.send_coalesce_window = std::chrono::microseconds(send_coalesce_window_us);
+    cli_ptr_vec.emplace_back(std::make_shared<ytrpc::AsioRpcClient>(asio_sys_ptr->IO(), cfg));
+  }
 
   asio_sys_ptr->RegisterSvrFunc(std::function<void()>(),
-                                [cli_ptr] { cli_ptr->Stop(); });
+                                [cli_ptr_vec] {
+                                  for (const auto& cli_ptr : cli_ptr_vec) cli_ptr->Stop();
+                                });
 
   asio_sys_ptr->Start();
 
-  auto co_future = boost::asio::co_spawn(
-      *(asio_sys_ptr->IO()),
-      [cli_ptr, asio_sys_ptr]() -> boost::asio::awaitable<void> {
-        auto proxy_ptr = std::make_shared<trpc::test::helloworld::GreeterProxy>(cli_ptr);
-
-        const uint32_t concurrency_num = 1000;
-        const uint32_t try_num = 100;
-
-        std::atomic_int successed_num = 0;
-        std::atomic_uint64_t total_time = 0;
-
-        std::vector<std::string> request_msgs(concurrency_num);
-        for (uint32_t ii = 0; ii < concurrency_num; ++ii) {
-          request_msgs[ii] = std::to_string(concurrency_num + ii);
-        }
-
-        uint64_t all_begin_time = GetCurTimestampMs();
-        for (uint32_t ii = 0; ii < try_num; ++ii) {
-          std::list<boost::asio::experimental::promise<void(std::exception_ptr), boost::asio::any_io_executor>> promise_list;
-          for (auto& request_msg : request_msgs) {
-            promise_list.emplace_back(
-                boost::asio::co_spawn(
-                    *(asio_sys_ptr->IO()),
-                    [&proxy_ptr, &request_msg, &successed_num, &total_time]() -> boost::asio::awaitable<void> {
-                      trpc::test::helloworld::HelloRequest req;
-                      trpc::test::helloworld::HelloReply rsp;
-                      req.set_msg(request_msg);
-
-                      auto ctx_ptr = std::make_shared<ytrpc::AsioRpcContext>();
-                      ctx_ptr->SetTimeout(std::chrono::milliseconds(1000));
-
-                      uint64_t begin_time = GetCurTimestampMs();
-                      auto status = co_await proxy_ptr->SayHello(ctx_ptr, req, rsp);
-                      uint64_t end_time = GetCurTimestampMs();
-
-                      total_time += (end_time - begin_time);
-
-                      if (status && rsp.msg() == ("Hello, " + request_msg)) {
-                        ++successed_num;
-                      } else {
-                        printf("task request error: %s\n", status.ToString().c_str());
-                      }
-
-                      co_return;
-                    },
-                    boost::asio::experimental::use_promise));
-          }
+  for (const auto& cli_ptr : cli_ptr_vec) {
+    auto co_future = boost::asio::co_spawn(
+        *(asio_sys_ptr->IO()),
+        [cli_ptr, asio_sys_ptr, concurrency_num, try_num]() -> boost::asio::awaitable<void> {
+          auto proxy_ptr = std::make_shared<trpc::test::helloworld::GreeterProxy>(cli_ptr);
 
-          auto all_promise = boost::asio::experimental::promise<>::all(std::move(promise_list));
-          co_await all_promise.async_wait(boost::asio::use_awaitable);
-        }
-        uint64_t all_end_time = GetCurTimestampMs();
+          std::atomic_int successed_num = 0;
+          std::atomic_uint64_t total_time = 0;
 
-        printf("all done... succ: %d, timecost(ms): %llu, average concurrency timecost(ms): %llu, average rpc timecost(ms): %llu\n",
-               static_cast<int>(successed_num),
-               all_end_time - all_begin_time,
-               (all_end_time - all_begin_time) / try_num,
-               static_cast<uint64_t>(total_time) / try_num / concurrency_num);
+          // 每次调用的耗时，单位us，用于统计分位数
+          std::vector<uint64_t> rpc_time_us_vec(concurrency_num * try_num);
 
-        co_return;
-      },
-      boost::asio::use_future);
+          std::vector<std::string> request_msgs(concurrency_num);
+          for (uint32_t ii = 0; ii < concurrency_num; ++ii) {
+            request_msgs[ii] = std::to_string(concurrency_num + ii);
+          }
 
-  co_future.wait();
+          uint64_t all_begin_time = GetCurTimestampMs();
+          for (uint32_t ii = 0; ii < try_num; ++ii) {
+            std::list<boost::asio::experimental::promise<void(std::exception_ptr), boost::asio::any_io_executor>> promise_list;
+            for (uint32_t jj = 0; jj < concurrency_num; ++jj) {
+              promise_list.emplace_back(
+                  boost::asio::co_spawn(
+                      *(asio_sys_ptr->IO()),
+                      [&proxy_ptr, &request_msg = request_msgs[jj], &rpc_time_us = rpc_time_us_vec[ii * concurrency_num + jj], &successed_num, &total_time]() -> boost::asio::awaitable<void> {
+                        trpc::test::helloworld::HelloRequest req;
+                        trpc::test::helloworld::HelloReply rsp;
+                        req.set_msg(request_msg);
+
+                        auto ctx_ptr = std::make_shared<ytrpc::AsioRpcContext>();
+                        ctx_ptr->SetTimeout(std::chrono::milliseconds(1000));
+
+                        auto begin_time = std::chrono::steady_clock::now();
+                        auto status = co_await proxy_ptr->SayHello(ctx_ptr, req, rsp);
+                        auto end_time = std::chrono::steady_clock::now();
+
+                        rpc_time_us = std::chrono::duration_cast<std::chrono::microseconds>(end_time - begin_time).count();
+                        total_time += rpc_time_us;
+
+                        if (status && rsp.msg() == ("Hello, " + request_msg)) {
+                          ++successed_num;
+                        } else {
+                          printf("task request error: %s\n", status.ToString().c_str());
+                        }
+
+                        co_return;
+                      },
+                      boost::asio::experimental::use_promise));
+            }
+
+            auto all_promise = boost::asio::experimental::promise<>::all(std::move(promise_list));
+            co_await all_promise.async_wait(boost::asio::use_awaitable);
+          }
+          uint64_t all_end_time = GetCurTimestampMs();
+
+          std::sort(rpc_time_us_vec.begin(), rpc_time_us_vec.end());
+          const uint64_t all_time_ms = std::max<uint64_t>(all_end_time - all_begin_time, 1);
+
+          printf("all done... conn num: %u, concurrency: %u, succ: %d, timecost(ms): %llu, average concurrency timecost(ms): %llu, average rpc timecost(us): %llu\n",
+                 cli_ptr->GetCfg().conn_num_per_ep,
+                 concurrency_num,
+                 static_cast<int>(successed_num),
+                 all_end_time - all_begin_time,
+                 (all_end_time - all_begin_time) / try_num,
+                 static_cast<uint64_t>(total_time) / try_num / concurrency_num);
+          printf("qps: %llu, p50(us): %llu, p99(us): %llu, max(us): %llu\n",
+                 static_cast<uint64_t>(successed_num) * 1000 / all_time_ms,
+                 rpc_time_us_vec[rpc_time_us_vec.size() / 2],
+                 rpc_time_us_vec[rpc_time_us_vec.size() * 99 / 100],
+                 rpc_time_us_vec.back());
+
+          co_return;
+        },
+        boost::asio::use_future);
+
+    co_future.wait();
+
+    cli_ptr->Stop();
+  }
 
   asio_sys_ptr->Stop();
   asio_sys_ptr->Join();
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstdlib>
 #include <string>
 
 #include "ytlib/boost_tools_asio/asio_debug_tools.hpp"
@@ -20,13 +22,17 @@ class GreeterImpl : public trpc::test::helloworld::Greeter {
   }
 };
 
+// 用法：asio_rpc_bench_server [发送合并窗口us，默认0]
 int32_t main(int32_t argc, char** argv) {
   AsioDebugTool::Ins().Reset();
 
+  const uint32_t send_coalesce_window_us = (argc > 1) ? std::max(std::atoi(argv[1]), 0) : 0;
+
   auto asio_sys_ptr = std::make_shared<AsioExecutor>(8);
   asio_sys_ptr->EnableStopSignal();
 
   ytrpc::AsioRpcServer::Cfg cfg;
+  cfg.send_coalesce_window = std::chrono::microseconds(send_coalesce_window_us);
   auto svr_ptr = std::make_shared<ytrpc::AsioRpcServer>(asio_sys_ptr->IO(), cfg);
 
   svr_ptr->RegisterService(std::make_shared<GreeterImpl>());
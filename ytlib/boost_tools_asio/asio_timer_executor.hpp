@@ -0,0 +1,39 @@
+/**
+ * @file asio_timer_executor.hpp
+ * @brief 定时器的asio执行器适配
+ * @note 让Timer到期的任务在asio的io_context上执行
+ * @author WT
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <memory>
+
+#include <boost/asio.hpp>
+
+#include "ytlib/boost_tools_asio/asio_tools.hpp"
+#include "ytlib/timer/timer.hpp"
+
+namespace ytlib {
+
+/**
+ * @brief 让定时器到期的任务在io_context上执行
+ * @note 每个tick到期的任务整批post一次，在同一个io线程中依次执行。需要在定时器Start之前调用
+ * @param[in] timer 定时器
+ * @param[in] io_ptr io_context
+ */
+inline void BindTimerExecutor(Timer& timer, const std::shared_ptr<boost::asio::io_context>& io_ptr) {
+  timer.RegisterExecutor([io_ptr](Timer::Task&& task) {
+    boost::asio::post(*io_ptr, std::move(task));
+  });
+
+  timer.RegisterBatchExecutor([io_ptr](Timer::TaskBatch&& batch) {
+    boost::asio::post(*io_ptr, [batch = std::move(batch)]() mutable { batch.Run(); });
+  });
+}
+
+inline void BindTimerExecutor(Timer& timer, AsioExecutor& executor) {
+  BindTimerExecutor(timer, executor.IO());
+}
+
+}  // namespace ytlib
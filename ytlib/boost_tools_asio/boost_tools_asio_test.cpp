@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include "asio_timer_executor.hpp"
 #include "asio_tools.hpp"
 #include "net_util.hpp"
 
@@ -42,4 +43,34 @@ TEST(BOOST_TOOLS_ASIO_TEST, AsioExecutor) {
   t.join();
 }
 
+TEST(BOOST_TOOLS_ASIO_TEST, TimerExecutor) {
+  auto asio_sys_ptr = std::make_shared<AsioExecutor>(2);
+  asio_sys_ptr->Start();
+
+  Timer timer;
+  timer.Initialize(Timer::Options{});
+  BindTimerExecutor(timer, *asio_sys_ptr);
+  timer.Start();
+
+  const uint32_t task_num = 1000;
+  std::atomic_uint32_t ct = 0;
+  const auto tp = timer.Now() + std::chrono::milliseconds(10);
+  for (uint32_t ii = 0; ii < task_num; ++ii) {
+    timer.ExecuteAt(tp, [&ct, asio_sys_ptr]() {
+      EXPECT_TRUE(asio_sys_ptr->IO()->get_executor().running_in_this_thread());
+      ++ct;
+    });
+  }
+
+  // 已经到期的任务也在io上执行
+  timer.ExecuteAt(timer.StartTimePoint(), [&ct]() { ++ct; });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(ct.load(), task_num + 1);
+
+  timer.Shutdown();
+  asio_sys_ptr->Stop();
+  asio_sys_ptr->Join();
+}
+
 }  // namespace ytlib
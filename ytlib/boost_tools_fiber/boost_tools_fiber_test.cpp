@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include "fiber_timer_executor.hpp"
 #include "fiber_tools.hpp"
 
 namespace ytlib {
@@ -31,6 +32,21 @@ TEST(BOOST_TOOLS_FIBER_TEST, FiberExecutor) {
   DBG_PRINT("test_sys_ptr Start");
   test_sys_ptr->Start();
 
+  // 定时器到期的任务在fiber中执行。boost fiber的work_stealing调度在一个进程中只能初始化一次，因此放在同一个用例中测试
+  Timer timer;
+  timer.Initialize(Timer::Options{});
+  BindTimerExecutor(timer, *test_sys_ptr);
+  timer.Start();
+
+  std::atomic_uint32_t timer_ct = 0;
+  const auto tp = timer.Now() + std::chrono::milliseconds(10);
+  for (int i = 0; i < 100; ++i) {
+    timer.ExecuteAt(tp, [&timer_ct]() {
+      boost::this_fiber::sleep_for(std::chrono::milliseconds(1));
+      ++timer_ct;
+    });
+  }
+
   std::thread t([test_sys_ptr] {
     std::this_thread::sleep_for(std::chrono::milliseconds(300));
     DBG_PRINT("test_sys_ptr Stop");
@@ -41,8 +57,10 @@ TEST(BOOST_TOOLS_FIBER_TEST, FiberExecutor) {
   test_sys_ptr->Join();
 
   t.join();
+  timer.Shutdown();
 
   EXPECT_EQ(static_cast<uint32_t>(ct), 9);
+  EXPECT_EQ(static_cast<uint32_t>(timer_ct), 100);
 }
 
 }  // namespace ytlib
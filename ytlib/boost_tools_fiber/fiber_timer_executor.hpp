@@ -0,0 +1,34 @@
+/**
+ * @file fiber_timer_executor.hpp
+ * @brief 定时器的fiber执行器适配
+ * @note 让Timer到期的任务在FiberExecutor上执行
+ * @author WT
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <memory>
+
+#include "ytlib/boost_tools_fiber/fiber_tools.hpp"
+#include "ytlib/timer/timer.hpp"
+
+namespace ytlib {
+
+/**
+ * @brief 让定时器到期的任务在FiberExecutor上执行
+ * @note 每个tick到期的任务整批post一次，在同一个fiber中依次执行。
+ * FiberExecutor的任务需要可以复制，因此每批任务额外分配一次内存。需要在定时器Start之前调用，executor需要比定时器后析构
+ * @param[in] timer 定时器
+ * @param[in] executor FiberExecutor
+ */
+inline void BindTimerExecutor(Timer& timer, FiberExecutor& executor) {
+  timer.RegisterExecutor([&executor](Timer::Task&& task) {
+    executor.Post([task_ptr = std::make_shared<Timer::Task>(std::move(task))]() { (*task_ptr)(); });
+  });
+
+  timer.RegisterBatchExecutor([&executor](Timer::TaskBatch&& batch) {
+    executor.Post([batch_ptr = std::make_shared<Timer::TaskBatch>(std::move(batch))]() { batch_ptr->Run(); });
+  });
+}
+
+}  // namespace ytlib
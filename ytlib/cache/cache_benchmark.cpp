@@ -0,0 +1,217 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "local_cache.hpp"
+#include "sharded_local_cache.hpp"
+
+// 统计堆内存分配次数和字节数
+static std::atomic<size_t> g_alloc_count = 0;
+static std::atomic<size_t> g_alloc_bytes = 0;
+
+[[gnu::noinline]] void* operator new(size_t size) {
+  g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size)) return ptr;
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* ptr) noexcept { std::free(ptr); }
+[[gnu::noinline]] void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace ytlib {
+
+const int kKeyNum = 100000;
+
+using TestLocalCache = LocalCache<int, std::string>;
+using TestShardedLocalCache = ShardedLocalCache<int, std::string>;
+
+const TestLocalCache::Cfg kLocalCacheCfg{
+    .capacity = kKeyNum * 2,
+    .clean_size = kKeyNum,
+    .ttl = std::chrono::seconds(100)};
+
+// 单锁保护的LocalCache，多线程90%读、10%写
+static void BM_LocalCache_MutexGetUpdate(benchmark::State& state) {
+  static std::mutex mu;
+  static TestLocalCache cache(kLocalCacheCfg);
+
+  std::mt19937 gen(static_cast<uint32_t>(state.thread_index()));
+  std::uniform_int_distribution<int> dis(0, kKeyNum - 1);
+
+  for (auto _ : state) {
+    int key = dis(gen);
+    std::lock_guard<std::mutex> lck(mu);
+    if (key % 10 == 0) {
+      cache.Update(key, "val");
+    } else {
+      benchmark::DoNotOptimize(cache.Get(key));
+    }
+  }
+}
+BENCHMARK(BM_LocalCache_MutexGetUpdate)->ThreadRange(1, 16)->UseRealTime();
+
+// ShardedLocalCache，多线程90%读、10%写
+static void BM_ShardedLocalCache_GetUpdate(benchmark::State& state) {
+  static TestShardedLocalCache cache(TestShardedLocalCache::Cfg{.local_cache_cfg = kLocalCacheCfg, .shard_num = 16});
+
+  std::mt19937 gen(static_cast<uint32_t>(state.thread_index()));
+  std::uniform_int_distribution<int> dis(0, kKeyNum - 1);
+
+  for (auto _ : state) {
+    int key = dis(gen);
+    if (key % 10 == 0) {
+      cache.Update(key, "val");
+    } else {
+      benchmark::DoNotOptimize(cache.Get(key));
+    }
+  }
+}
+BENCHMARK(BM_ShardedLocalCache_GetUpdate)->ThreadRange(1, 16)->UseRealTime();
+
+// 填满1M条目，统计每个条目平均的堆内存分配次数和字节数（包含hash桶）
+static void BM_LocalCache_Fill(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  size_t alloc_count = 0, alloc_bytes = 0;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    const size_t begin_count = g_alloc_count.load();
+    const size_t begin_bytes = g_alloc_bytes.load();
+    auto cache = std::make_unique<LocalCache<uint64_t, uint64_t>>(LocalCache<uint64_t, uint64_t>::Cfg{
+        .capacity = n + 1,
+        .clean_size = n,
+        .ttl = std::chrono::seconds(100)});
+    state.ResumeTiming();
+
+    for (uint64_t ii = 0; ii < n; ++ii)
+      cache->Update(ii * 0x9E3779B97F4A7C15ULL, ii);
+
+    state.PauseTiming();
+    alloc_count = g_alloc_count.load() - begin_count;
+    alloc_bytes = g_alloc_bytes.load() - begin_bytes;
+    cache.reset();
+    state.ResumeTiming();
+  }
+
+  state.counters["allocs_per_entry"] = static_cast<double>(alloc_count) / n;
+  state.counters["bytes_per_entry"] = static_cast<double>(alloc_bytes) / n;
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_LocalCache_Fill)->Arg(1000 * 1000)->Unit(benchmark::kMillisecond);
+
+// 保存和加载快照，数据为uint64_t到std::string
+static void BM_LocalCache_Snapshot(benchmark::State& state) {
+  using TestLocalCache = LocalCache<uint64_t, std::string>;
+  const size_t n = static_cast<size_t>(state.range(0));
+  const bool load = state.range(1);
+  const TestLocalCache::Cfg cfg{
+      .capacity = n + 1,
+      .clean_size = n,
+      .ttl = std::chrono::seconds(100)};
+  const std::string path = "bm_local_cache_snapshot.bin";
+
+  TestLocalCache cache(cfg);
+  for (uint64_t ii = 0; ii < n; ++ii)
+    cache.Update(ii * 0x9E3779B97F4A7C15ULL, "val" + std::to_string(ii));
+  if (!cache.SaveSnapshot(path)) {
+    state.SkipWithError("save snapshot failed");
+    return;
+  }
+
+  TestLocalCache cache2(cfg);
+  for (auto _ : state) {
+    if (load) {
+      benchmark::DoNotOptimize(cache2.LoadSnapshot(path));
+    } else {
+      benchmark::DoNotOptimize(cache.SaveSnapshot(path));
+    }
+  }
+
+  state.counters["file_bytes"] = static_cast<double>(std::filesystem::file_size(path));
+  state.SetItemsProcessed(state.iterations() * n);
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_LocalCache_Snapshot)
+    ->ArgsProduct({{1000 * 1000}, {0, 1}})
+    ->ArgNames({"n", "load"})
+    ->Unit(benchmark::kMillisecond);
+
+// 生成服从Zipf分布的访问序列，key的取值范围为[0, key_num)
+static std::vector<uint64_t> MakeZipfTrace(uint64_t key_num, double alpha, size_t len) {
+  std::vector<double> cdf(key_num);
+  double sum = 0;
+  for (uint64_t ii = 0; ii < key_num; ++ii) {
+    sum += 1.0 / std::pow(static_cast<double>(ii + 1), alpha);
+    cdf[ii] = sum;
+  }
+
+  std::mt19937_64 gen(12345);
+  std::uniform_real_distribution<double> dis(0, sum);
+
+  std::vector<uint64_t> trace(len);
+  for (auto& key : trace) {
+    const uint64_t rank = std::lower_bound(cdf.begin(), cdf.end(), dis(gen)) - cdf.begin();
+    // 打散rank，避免热点key在key空间中聚集
+    key = rank * 0x9E3779B97F4A7C15ULL;
+  }
+  return trace;
+}
+
+static const std::vector<uint64_t>& GetZipfTrace(int64_t alpha_percent) {
+  static std::map<int64_t, std::vector<uint64_t>> trace_map;
+  auto itr = trace_map.find(alpha_percent);
+  if (itr == trace_map.end())
+    itr = trace_map.emplace(alpha_percent, MakeZipfTrace(1000 * 1000, alpha_percent / 100.0, 4 * 1000 * 1000)).first;
+  return itr->second;
+}
+
+// 按Zipf分布的访问序列回放，未命中时回填。args: 淘汰策略，alpha*100
+static void BM_LocalCache_ZipfTrace(benchmark::State& state) {
+  const auto policy = static_cast<CacheEvictPolicy>(state.range(0));
+  const auto& trace = GetZipfTrace(state.range(1));
+
+  size_t hit = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    LocalCache<uint64_t, uint64_t> cache(LocalCache<uint64_t, uint64_t>::Cfg{
+        .capacity = 100 * 1000,
+        .clean_size = 99 * 1000,
+        .ttl = std::chrono::seconds(100),
+        .evict_policy = policy});
+    hit = 0;
+    state.ResumeTiming();
+
+    for (const uint64_t key : trace) {
+      if (cache.Get(key)) {
+        ++hit;
+      } else {
+        cache.Update(key, key);
+      }
+    }
+  }
+
+  state.counters["hit_ratio"] = static_cast<double>(hit) / trace.size();
+  state.SetItemsProcessed(state.iterations() * trace.size());
+}
+BENCHMARK(BM_LocalCache_ZipfTrace)
+    ->ArgNames({"policy", "alpha"})
+    ->ArgsProduct({{static_cast<int64_t>(CacheEvictPolicy::Lru),
+                    static_cast<int64_t>(CacheEvictPolicy::Clock),
+                    static_cast<int64_t>(CacheEvictPolicy::S3Fifo)},
+                   {60, 80, 100, 120}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace ytlib
+
+BENCHMARK_MAIN();
@@ -1,9 +1,14 @@
 #include <gtest/gtest.h>
 
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <memory>
 #include <string>
 #include <thread>
 
 #include "local_cache.hpp"
+#include "sharded_local_cache.hpp"
 
 #include "ytlib/misc/misc_macro.h"
 
@@ -87,4 +92,461 @@ TEST(CACHE_TEST, BASE_test) {
   }
 }
 
+TEST(CACHE_TEST, NODE_REUSE_test) {
+  using TestLocalCache = LocalCache<int, std::shared_ptr<int>>;
+  TestLocalCache::Cfg cfg{
+      .capacity = 100,
+      .clean_size = 50,
+      .ttl = std::chrono::seconds(100)};
+
+  auto val = std::make_shared<int>(1);
+  {
+    TestLocalCache cache(cfg);
+
+    // 反复淘汰和新增，节点被复用
+    for (int ii = 0; ii < 1000; ++ii) {
+      cache.Update(ii, val);
+      if (ii % 3 == 0) cache.Del(ii);
+    }
+    EXPECT_LE(cache.Size(), 100);
+    EXPECT_EQ(val.use_count(), cache.Size() + 1);
+
+    // 最近更新的数据依然存在
+    EXPECT_TRUE(cache.Get(998));
+    EXPECT_FALSE(cache.Get(999));
+
+    // 更新已有数据
+    auto val2 = std::make_shared<int>(2);
+    cache.Update(998, val2);
+    EXPECT_EQ(*(cache.Get(998).value()), 2);
+    EXPECT_EQ(val.use_count(), cache.Size());
+
+    cache.Clear();
+    EXPECT_EQ(cache.Size(), 0);
+    EXPECT_EQ(val.use_count(), 1);
+    EXPECT_FALSE(cache.Get(998));
+
+    for (int ii = 0; ii < 10; ++ii) cache.Update(ii, val);
+    EXPECT_EQ(cache.Size(), 10);
+  }
+  EXPECT_EQ(val.use_count(), 1);
+}
+
+TEST(CACHE_TEST, CLOCK_test) {
+  using TestLocalCache = LocalCache<int, std::string>;
+  TestLocalCache::Cfg cfg{
+      .capacity = 6,
+      .clean_size = 3,
+      .ttl = std::chrono::seconds(100),
+      .evict_policy = CacheEvictPolicy::Clock};
+
+  TestLocalCache cache(cfg);
+
+  for (int ii = 1; ii <= 5; ++ii) cache.Update(ii, "test" + std::to_string(ii));
+  EXPECT_EQ(cache.Size(), 5);
+
+  // 被访问过的数据获得一次保留机会
+  ASSERT_TRUE(cache.Get(1));
+  ASSERT_TRUE(cache.Get(2));
+
+  cache.Update(6, "test6");
+  EXPECT_EQ(cache.Size(), 3);
+
+  EXPECT_FALSE(cache.Get(3));
+  EXPECT_FALSE(cache.Get(4));
+  EXPECT_FALSE(cache.Get(5));
+
+  ASSERT_TRUE(cache.Get(1));
+  EXPECT_STREQ(cache.Get(2)->c_str(), "test2");
+  ASSERT_TRUE(cache.Get(6));
+
+  cache.Del(1);
+  EXPECT_FALSE(cache.Get(1));
+  EXPECT_EQ(cache.Size(), 2);
+}
+
+TEST(CACHE_TEST, S3FIFO_test) {
+  using TestLocalCache = LocalCache<int, std::string>;
+  TestLocalCache::Cfg cfg{
+      .capacity = 10,
+      .clean_size = 5,
+      .ttl = std::chrono::seconds(100),
+      .evict_policy = CacheEvictPolicy::S3Fifo};
+
+  TestLocalCache cache(cfg);
+
+  for (int ii = 1; ii <= 9; ++ii) cache.Update(ii, "test" + std::to_string(ii));
+  ASSERT_TRUE(cache.Get(1));
+  ASSERT_TRUE(cache.Get(2));
+
+  // 试用队列中被访问过的1、2晋升到主队列，未被访问过的3~7被淘汰
+  cache.Update(10, "test10");
+  EXPECT_EQ(cache.Size(), 5);
+  for (int ii = 3; ii <= 7; ++ii) EXPECT_FALSE(cache.Get(ii));
+
+  // 3在幽灵队列中，重新加入时直接进入主队列
+  cache.Update(3, "test3");
+  for (int ii = 11; ii <= 14; ++ii) cache.Update(ii, "test" + std::to_string(ii));
+  EXPECT_EQ(cache.Size(), 5);
+
+  EXPECT_STREQ(cache.Get(3)->c_str(), "test3");
+  ASSERT_TRUE(cache.Get(1));
+  ASSERT_TRUE(cache.Get(2));
+  ASSERT_TRUE(cache.Get(13));
+  ASSERT_TRUE(cache.Get(14));
+  for (int ii = 8; ii <= 12; ++ii) EXPECT_FALSE(cache.Get(ii));
+
+  cache.Clear();
+  EXPECT_EQ(cache.Size(), 0);
+}
+
+TEST(CACHE_TEST, WEIGHT_test) {
+  using TestLocalCache = LocalCache<int, std::string>;
+  TestLocalCache::Cfg cfg{
+      .capacity = 100,
+      .clean_size = 90,
+      .ttl = std::chrono::milliseconds(50),
+      .max_bytes = 100,
+      .clean_bytes = 50,
+      .weigher = [](const int&, const std::string& val) { return val.size(); }};
+
+  TestLocalCache cache(cfg);
+
+  for (int ii = 0; ii < 5; ++ii) cache.Update(ii, std::string(20, 'a'));
+  EXPECT_EQ(cache.Size(), 5);
+  EXPECT_EQ(cache.Bytes(), 100);
+
+  // 超过总权重上限，按LRU清理到clean_bytes以下
+  ASSERT_TRUE(cache.Get(0));
+  cache.Update(5, std::string(10, 'a'));
+  EXPECT_EQ(cache.Bytes(), 50);
+  EXPECT_EQ(cache.Size(), 3);
+  EXPECT_FALSE(cache.Get(1));
+  EXPECT_FALSE(cache.Get(2));
+  EXPECT_FALSE(cache.Get(3));
+  EXPECT_TRUE(cache.Get(0));
+  EXPECT_TRUE(cache.Get(4));
+  EXPECT_TRUE(cache.Get(5));
+
+  // 更新数据时重新计算权重
+  cache.Update(5, std::string(30, 'a'));
+  EXPECT_EQ(cache.Bytes(), 70);
+
+  cache.Del(5);
+  EXPECT_EQ(cache.Bytes(), 40);
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hit_count, 4);
+  EXPECT_EQ(stats.miss_count, 3);
+  EXPECT_EQ(stats.evict_count, 3);
+  EXPECT_EQ(stats.expire_count, 0);
+  EXPECT_EQ(stats.size, 2);
+  EXPECT_EQ(stats.bytes, 40);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  cache.CleanExpireddata();
+  stats = cache.GetStats();
+  EXPECT_EQ(stats.expire_count, 2);
+  EXPECT_EQ(stats.size, 0);
+  EXPECT_EQ(stats.bytes, 0);
+
+  // 未设置weigher时每条数据的权重为sizeof(key)+sizeof(val)
+  LocalCache<int, int> cache2(LocalCache<int, int>::Cfg{});
+  cache2.Update(1, 1);
+  EXPECT_EQ(cache2.Bytes(), sizeof(int) * 2);
+}
+
+// 只设置max_bytes时，清理目标取max_bytes的90%，不会一次清空缓存
+TEST(CACHE_TEST, MAX_BYTES_ONLY_test) {
+  using TestLocalCache = LocalCache<int, std::string>;
+  TestLocalCache::Cfg cfg{
+      .max_bytes = 1000,
+      .weigher = [](const int&, const std::string& val) { return val.size(); }};
+
+  TestLocalCache cache(cfg);
+  EXPECT_EQ(cache.GetCfg().clean_bytes, 900);
+
+  for (int ii = 0; ii < 11; ++ii) cache.Update(ii, std::string(100, 'a'));
+  EXPECT_EQ(cache.Size(), 9);
+  EXPECT_EQ(cache.Bytes(), 900);
+  EXPECT_FALSE(cache.Get(1));
+  EXPECT_TRUE(cache.Get(10));
+}
+
+// 只限制总权重时容量为上限值，hash桶和幽灵队列随数据量增长，不会按容量预先分配
+TEST(CACHE_TEST, BYTES_ONLY_test) {
+  for (auto policy : {CacheEvictPolicy::Lru, CacheEvictPolicy::S3Fifo}) {
+    using TestLocalCache = LocalCache<int, int>;
+    TestLocalCache::Cfg cfg{
+        .capacity = SIZE_MAX,
+        .ttl = std::chrono::seconds(10),
+        .evict_policy = policy,
+        .max_bytes = 8 * 10000,
+        .clean_bytes = 8 * 9000};
+
+    TestLocalCache cache(cfg);
+
+    const int n = 10000;
+    for (int ii = 0; ii < n; ++ii) cache.Update(ii, ii);
+    EXPECT_EQ(cache.Size(), n);
+    for (int ii = 0; ii < n; ++ii) {
+      auto ret = cache.Get(ii);
+      ASSERT_TRUE(ret);
+      EXPECT_EQ(*ret, ii);
+    }
+
+    cache.Update(n, n);
+    EXPECT_EQ(cache.Size(), 9000);
+    EXPECT_TRUE(cache.Get(n));
+
+    cache.Clear();
+    EXPECT_EQ(cache.Size(), 0);
+    for (int ii = 0; ii < 100; ++ii) cache.Update(ii, ii);
+    EXPECT_EQ(cache.Size(), 100);
+    EXPECT_TRUE(cache.Get(99));
+  }
+}
+
+TEST(CACHE_TEST, EXPIRE_BATCH_test) {
+  using TestLocalCache = LocalCache<int, std::string>;
+  TestLocalCache::Cfg cfg{
+      .capacity = 1000,
+      .clean_size = 900,
+      .ttl = std::chrono::milliseconds(20),
+      .expire_batch_size = 2};
+
+  TestLocalCache cache(cfg);
+
+  for (int ii = 0; ii < 10; ++ii) cache.Update(ii, "test" + std::to_string(ii));
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  cache.Update(10, "test10");
+
+  // 每次Get最多清理2条过期数据，但过期数据不会被返回
+  EXPECT_FALSE(cache.Get(10 - 1));
+  EXPECT_EQ(cache.Size(), 8);
+  EXPECT_FALSE(cache.Get(10 - 2));
+  EXPECT_EQ(cache.Size(), 5);
+  EXPECT_STREQ(cache.Get(10)->c_str(), "test10");
+  EXPECT_EQ(cache.Size(), 3);
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.expire_count, 8);
+  EXPECT_EQ(stats.hit_count, 1);
+  EXPECT_EQ(stats.miss_count, 2);
+
+  // 后台清理剩余的过期数据
+  EXPECT_EQ(cache.Maintain(1), 1);
+  EXPECT_EQ(cache.Maintain(0), 1);
+  EXPECT_EQ(cache.Maintain(0), 0);
+  EXPECT_EQ(cache.Size(), 1);
+}
+
+TEST(CACHE_TEST, SNAPSHOT_test) {
+  using TestLocalCache = LocalCache<int, std::string>;
+  TestLocalCache::Cfg cfg{
+      .capacity = 6,
+      .clean_size = 3,
+      .ttl = std::chrono::milliseconds(200)};
+
+  const std::string path = "test_local_cache_snapshot.bin";
+
+  TestLocalCache cache(cfg);
+  cache.Update(0, "test0");
+  std::this_thread::sleep_for(std::chrono::milliseconds(120));
+  for (int ii = 1; ii < 5; ++ii) cache.Update(ii, "test" + std::to_string(ii));
+  EXPECT_STREQ(cache.Get(1)->c_str(), "test1");
+  ASSERT_TRUE(cache.SaveSnapshot(path));
+
+  // 恢复后淘汰顺序为0,2,3,4,1
+  TestLocalCache cache2(cfg);
+  cache2.Update(100, "test100");
+  ASSERT_TRUE(cache2.LoadSnapshot(path));
+  EXPECT_EQ(cache2.Size(), 5);
+  EXPECT_FALSE(cache2.Get(100));
+
+  cache2.Update(5, "test5");
+  EXPECT_EQ(cache2.Size(), 3);
+  EXPECT_FALSE(cache2.Get(0));
+  EXPECT_FALSE(cache2.Get(2));
+  EXPECT_STREQ(cache2.Get(1)->c_str(), "test1");
+  EXPECT_STREQ(cache2.Get(4)->c_str(), "test4");
+
+  // 恢复剩余超时时间
+  TestLocalCache cache3(cfg);
+  ASSERT_TRUE(cache3.LoadSnapshot(path));
+  EXPECT_EQ(cache3.Size(), 5);
+  std::this_thread::sleep_for(std::chrono::milliseconds(120));
+  EXPECT_FALSE(cache3.Get(0));
+  EXPECT_STREQ(cache3.Get(3)->c_str(), "test3");
+
+  // 文件不存在或被截断时加载失败，不修改已有数据
+  EXPECT_FALSE(cache3.LoadSnapshot("not_exist_snapshot.bin"));
+  const auto file_size = std::filesystem::file_size(path);
+  std::filesystem::resize_file(path, file_size - 1);
+  EXPECT_FALSE(cache3.LoadSnapshot(path));
+  EXPECT_STREQ(cache3.Get(3)->c_str(), "test3");
+
+  std::filesystem::remove(path);
+}
+
+struct TestSnapshotPod {
+  int32_t a;
+  double b;
+};
+
+template <>
+struct IsSnapshotPod<TestSnapshotPod> : std::true_type {};
+
+struct TestNotSnapshotPod {
+  int32_t a;
+  double b;
+};
+
+enum class TestSnapshotEnum : uint8_t {
+  kA,
+  kB,
+};
+
+TEST(CACHE_TEST, SNAPSHOT_POD_test) {
+  static_assert(SnapshotSerializable<int>);
+  static_assert(SnapshotSerializable<TestSnapshotEnum>);
+  static_assert(SnapshotSerializable<std::string>);
+  static_assert(SnapshotSerializable<TestSnapshotPod>);
+  // 未显式标记的结构体不能保存到快照中
+  static_assert(!SnapshotSerializable<TestNotSnapshotPod>);
+
+  using TestLocalCache = LocalCache<int, TestSnapshotPod>;
+  const std::string path = "test_local_cache_snapshot_pod.bin";
+
+  TestLocalCache cache(TestLocalCache::Cfg{});
+  cache.Update(1, TestSnapshotPod{1, 1.5});
+  cache.Update(2, TestSnapshotPod{2, 2.5});
+  ASSERT_TRUE(cache.SaveSnapshot(path));
+
+  TestLocalCache cache2(TestLocalCache::Cfg{});
+  ASSERT_TRUE(cache2.LoadSnapshot(path));
+  EXPECT_EQ(cache2.Size(), 2);
+  EXPECT_EQ(cache2.Get(2)->a, 2);
+  EXPECT_EQ(cache2.Get(2)->b, 2.5);
+
+  std::filesystem::remove(path);
+}
+
+TEST(CACHE_TEST, SNAPSHOT_S3FIFO_test) {
+  using TestLocalCache = LocalCache<std::string, std::string>;
+  TestLocalCache::Cfg cfg{
+      .capacity = 100,
+      .clean_size = 90,
+      .evict_policy = CacheEvictPolicy::S3Fifo};
+
+  const std::string path = "test_local_cache_snapshot_s3fifo.bin";
+
+  TestLocalCache cache(cfg);
+  for (int ii = 0; ii < 200; ++ii) {
+    cache.Update("key" + std::to_string(ii), std::string(ii % 7, 'v'));
+    if (ii % 3 == 0) cache.Get("key" + std::to_string(ii));
+  }
+  ASSERT_TRUE(cache.SaveSnapshot(path));
+
+  TestLocalCache cache2(cfg);
+  ASSERT_TRUE(cache2.LoadSnapshot(path));
+  EXPECT_EQ(cache2.Size(), cache.Size());
+
+  // 两个缓存的后续淘汰行为一致
+  for (int ii = 200; ii < 300; ++ii) {
+    cache.Update("key" + std::to_string(ii), "new");
+    cache2.Update("key" + std::to_string(ii), "new");
+  }
+  for (int ii = 0; ii < 300; ++ii) {
+    const std::string key = "key" + std::to_string(ii);
+    EXPECT_EQ(cache.Get(key), cache2.Get(key)) << key;
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST(CACHE_TEST, SHARDED_test) {
+  using TestShardedLocalCache = ShardedLocalCache<int, std::string>;
+  TestShardedLocalCache::Cfg cfg{
+      .local_cache_cfg = {
+          .capacity = 1000,
+          .clean_size = 800,
+          .ttl = std::chrono::milliseconds(50)},
+      .shard_num = 4};
+
+  TestShardedLocalCache cache(cfg);
+  EXPECT_EQ(cache.ShardNum(), 4);
+
+  EXPECT_FALSE(cache.Get(1));
+
+  cache.Update(1, "test1");
+  auto ret = cache.Get(1);
+  ASSERT_TRUE(ret);
+  EXPECT_STREQ(ret->c_str(), "test1");
+
+  cache.Del(1);
+  EXPECT_FALSE(cache.Get(1));
+
+  // 多线程读写
+  const int thread_num = 4;
+  const int key_num = 200;
+  std::list<std::thread> threads;
+  for (int ii = 0; ii < thread_num; ++ii) {
+    threads.emplace(threads.end(), [&cache, ii] {
+      for (int jj = 0; jj < key_num; ++jj) {
+        int key = ii * key_num + jj;
+        cache.Update(key, std::to_string(key));
+        auto ret = cache.Get(key);
+        ASSERT_TRUE(ret);
+        EXPECT_STREQ(ret->c_str(), std::to_string(key).c_str());
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+
+  EXPECT_LE(cache.Size(), static_cast<size_t>(thread_num * key_num));
+  EXPECT_GT(cache.Size(), 0);
+
+  // 容量上限按分片生效
+  for (int ii = 0; ii < 10000; ++ii) cache.Update(ii, "val");
+  EXPECT_LE(cache.Size(), 1000);
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.size, cache.Size());
+  EXPECT_EQ(stats.hit_count, thread_num * key_num + 1);
+  EXPECT_EQ(stats.miss_count, 2);
+  EXPECT_GT(stats.evict_count, 0);
+
+  // ttl
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  EXPECT_EQ(cache.Maintain(1), cache.ShardNum());
+  cache.CleanExpireddata();
+  EXPECT_EQ(cache.Size(), 0);
+
+  cache.Update(1, "test1");
+  cache.Clear();
+  EXPECT_EQ(cache.Size(), 0);
+}
+
+// 只设置max_bytes时，每个分片的清理目标取分片总权重上限的90%
+TEST(CACHE_TEST, SHARDED_MAX_BYTES_ONLY_test) {
+  using TestShardedLocalCache = ShardedLocalCache<int, std::string>;
+  TestShardedLocalCache::Cfg cfg{
+      .local_cache_cfg = {
+          .max_bytes = 4000,
+          .weigher = [](const int&, const std::string& val) { return val.size(); }},
+      .shard_num = 4};
+
+  TestShardedLocalCache cache(cfg);
+
+  for (int ii = 0; ii < 200; ++ii) cache.Update(ii, std::string(100, 'a'));
+
+  // 每个分片最多保留10条，超过后清理到9条，不会清空
+  const auto stats = cache.GetStats();
+  EXPECT_LE(stats.bytes, 4000);
+  EXPECT_GE(stats.bytes, 9 * 4 * 100);
+  EXPECT_EQ(stats.size * 100, stats.bytes);
+  EXPECT_TRUE(cache.Get(199));
+}
+
 }  // namespace ytlib
@@ -2,24 +2,45 @@
  * @file local_cache.hpp
  * @author WT
  * @brief 本地缓存
- * @note 简易的本地缓存组件，底层使用unordered_map
+ * @note 简易的本地缓存组件，底层使用侵入式hash表和节点池
  * @date 2021-09-06
  */
 #pragma once
 
+#include <algorithm>
 #include <chrono>
-#include <list>
+#include <cinttypes>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <new>
 #include <optional>
-#include <unordered_map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "ytlib/cache/snapshot_codec.hpp"
+#include "ytlib/file/mapped_file.hpp"
 
 namespace ytlib {
 
+/// 本地缓存的淘汰策略
+enum class CacheEvictPolicy : uint8_t {
+  Lru,     ///< LRU，读取时将数据移到链表尾部
+  Clock,   ///< CLOCK，读取时只设置访问位，淘汰时给设置了访问位的数据一次机会
+  S3Fifo,  ///< S3-FIFO，新数据先进入小的试用队列，被访问过才进入主队列，读取时只增加访问计数
+};
+
 /**
  * @brief LocalCache本地缓存工具
- * @note 支持TTL和LRU淘汰，接近上限时自动清出一部分容量，底层使用unordered_map
- * key和val值是直接保存在map中的，且存在复制开销。如果val尺寸较大建议用智能指针
+ * @note 支持TTL淘汰以及LRU/CLOCK/S3-FIFO容量淘汰，数据量或总权重接近上限时自动清出一部分容量。
+ * 每个条目只占用一个节点，key、val以及hash桶链表、LRU/TTL双向链表的链接都侵入式地存放在节点中，
+ * 链接使用32位节点下标。节点按slab批量分配并通过空闲链表复用，淘汰时直接摘链，不需要再查找map。
+ * key和val值存在复制开销，如果val尺寸较大建议用智能指针
  * 非线程安全，需要上层保证线程安全
- * @tparam KeyType 值类型，需要支持比较
+ * @tparam KeyType 值类型，需要支持比较和std::hash
  * @tparam ValType 数据类型
  */
 template <typename KeyType, typename ValType>
@@ -33,24 +54,59 @@ class LocalCache {
     size_t capacity = 1000 * 1024;                                      ///< 容量上限
     size_t clean_size = 900 * 1024;                                     ///< 超过容量上限进行清理的目标size
     std::chrono::steady_clock::duration ttl = std::chrono::seconds(5);  ///< 超时时间
+    CacheEvictPolicy evict_policy = CacheEvictPolicy::Lru;              ///< 容量淘汰策略
+
+    size_t max_bytes = 0;    ///< 总权重上限，为0时不限制
+    size_t clean_bytes = 0;  ///< 超过总权重上限进行清理的目标权重，为0时取max_bytes的90%
+    std::function<size_t(const KeyType&, const ValType&)> weigher = nullptr;  ///< 权重计算函数，一般返回数据占用的字节数。为空时每条数据的权重为sizeof(key)+sizeof(val)
+
+    size_t expire_batch_size = 0;  ///< Get/Del及容量清理时每次最多清理的过期数据数，为0时不限制。限制后可以通过Maintain在后台清理剩余的过期数据
 
     /// 校验配置
     static Cfg Verify(const Cfg& verify_cfg) {
       Cfg cfg(verify_cfg);
 
+      if (cfg.capacity > kMaxCapacity) cfg.capacity = kMaxCapacity;
+
       if (cfg.clean_size >= cfg.capacity)
         cfg.clean_size = static_cast<size_t>(cfg.capacity * 0.9);
 
+      if (cfg.max_bytes && (cfg.clean_bytes == 0 || cfg.clean_bytes >= cfg.max_bytes))
+        cfg.clean_bytes = static_cast<size_t>(cfg.max_bytes * 0.9);
+
       return cfg;
     }
   };
 
+  /**
+   * @brief 统计数据
+   *
+   */
+  struct Stats {
+    uint64_t hit_count = 0;     ///< Get命中次数
+    uint64_t miss_count = 0;    ///< Get未命中次数
+    uint64_t evict_count = 0;   ///< 因数据量或总权重超过上限而淘汰的数据数
+    uint64_t expire_count = 0;  ///< 因超时而清理的数据数
+    size_t size = 0;            ///< 当前数据量
+    size_t bytes = 0;           ///< 当前总权重
+  };
+
   explicit LocalCache(const LocalCache::Cfg& cfg)
-      : cfg_(LocalCache::Cfg::Verify(cfg)),
-        data_map_(cfg_.capacity) {
+      : cfg_(LocalCache::Cfg::Verify(cfg)) {
+    uint32_t capacity_bits = 1;
+    while ((static_cast<size_t>(1) << capacity_bits) < cfg_.capacity) ++capacity_bits;
+    slab_bits_ = std::min(capacity_bits, kMaxSlabBits);
+
+    if (cfg_.evict_policy == CacheEvictPolicy::S3Fifo) {
+      small_capacity_ = std::max<size_t>(cfg_.capacity / 10, 1);
+      ghost_capacity_ = static_cast<uint32_t>(cfg_.capacity - small_capacity_);
+      while ((static_cast<size_t>(1) << max_ghost_bits_) < ghost_capacity_) ++max_ghost_bits_;
+    }
+
+    InitBuckets();
   }
 
-  ~LocalCache() = default;
+  ~LocalCache() { DestroyAll(); }
 
   LocalCache(const LocalCache&) = delete;
   LocalCache& operator=(const LocalCache&) = delete;
@@ -62,15 +118,27 @@ class LocalCache {
    * @return std::optional<ValType> 缓存数据
    */
   std::optional<ValType> Get(const KeyType& key) {
-    CleanExpireddata();
+    const auto time_line = std::chrono::steady_clock::now() - cfg_.ttl;
+    CleanExpired(time_line, cfg_.expire_batch_size);
 
-    auto finditr = data_map_.find(key);
-    if (finditr == data_map_.end()) [[unlikely]]
+    const uint32_t idx = Find(key, HashKey(key));
+    if (idx == kNil) [[unlikely]] {
+      ++stats_.miss_count;
       return std::nullopt;
+    }
 
-    ValContent& val_content = finditr->second;
-    lru_list_.splice(lru_list_.end(), lru_list_, val_content.lru_itr);
-    return val_content.val;
+    // 过期清理的数量有限制时，可能找到尚未清理的过期数据，直接清理掉
+    Node& node = At(idx);
+    if (node.load_time < time_line) [[unlikely]] {
+      EraseNode(idx);
+      ++stats_.expire_count;
+      ++stats_.miss_count;
+      return std::nullopt;
+    }
+
+    ++stats_.hit_count;
+    Touch(node, idx);
+    return node.GetEntry().val;
   }
 
   /**
@@ -83,22 +151,60 @@ class LocalCache {
   template <typename... Args>
     requires std::constructible_from<ValType, Args...>
   void Update(const KeyType& key, Args&&... args) {
-    const auto& emplace_ret = data_map_.emplace(key, std::forward<Args>(args)...);
-    ValContent& val_content = emplace_ret.first->second;
-    val_content.load_time = std::chrono::steady_clock::now();
-
-    if (emplace_ret.second) {
-      // 新增
-      val_content.lru_itr = lru_list_.emplace(lru_list_.end(), key);
-      val_content.ttl_itr = ttl_list_.emplace(ttl_list_.end(), key);
-      // 如果达到容量上限则需要清理
-      if (data_map_.size() >= cfg_.capacity) Clean();
-    } else {
+    const uint32_t hash = HashKey(key);
+    uint32_t idx = Find(key, hash);
+
+    if (idx != kNil) {
       // 更新
-      val_content.val = ValType(std::forward<Args>(args)...);
-      lru_list_.splice(lru_list_.end(), lru_list_, val_content.lru_itr);
-      ttl_list_.splice(ttl_list_.end(), ttl_list_, val_content.ttl_itr);
+      Node& node = At(idx);
+      Entry& entry = node.GetEntry();
+      entry.val = ValType(std::forward<Args>(args)...);
+      node.load_time = std::chrono::steady_clock::now();
+      stats_.bytes -= node.weight;
+      node.weight = Weigh(entry);
+      stats_.bytes += node.weight;
+      Touch(node, idx);
+      MoveToBack<&Node::ttl_link>(ttl_list_, idx);
+
+      if (NeedClean()) Clean();
+      return;
     }
+
+    // 新增
+    idx = AllocNode();
+    Node& node = At(idx);
+    try {
+      new (node.entry_buf) Entry(key, std::forward<Args>(args)...);
+    } catch (...) {
+      node.hash_next = free_head_;
+      free_head_ = idx;
+      throw;
+    }
+    node.hash = hash;
+    node.load_time = std::chrono::steady_clock::now();
+    node.freq = 0;
+    node.weight = Weigh(node.GetEntry());
+    stats_.bytes += node.weight;
+
+    if (size_ >= buckets_.size()) GrowBuckets();
+    uint32_t& bucket = buckets_[BucketIndex(hash)];
+    node.hash_next = bucket;
+    bucket = idx;
+    PushBack<&Node::ttl_link>(ttl_list_, idx);
+
+    // S3-FIFO下，最近从试用队列中淘汰过的数据直接进入主队列
+    if (cfg_.evict_policy == CacheEvictPolicy::S3Fifo && !ConsumeGhost(hash)) {
+      node.in_small = true;
+      PushBack<&Node::lru_link>(small_list_, idx);
+      ++small_size_;
+    } else {
+      node.in_small = false;
+      PushBack<&Node::lru_link>(lru_list_, idx);
+    }
+    ++size_;
+
+    // 如果达到容量上限则需要清理
+    if (NeedClean()) Clean();
   }
 
   /**
@@ -107,17 +213,13 @@ class LocalCache {
    * @param[in] key 待删除数据的key
    */
   void Del(const KeyType& key) {
-    CleanExpireddata();
+    CleanExpired(std::chrono::steady_clock::now() - cfg_.ttl, cfg_.expire_batch_size);
 
-    auto finditr = data_map_.find(key);
-    if (finditr == data_map_.end()) [[unlikely]]
+    const uint32_t idx = Find(key, HashKey(key));
+    if (idx == kNil) [[unlikely]]
       return;
 
-    ValContent& val_content = finditr->second;
-    lru_list_.erase(val_content.lru_itr);
-    ttl_list_.erase(val_content.ttl_itr);
-
-    data_map_.erase(finditr);
+    EraseNode(idx);
   }
 
   /**
@@ -125,43 +227,37 @@ class LocalCache {
    * @note 一般不需要手动调用此接口
    */
   void CleanExpireddata() {
-    std::chrono::steady_clock::time_point time_line = std::chrono::steady_clock::now() - cfg_.ttl;
-
-    auto itr = ttl_list_.begin();
-    for (; itr != ttl_list_.end(); ++itr) {
-      auto finditr = data_map_.find(*itr);  // 此处一定能找到
-      ValContent& val_content = finditr->second;
-      if (val_content.load_time < time_line) {
-        lru_list_.erase(val_content.lru_itr);
-        data_map_.erase(finditr);
-      } else {
-        break;
-      }
-    }
-    ttl_list_.erase(ttl_list_.begin(), itr);
+    CleanExpired(std::chrono::steady_clock::now() - cfg_.ttl, 0);
   }
 
   /**
-   * @brief 清理数据直到数据量小于clean_size
+   * @brief 清理最多budget条过期数据
+   * @note 配置了expire_batch_size时，可以由后台定时器周期性调用，避免过期数据长时间占用空间
+   * @param[in] budget 最多清理的数据数，为0时不限制
+   * @return size_t 实际清理的数据数
+   */
+  size_t Maintain(size_t budget) {
+    return CleanExpired(std::chrono::steady_clock::now() - cfg_.ttl, budget);
+  }
+
+  /**
+   * @brief 按淘汰策略清理数据直到数据量小于clean_size，且总权重小于clean_bytes
    * @note 一般不需要手动调用此接口
    */
   void Clean() {
-    CleanExpireddata();
-    if (data_map_.size() <= cfg_.clean_size) return;
-
-    size_t to_clean_size = data_map_.size() - cfg_.clean_size;
-    auto itr = lru_list_.begin();
-    for (; itr != lru_list_.end(); ++itr) {
-      if (to_clean_size) {
-        --to_clean_size;
-        auto finditr = data_map_.find(*itr);  // 此处一定能找到
-        ttl_list_.erase(finditr->second.ttl_itr);
-        data_map_.erase(finditr);
-      } else {
+    CleanExpired(std::chrono::steady_clock::now() - cfg_.ttl, cfg_.expire_batch_size);
+
+    switch (cfg_.evict_policy) {
+      case CacheEvictPolicy::Clock:
+        while (OverCleanTarget()) EvictClock();
+        break;
+      case CacheEvictPolicy::S3Fifo:
+        while (OverCleanTarget()) EvictS3Fifo();
+        break;
+      default:
+        while (OverCleanTarget()) EvictNode(lru_list_.head);
         break;
-      }
     }
-    lru_list_.erase(lru_list_.begin(), itr);
   }
 
   /**
@@ -169,18 +265,243 @@ class LocalCache {
    *
    */
   void Clear() {
-    lru_list_.clear();
-    ttl_list_.clear();
-    data_map_.clear();
+    DestroyAll();
+
+    slabs_.clear();
+    InitBuckets();
+    lru_list_ = List{};
+    small_list_ = List{};
+    ttl_list_ = List{};
+    ghost_seq_ = 0;
+    small_size_ = 0;
+    free_head_ = kNil;
+    next_unused_ = 0;
+    size_ = 0;
+    stats_.bytes = 0;
+  }
+
+  /**
+   * @brief 保存快照到文件
+   * @note 按更新时间顺序保存未过期的数据及其剩余超时时间，并记录淘汰队列的顺序。
+   * 先写入临时文件再重命名，保存失败时不会破坏已有的快照文件
+   * @param[in] path 快照文件路径
+   * @return true 成功
+   * @return false 失败
+   */
+  bool SaveSnapshot(const std::string& path) const
+    requires SnapshotSerializable<KeyType> && SnapshotSerializable<ValType>
+  {
+    using KeyCodec = SnapshotCodec<KeyType>;
+    using ValCodec = SnapshotCodec<ValType>;
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto time_line = now - cfg_.ttl;
+
+    // 为未过期的数据按更新时间顺序编号，并计算快照大小
+    std::vector<uint32_t> seqs(next_unused_, kNil);
+    uint64_t count = 0;
+    size_t data_size = kSnapshotHeaderSize;
+    for (uint32_t idx = ttl_list_.head; idx != kNil; idx = At(idx).ttl_link.next) {
+      const Node& node = At(idx);
+      if (node.load_time < time_line) continue;
+
+      const Entry& entry = node.GetEntry();
+      seqs[idx] = static_cast<uint32_t>(count++);
+      data_size += kSnapshotEntryHeaderSize + KeyCodec::Size(entry.key) + ValCodec::Size(entry.val);
+    }
+    data_size += count * sizeof(uint32_t);
+
+    std::string buf(data_size, '\0');
+    char* p = buf.data();
+    p = WriteField(p, kSnapshotMagic);
+    p = WriteField(p, kSnapshotVersion);
+    p = WriteField(p, count);
+
+    for (uint32_t idx = ttl_list_.head; idx != kNil; idx = At(idx).ttl_link.next) {
+      if (seqs[idx] == kNil) continue;
+
+      const Node& node = At(idx);
+      const Entry& entry = node.GetEntry();
+      const uint32_t key_size = static_cast<uint32_t>(KeyCodec::Size(entry.key));
+      const uint32_t val_size = static_cast<uint32_t>(ValCodec::Size(entry.val));
+      const int64_t remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(node.load_time - time_line).count();
+
+      p = WriteField(p, remaining);
+      p = WriteField(p, key_size);
+      p = WriteField(p, val_size);
+      p = WriteField(p, node.freq);
+      p = WriteField(p, static_cast<uint8_t>(node.in_small));
+      KeyCodec::Encode(entry.key, p);
+      p += key_size;
+      ValCodec::Encode(entry.val, p);
+      p += val_size;
+    }
+
+    // 淘汰队列顺序：主队列在前，试用队列在后
+    for (const List* list : {&lru_list_, &small_list_}) {
+      for (uint32_t idx = list->head; idx != kNil; idx = At(idx).lru_link.next) {
+        if (seqs[idx] != kNil) p = WriteField(p, seqs[idx]);
+      }
+    }
+
+    const std::string tmp_path = path + ".tmp";
+    std::ofstream ofile(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!ofile) return false;
+    ofile.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    ofile.close();
+    if (!ofile) return false;
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    return !ec;
+  }
+
+  /**
+   * @brief 从快照文件加载数据
+   * @note 通过内存映射读取快照，加载前会清空已有数据。恢复数据的剩余超时时间和淘汰队列顺序，
+   * 加载期间已过期的数据会被跳过，超过容量上限时按淘汰策略清理。
+   * 文件格式错误时返回false且不修改缓存，数据解码失败时返回false且缓存被清空
+   * @param[in] path 快照文件路径
+   * @return true 成功
+   * @return false 失败
+   */
+  bool LoadSnapshot(const std::string& path)
+    requires SnapshotSerializable<KeyType> && SnapshotSerializable<ValType>
+  {
+    using KeyCodec = SnapshotCodec<KeyType>;
+    using ValCodec = SnapshotCodec<ValType>;
+
+    MappedFile file;
+    if (!file.Open(path) || file.Size() < kSnapshotHeaderSize) return false;
+
+    const char* const begin = file.Data();
+    const char* const end = begin + file.Size();
+
+    uint32_t magic = 0, version = 0;
+    uint64_t count = 0;
+    const char* p = begin;
+    p = ReadField(p, magic);
+    p = ReadField(p, version);
+    p = ReadField(p, count);
+    if (magic != kSnapshotMagic || version != kSnapshotVersion) return false;
+    if (count > static_cast<size_t>(end - p) / (kSnapshotEntryHeaderSize + sizeof(uint32_t))) return false;
+
+    // 先校验文件结构，避免截断的文件清空已有数据
+    const char* const entries_begin = p;
+    for (uint64_t ii = 0; ii < count; ++ii) {
+      if (static_cast<size_t>(end - p) < kSnapshotEntryHeaderSize) return false;
+      uint32_t key_size = 0, val_size = 0;
+      ReadField(ReadField(p + sizeof(int64_t), key_size), val_size);
+      p += kSnapshotEntryHeaderSize;
+      if (static_cast<size_t>(end - p) < static_cast<size_t>(key_size) + val_size) return false;
+      p += static_cast<size_t>(key_size) + val_size;
+    }
+    if (static_cast<size_t>(end - p) != count * sizeof(uint32_t)) return false;
+    const char* const order_begin = p;
+
+    Clear();
+
+    const auto now = std::chrono::steady_clock::now();
+    const int64_t ttl_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(cfg_.ttl).count();
+
+    // 按更新时间顺序插入，TTL链表保持有序
+    std::vector<uint32_t> idxs(count, kNil);
+    p = entries_begin;
+    for (uint64_t ii = 0; ii < count; ++ii) {
+      int64_t remaining = 0;
+      uint32_t key_size = 0, val_size = 0;
+      uint8_t freq = 0, in_small = 0;
+      p = ReadField(p, remaining);
+      p = ReadField(p, key_size);
+      p = ReadField(p, val_size);
+      p = ReadField(p, freq);
+      p = ReadField(p, in_small);
+
+      KeyType key;
+      ValType val;
+      if (!KeyCodec::Decode(p, key_size, key) || !ValCodec::Decode(p + key_size, val_size, val)) {
+        Clear();
+        return false;
+      }
+      p += static_cast<size_t>(key_size) + val_size;
+
+      if (remaining <= 0) continue;
+
+      const uint32_t hash = HashKey(key);
+      if (Find(key, hash) != kNil) continue;
+
+      const uint32_t idx = AllocNode();
+      Node& node = At(idx);
+      try {
+        new (node.entry_buf) Entry(std::move(key), std::move(val));
+      } catch (...) {
+        node.hash_next = free_head_;
+        free_head_ = idx;
+        Clear();
+        throw;
+      }
+      node.hash = hash;
+      node.load_time = now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                 std::chrono::nanoseconds(ttl_ns - std::min(remaining, ttl_ns)));
+      node.freq = std::min(freq, kS3FifoMaxFreq);
+      node.in_small = (cfg_.evict_policy == CacheEvictPolicy::S3Fifo) && in_small;
+      node.weight = Weigh(node.GetEntry());
+      stats_.bytes += node.weight;
+
+      if (size_ >= buckets_.size()) GrowBuckets();
+      uint32_t& bucket = buckets_[BucketIndex(hash)];
+      node.hash_next = bucket;
+      bucket = idx;
+      PushBack<&Node::ttl_link>(ttl_list_, idx);
+
+      idxs[ii] = idx;
+      ++size_;
+    }
+
+    // 按快照中的顺序恢复淘汰队列，不在顺序记录中的数据放到主队列尾部
+    p = order_begin;
+    for (uint64_t ii = 0; ii < count; ++ii) {
+      uint32_t seq = 0;
+      p = ReadField(p, seq);
+      if (seq >= count || idxs[seq] == kNil) continue;
+      PushBackEvictQueue(idxs[seq]);
+      idxs[seq] = kNil;
+    }
+    for (uint32_t idx : idxs) {
+      if (idx != kNil) PushBackEvictQueue(idx);
+    }
+
+    if (NeedClean()) Clean();
+    return true;
   }
 
   /**
    * @brief 获取当前缓存数据量
+   * @note 配置了expire_batch_size时，可能包含尚未清理的过期数据
+   * @return size_t 当前缓存数据量
+   */
+  size_t Size() const {
+    return size_;
+  }
+
+  /**
+   * @brief 获取当前总权重
    *
-   * @return const size_t 当前缓存数据量
+   * @return size_t 当前总权重
    */
-  const size_t Size() const {
-    return data_map_.size();
+  size_t Bytes() const {
+    return stats_.bytes;
+  }
+
+  /**
+   * @brief 获取统计数据
+   *
+   * @return Stats 统计数据
+   */
+  Stats GetStats() const {
+    Stats stats = stats_;
+    stats.size = size_;
+    return stats;
   }
 
   /**
@@ -191,30 +512,352 @@ class LocalCache {
   const LocalCache::Cfg& GetCfg() const { return cfg_; }
 
  private:
-  struct ValContent {
-   public:
-    template <typename... Args>
-    explicit ValContent(Args&&... args) : val(std::forward<Args>(args)...) {}
+  static constexpr uint32_t kNil = UINT32_MAX;            // 空节点下标
+  static constexpr size_t kMaxCapacity = UINT32_MAX - 1;  // 节点下标为32位，容量不能超过此值
+  static constexpr uint32_t kMaxSlabBits = 10;            // 每个slab最多包含2^10个节点
+  static constexpr uint32_t kInitBucketBits = 4;          // 初始hash桶数量为2^4，随数据量增长
+  static constexpr uint8_t kS3FifoMaxFreq = 3;            // S3-FIFO访问计数上限
+
+  // 快照格式：文件头(magic, version, count)，按更新时间顺序的count条数据，最后是count个uint32表示的淘汰队列顺序。
+  // 每条数据为剩余超时时间(int64纳秒)、key长度(uint32)、val长度(uint32)、访问计数(uint8)、是否在试用队列中(uint8)，以及key和val
+  static constexpr uint32_t kSnapshotMagic = 0x534C5459;  // "YTLS"
+  static constexpr uint32_t kSnapshotVersion = 1;
+  static constexpr size_t kSnapshotHeaderSize = sizeof(uint32_t) * 2 + sizeof(uint64_t);
+  static constexpr size_t kSnapshotEntryHeaderSize = sizeof(int64_t) + sizeof(uint32_t) * 2 + sizeof(uint8_t) * 2;
+
+  struct Entry {
+    template <typename K, typename... Args>
+    explicit Entry(K&& k, Args&&... args) : key(std::forward<K>(k)), val(std::forward<Args>(args)...) {}
+
+    KeyType key;  // 缓存key
+    ValType val;  // 数据
+  };
 
-    ~ValContent() = default;
+  struct Link {
+    uint32_t prev;
+    uint32_t next;
+  };
 
-    ValContent(const ValContent&) = delete;
-    ValContent& operator=(const ValContent&) = delete;
+  struct List {
+    uint32_t head = kNil;
+    uint32_t tail = kNil;
+  };
 
-   public:
-    ValType val;  // 数据
+  /// S3-FIFO的幽灵队列槽位，记录从试用队列中淘汰的key的hash及淘汰序号
+  struct GhostSlot {
+    uint32_t hash = 0;
+    uint32_t seq = 0;
+  };
+
+  struct Node {
+    Entry& GetEntry() { return *std::launder(reinterpret_cast<Entry*>(entry_buf)); }
+    const Entry& GetEntry() const { return *std::launder(reinterpret_cast<const Entry*>(entry_buf)); }
+
+    uint32_t hash;       // key的hash值
+    uint32_t hash_next;  // hash桶链表中的下一个节点，节点空闲时为空闲链表中的下一个节点
+    Link lru_link;       // 淘汰队列链表，LRU链表/CLOCK环/S3-FIFO的主队列或试用队列
+    Link ttl_link;       // TTL链表，按更新时间排序
 
     std::chrono::steady_clock::time_point load_time;  // 上次更新时间
 
-    std::list<KeyType>::iterator lru_itr;
-    std::list<KeyType>::iterator ttl_itr;
+    uint8_t freq;     // CLOCK的访问位/S3-FIFO的访问计数
+    bool in_small;    // 是否在S3-FIFO的试用队列中
+    uint32_t weight;  // 权重
+
+    alignas(Entry) unsigned char entry_buf[sizeof(Entry)];  // 节点使用中时存放Entry
   };
 
+  static uint32_t HashKey(const KeyType& key) {
+    const uint64_t h = static_cast<uint64_t>(std::hash<KeyType>{}(key));
+    return static_cast<uint32_t>(h ^ (h >> 32));
+  }
+
+  size_t BucketIndex(uint32_t hash) const {
+    // 打散hash值后取高位，避免std::hash对整数是恒等映射时低位冲突
+    return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ULL) >> (64 - bucket_bits_));
+  }
+
+  /// 恢复到初始的hash桶及幽灵队列大小
+  void InitBuckets() {
+    bucket_bits_ = kInitBucketBits;
+    std::vector<uint32_t>(static_cast<size_t>(1) << bucket_bits_, kNil).swap(buckets_);
+
+    if (cfg_.evict_policy == CacheEvictPolicy::S3Fifo) {
+      ghost_bits_ = std::min(bucket_bits_, max_ghost_bits_);
+      std::vector<GhostSlot>(static_cast<size_t>(1) << ghost_bits_, GhostSlot{}).swap(ghost_);
+    }
+  }
+
+  /// 数据量达到hash桶数量时将桶数量翻倍，幽灵队列随之增长直到能覆盖ghost_capacity_次淘汰
+  void GrowBuckets() {
+    ++bucket_bits_;
+    std::vector<uint32_t> new_buckets(static_cast<size_t>(1) << bucket_bits_, kNil);
+    for (uint32_t idx : buckets_) {
+      while (idx != kNil) {
+        Node& node = At(idx);
+        const uint32_t next_idx = node.hash_next;
+        uint32_t& bucket = new_buckets[BucketIndex(node.hash)];
+        node.hash_next = bucket;
+        bucket = idx;
+        idx = next_idx;
+      }
+    }
+    buckets_.swap(new_buckets);
+
+    const uint32_t ghost_bits = std::min(bucket_bits_, max_ghost_bits_);
+    if (cfg_.evict_policy == CacheEvictPolicy::S3Fifo && ghost_bits_ < ghost_bits) {
+      std::vector<GhostSlot> old_ghost(static_cast<size_t>(1) << ghost_bits, GhostSlot{});
+      old_ghost.swap(ghost_);
+      ghost_bits_ = ghost_bits;
+      for (const GhostSlot& slot : old_ghost) {
+        if (slot.seq == 0) continue;
+        // 冲突时保留较新的淘汰记录
+        GhostSlot& new_slot = ghost_[GhostIndex(slot.hash)];
+        if (new_slot.seq == 0 || ghost_seq_ - slot.seq < ghost_seq_ - new_slot.seq) new_slot = slot;
+      }
+    }
+  }
+
+  Node& At(uint32_t idx) { return slabs_[idx >> slab_bits_][idx & ((1U << slab_bits_) - 1)]; }
+  const Node& At(uint32_t idx) const { return slabs_[idx >> slab_bits_][idx & ((1U << slab_bits_) - 1)]; }
+
+  uint32_t Find(const KeyType& key, uint32_t hash) {
+    for (uint32_t idx = buckets_[BucketIndex(hash)]; idx != kNil;) {
+      Node& node = At(idx);
+      if (node.hash == hash && node.GetEntry().key == key) return idx;
+      idx = node.hash_next;
+    }
+    return kNil;
+  }
+
+  uint32_t AllocNode() {
+    if (free_head_ != kNil) {
+      const uint32_t idx = free_head_;
+      free_head_ = At(idx).hash_next;
+      return idx;
+    }
+
+    if ((next_unused_ >> slab_bits_) == slabs_.size())
+      slabs_.emplace_back(new Node[static_cast<size_t>(1) << slab_bits_]);
+    return next_unused_++;
+  }
+
+  /// 清理load_time早于time_line的数据，最多清理budget条，为0时不限制
+  size_t CleanExpired(std::chrono::steady_clock::time_point time_line, size_t budget) {
+    size_t n = 0;
+    while (ttl_list_.head != kNil && At(ttl_list_.head).load_time < time_line) {
+      EraseNode(ttl_list_.head);
+      ++n;
+      if (n == budget) break;
+    }
+    stats_.expire_count += n;
+    return n;
+  }
+
+  size_t Weigh(const Entry& entry) const {
+    const size_t weight = cfg_.weigher ? cfg_.weigher(entry.key, entry.val) : (sizeof(KeyType) + sizeof(ValType));
+    return std::min<size_t>(weight, UINT32_MAX);
+  }
+
+  bool NeedClean() const {
+    return size_ >= cfg_.capacity || (cfg_.max_bytes && stats_.bytes > cfg_.max_bytes);
+  }
+
+  bool OverCleanTarget() const {
+    return size_ > cfg_.clean_size || (cfg_.max_bytes && stats_.bytes > cfg_.clean_bytes);
+  }
+
+  /// 访问数据。LRU将数据移到链表尾部，其他策略只修改节点上的访问标记
+  void Touch(Node& node, uint32_t idx) {
+    switch (cfg_.evict_policy) {
+      case CacheEvictPolicy::Clock:
+        node.freq = 1;
+        break;
+      case CacheEvictPolicy::S3Fifo:
+        if (node.freq < kS3FifoMaxFreq) ++node.freq;
+        break;
+      default:
+        MoveToBack<&Node::lru_link>(lru_list_, idx);
+        break;
+    }
+  }
+
+  /// CLOCK淘汰一次：设置了访问位的数据清除访问位后移到尾部，否则淘汰
+  void EvictClock() {
+    const uint32_t idx = lru_list_.head;
+    Node& node = At(idx);
+    if (node.freq) {
+      node.freq = 0;
+      MoveToBack<&Node::lru_link>(lru_list_, idx);
+    } else {
+      EvictNode(idx);
+    }
+  }
+
+  /// S3-FIFO淘汰一次：试用队列超过容量的10%时从试用队列淘汰，否则从主队列淘汰
+  void EvictS3Fifo() {
+    if (small_size_ >= small_capacity_ || lru_list_.head == kNil) {
+      const uint32_t idx = small_list_.head;
+      Node& node = At(idx);
+      if (node.freq) {
+        // 在试用队列中被访问过，晋升到主队列
+        Unlink<&Node::lru_link>(small_list_, idx);
+        --small_size_;
+        node.in_small = false;
+        node.freq = 0;
+        PushBack<&Node::lru_link>(lru_list_, idx);
+      } else {
+        AddGhost(node.hash);
+        EvictNode(idx);
+      }
+      return;
+    }
+
+    const uint32_t idx = lru_list_.head;
+    Node& node = At(idx);
+    if (node.freq) {
+      --node.freq;
+      MoveToBack<&Node::lru_link>(lru_list_, idx);
+    } else {
+      EvictNode(idx);
+    }
+  }
+
+  size_t GhostIndex(uint32_t hash) const {
+    return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ULL) >> (64 - ghost_bits_));
+  }
+
+  /// 幽灵队列为直接映射的hash表，只记录hash且冲突时直接覆盖，是近似实现
+  void AddGhost(uint32_t hash) {
+    GhostSlot& slot = ghost_[GhostIndex(hash)];
+    slot.hash = hash;
+    slot.seq = ++ghost_seq_;
+  }
+
+  /// 查询幽灵队列，最近ghost_capacity_次淘汰中出现过则返回true并删除记录
+  bool ConsumeGhost(uint32_t hash) {
+    GhostSlot& slot = ghost_[GhostIndex(hash)];
+    if (slot.seq == 0 || slot.hash != hash || ghost_seq_ - slot.seq >= ghost_capacity_) return false;
+    slot.seq = 0;
+    return true;
+  }
+
+  /// 将节点放入所属淘汰队列的尾部
+  void PushBackEvictQueue(uint32_t idx) {
+    if (At(idx).in_small) {
+      PushBack<&Node::lru_link>(small_list_, idx);
+      ++small_size_;
+    } else {
+      PushBack<&Node::lru_link>(lru_list_, idx);
+    }
+  }
+
+  template <typename T>
+  static char* WriteField(char* p, const T& v) {
+    memcpy(p, &v, sizeof(T));
+    return p + sizeof(T);
+  }
+
+  template <typename T>
+  static const char* ReadField(const char* p, T& v) {
+    memcpy(&v, p, sizeof(T));
+    return p + sizeof(T);
+  }
+
+  void EvictNode(uint32_t idx) {
+    EraseNode(idx);
+    ++stats_.evict_count;
+  }
+
+  /// 将节点从hash桶和链表中摘除，析构数据并放回空闲链表
+  void EraseNode(uint32_t idx) {
+    Node& node = At(idx);
+
+    uint32_t* pidx = &buckets_[BucketIndex(node.hash)];
+    while (*pidx != idx) pidx = &At(*pidx).hash_next;
+    *pidx = node.hash_next;
+
+    if (node.in_small) {
+      Unlink<&Node::lru_link>(small_list_, idx);
+      --small_size_;
+    } else {
+      Unlink<&Node::lru_link>(lru_list_, idx);
+    }
+    Unlink<&Node::ttl_link>(ttl_list_, idx);
+    node.GetEntry().~Entry();
+
+    stats_.bytes -= node.weight;
+    node.hash_next = free_head_;
+    free_head_ = idx;
+    --size_;
+  }
+
+  void DestroyAll() {
+    if constexpr (!std::is_trivially_destructible_v<Entry>) {
+      for (uint32_t idx = ttl_list_.head; idx != kNil; idx = At(idx).ttl_link.next)
+        At(idx).GetEntry().~Entry();
+    }
+  }
+
+  template <Link Node::*L>
+  void PushBack(List& list, uint32_t idx) {
+    Link& link = At(idx).*L;
+    link.prev = list.tail;
+    link.next = kNil;
+    if (list.tail != kNil) {
+      (At(list.tail).*L).next = idx;
+    } else {
+      list.head = idx;
+    }
+    list.tail = idx;
+  }
+
+  template <Link Node::*L>
+  void Unlink(List& list, uint32_t idx) {
+    Link& link = At(idx).*L;
+    if (link.prev != kNil) {
+      (At(link.prev).*L).next = link.next;
+    } else {
+      list.head = link.next;
+    }
+    if (link.next != kNil) {
+      (At(link.next).*L).prev = link.prev;
+    } else {
+      list.tail = link.prev;
+    }
+  }
+
+  template <Link Node::*L>
+  void MoveToBack(List& list, uint32_t idx) {
+    if (list.tail == idx) return;
+    Unlink<L>(list, idx);
+    PushBack<L>(list, idx);
+  }
+
   const LocalCache::Cfg cfg_;
-  std::unordered_map<KeyType, ValContent> data_map_;
 
-  std::list<KeyType> lru_list_;
-  std::list<KeyType> ttl_list_;
+  uint32_t bucket_bits_ = 0;       // hash桶数量为2^bucket_bits_
+  std::vector<uint32_t> buckets_;  // hash桶，存放桶链表头节点下标
+
+  uint32_t slab_bits_ = 0;                      // 每个slab包含2^slab_bits_个节点
+  std::vector<std::unique_ptr<Node[]>> slabs_;  // 节点池
+  uint32_t free_head_ = kNil;                   // 空闲链表头节点下标
+  uint32_t next_unused_ = 0;                    // 尚未分配过的第一个节点下标
+
+  List lru_list_;  // LRU链表/CLOCK环/S3-FIFO主队列
+  List ttl_list_;
+  size_t size_ = 0;
+  Stats stats_;  // 统计数据，size字段不使用
+
+  // S3-FIFO
+  List small_list_;               // 试用队列
+  size_t small_size_ = 0;         // 试用队列数据量
+  size_t small_capacity_ = 0;     // 试用队列目标容量
+  std::vector<GhostSlot> ghost_;  // 幽灵队列
+  uint32_t ghost_bits_ = 1;       // 幽灵队列槽位数为2^ghost_bits_
+  uint32_t max_ghost_bits_ = 1;   // 幽灵队列槽位数的上限为2^max_ghost_bits_
+  uint32_t ghost_capacity_ = 0;   // 幽灵队列记录的最近淘汰次数
+  uint32_t ghost_seq_ = 0;        // 幽灵队列淘汰序号
 };
 
 }  // namespace ytlib
@@ -0,0 +1,215 @@
+/**
+ * @file sharded_local_cache.hpp
+ * @author WT
+ * @brief 分片本地缓存
+ * @note 线程安全的本地缓存组件，按key的hash分到多个独立加锁的LocalCache中
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <cinttypes>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "ytlib/cache/local_cache.hpp"
+
+namespace ytlib {
+
+/**
+ * @brief ShardedLocalCache分片本地缓存工具
+ * @note 线程安全。key按hash分到shard_num个分片中，每个分片有自己的锁和LRU/TTL数据，
+ * 总容量、总权重上限和对应的清理目标平均分配到各个分片，因此淘汰是按分片进行的近似LRU。
+ * @tparam KeyType 值类型，需要支持比较
+ * @tparam ValType 数据类型
+ * @tparam Hash 用于分片的key的hash函数
+ */
+template <typename KeyType, typename ValType, typename Hash = std::hash<KeyType>>
+class ShardedLocalCache {
+ public:
+  using LocalCacheType = LocalCache<KeyType, ValType>;
+
+  /**
+   * @brief 配置
+   *
+   */
+  struct Cfg {
+    typename LocalCacheType::Cfg local_cache_cfg;  ///< 缓存总体配置，容量会平分到各个分片
+    size_t shard_num = 16;                         ///< 分片数
+
+    /// 校验配置
+    static Cfg Verify(const Cfg& verify_cfg) {
+      Cfg cfg(verify_cfg);
+
+      if (cfg.shard_num == 0) cfg.shard_num = 1;
+
+      cfg.local_cache_cfg = LocalCacheType::Cfg::Verify(cfg.local_cache_cfg);
+
+      return cfg;
+    }
+  };
+
+  explicit ShardedLocalCache(const ShardedLocalCache::Cfg& cfg)
+      : cfg_(ShardedLocalCache::Cfg::Verify(cfg)) {
+    typename LocalCacheType::Cfg shard_cfg = cfg_.local_cache_cfg;
+    shard_cfg.capacity = (cfg_.local_cache_cfg.capacity + cfg_.shard_num - 1) / cfg_.shard_num;
+    shard_cfg.clean_size = cfg_.local_cache_cfg.clean_size / cfg_.shard_num;
+    shard_cfg.max_bytes = (cfg_.local_cache_cfg.max_bytes + cfg_.shard_num - 1) / cfg_.shard_num;
+    shard_cfg.clean_bytes = cfg_.local_cache_cfg.clean_bytes / cfg_.shard_num;
+
+    shards_.reserve(cfg_.shard_num);
+    for (size_t ii = 0; ii < cfg_.shard_num; ++ii)
+      shards_.emplace_back(std::make_unique<Shard>(shard_cfg));
+  }
+
+  ~ShardedLocalCache() = default;
+
+  ShardedLocalCache(const ShardedLocalCache&) = delete;
+  ShardedLocalCache& operator=(const ShardedLocalCache&) = delete;
+
+  /**
+   * @brief 获取缓存数据
+   * @note 如果没有缓存数据，则返回std::nullopt
+   * @param[in] key 缓存key
+   * @return std::optional<ValType> 缓存数据
+   */
+  std::optional<ValType> Get(const KeyType& key) {
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lck(shard.mutex);
+    return shard.cache.Get(key);
+  }
+
+  /**
+   * @brief 更新缓存数据
+   * @note 有则更新，无则新增
+   * @tparam Args 缓存数据类型，或缓存数据的构造参数类型
+   * @param[in] key 缓存key
+   * @param[in] args 缓存数据，或缓存数据的构造参数
+   */
+  template <typename... Args>
+    requires std::constructible_from<ValType, Args...>
+  void Update(const KeyType& key, Args&&... args) {
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lck(shard.mutex);
+    shard.cache.Update(key, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief 删除某个数据
+   *
+   * @param[in] key 待删除数据的key
+   */
+  void Del(const KeyType& key) {
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lck(shard.mutex);
+    shard.cache.Del(key);
+  }
+
+  /**
+   * @brief 清理所有分片的过期数据
+   * @note 一般不需要手动调用此接口
+   */
+  void CleanExpireddata() {
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lck(shard->mutex);
+      shard->cache.CleanExpireddata();
+    }
+  }
+
+  /**
+   * @brief 每个分片清理最多budget条过期数据
+   * @note 逐个分片加锁清理，可以由后台定时器周期性调用
+   * @param[in] budget 每个分片最多清理的数据数，为0时不限制
+   * @return size_t 实际清理的数据数
+   */
+  size_t Maintain(size_t budget) {
+    size_t n = 0;
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lck(shard->mutex);
+      n += shard->cache.Maintain(budget);
+    }
+    return n;
+  }
+
+  /**
+   * @brief 删除所有数据，恢复到初始状态
+   *
+   */
+  void Clear() {
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lck(shard->mutex);
+      shard->cache.Clear();
+    }
+  }
+
+  /**
+   * @brief 获取当前缓存数据量
+   * @note 逐个分片加锁统计，并发情况下仅为近似值
+   * @return size_t 当前缓存数据量
+   */
+  size_t Size() const {
+    size_t size = 0;
+    for (const auto& shard : shards_) {
+      std::lock_guard<std::mutex> lck(shard->mutex);
+      size += shard->cache.Size();
+    }
+    return size;
+  }
+
+  /**
+   * @brief 获取所有分片的统计数据之和
+   * @note 逐个分片加锁统计，并发情况下仅为近似值
+   * @return LocalCacheType::Stats 统计数据
+   */
+  typename LocalCacheType::Stats GetStats() const {
+    typename LocalCacheType::Stats stats;
+    for (const auto& shard : shards_) {
+      std::lock_guard<std::mutex> lck(shard->mutex);
+      const auto shard_stats = shard->cache.GetStats();
+      stats.hit_count += shard_stats.hit_count;
+      stats.miss_count += shard_stats.miss_count;
+      stats.evict_count += shard_stats.evict_count;
+      stats.expire_count += shard_stats.expire_count;
+      stats.size += shard_stats.size;
+      stats.bytes += shard_stats.bytes;
+    }
+    return stats;
+  }
+
+  /**
+   * @brief 获取分片数
+   *
+   * @return size_t 分片数
+   */
+  size_t ShardNum() const { return shards_.size(); }
+
+  /**
+   * @brief 获取配置
+   *
+   * @return const ShardedLocalCache::Cfg&
+   */
+  const ShardedLocalCache::Cfg& GetCfg() const { return cfg_; }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  struct alignas(kCacheLineSize) Shard {
+    explicit Shard(const typename LocalCacheType::Cfg& cfg) : cache(cfg) {}
+
+    mutable std::mutex mutex;
+    LocalCacheType cache;
+  };
+
+  Shard& GetShard(const KeyType& key) {
+    // 打散hash值，避免分片与分片内map的bucket使用相同的低位
+    const uint64_t h = static_cast<uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ULL;
+    return *shards_[static_cast<size_t>(h >> 32) % shards_.size()];
+  }
+
+  const ShardedLocalCache::Cfg cfg_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace ytlib
@@ -0,0 +1,94 @@
+/**
+ * @file snapshot_codec.hpp
+ * @author WT
+ * @brief 缓存快照的序列化工具
+ * @note 缓存保存快照时对key和val的编解码，默认支持算术类型、枚举类型和std::string，
+ * 不含指针的POD结构体可以通过特化IsSnapshotPod显式开启
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <concepts>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ytlib {
+
+/**
+ * @brief 快照编解码器
+ * @note 对其他类型可以特化此模板，需要提供以下静态函数：
+ * size_t Size(const T& obj)：编码后的字节数；
+ * void Encode(const T& obj, char* buf)：编码到buf中，buf长度为Size(obj)；
+ * bool Decode(const char* buf, size_t len, T& obj)：从buf中解码，失败返回false。
+ * 编码结果为本机字节序，快照只能在相同架构的机器上读取
+ * @tparam T 数据类型
+ */
+template <typename T, typename Enable = void>
+struct SnapshotCodec;
+
+/**
+ * @brief 标记可以直接拷贝内存保存到快照中的自定义类型
+ * @note 只能对不含指针以及std::string_view、std::span等引用外部内存的成员的POD结构体特化为std::true_type，
+ * 否则快照中保存的是地址，加载后得到的是悬空指针
+ * @tparam T 数据类型
+ */
+template <typename T>
+struct IsSnapshotPod : std::false_type {};
+
+/// 算术类型、枚举类型以及显式标记的POD结构体，直接拷贝内存
+template <typename T>
+struct SnapshotCodec<T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T> || IsSnapshotPod<T>::value>> {
+  static_assert(std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T>, "IsSnapshotPod can only be specialized for POD types.");
+  static_assert(!std::is_pointer_v<T> && !std::is_member_pointer_v<T>, "Pointers can not be saved to snapshot.");
+
+  static size_t Size(const T&) { return sizeof(T); }
+
+  static void Encode(const T& obj, char* buf) { memcpy(buf, &obj, sizeof(T)); }
+
+  static bool Decode(const char* buf, size_t len, T& obj) {
+    if (len != sizeof(T)) return false;
+    memcpy(&obj, buf, sizeof(T));
+    return true;
+  }
+};
+
+template <>
+struct SnapshotCodec<std::string> {
+  static size_t Size(const std::string& obj) { return obj.size(); }
+
+  static void Encode(const std::string& obj, char* buf) { memcpy(buf, obj.data(), obj.size()); }
+
+  static bool Decode(const char* buf, size_t len, std::string& obj) {
+    obj.assign(buf, len);
+    return true;
+  }
+};
+
+/// 指针以及引用外部内存的视图类型保存的是地址，不能保存到快照中
+template <typename T>
+struct SnapshotCodec<T*> {
+  static_assert(sizeof(T*) == 0, "Pointers can not be saved to snapshot.");
+};
+
+template <typename CharT, typename Traits>
+struct SnapshotCodec<std::basic_string_view<CharT, Traits>> {
+  static_assert(sizeof(CharT) == 0, "View types can not be saved to snapshot, use std::string instead.");
+};
+
+template <typename T, size_t Extent>
+struct SnapshotCodec<std::span<T, Extent>> {
+  static_assert(sizeof(T) == 0, "View types can not be saved to snapshot.");
+};
+
+/// 可以保存到快照中的类型
+template <typename T>
+concept SnapshotSerializable = std::default_initializable<T> && requires(const T& obj, T& out, char* buf, const char* cbuf, size_t len) {
+  { SnapshotCodec<T>::Size(obj) } -> std::convertible_to<size_t>;
+  SnapshotCodec<T>::Encode(obj, buf);
+  { SnapshotCodec<T>::Decode(cbuf, len, out) } -> std::convertible_to<bool>;
+};
+
+}  // namespace ytlib
@@ -1,6 +1,10 @@
 #include <benchmark/benchmark.h>
 
+#include <deque>
+#include <vector>
+
 #include "ring_buf.hpp"
+#include "ring_deque.hpp"
 
 namespace ytlib {
 
@@ -13,7 +17,10 @@ class TestClass {
 };
 
 const uint32_t kBufSize = 1000;
+const uint32_t kPow2BufSize = 1024;
 using RingBufTest = RingBuf<TestClass, kBufSize>;
+using SpscRingBufTest = SpscRingBuf<TestClass, kBufSize>;
+using Pow2RingBufTest = Pow2RingBuf<TestClass, kPow2BufSize>;
 
 static void BM_RingBuf_Push(benchmark::State& state) {
   for (auto _ : state) {
@@ -25,6 +32,136 @@ static void BM_RingBuf_Push(benchmark::State& state) {
 }
 BENCHMARK(BM_RingBuf_Push);
 
+static void BM_SpscRingBuf_Push(benchmark::State& state) {
+  for (auto _ : state) {
+    SpscRingBufTest ring;
+    for (uint32_t ii = 0; ii < kBufSize; ++ii) {
+      ring.Push(TestClass(ii));
+    }
+  }
+}
+BENCHMARK(BM_SpscRingBuf_Push);
+
+static void BM_Pow2RingBuf_Push(benchmark::State& state) {
+  for (auto _ : state) {
+    Pow2RingBufTest ring;
+    for (uint32_t ii = 0; ii < kPow2BufSize; ++ii) {
+      ring.Push(TestClass(ii));
+    }
+  }
+}
+BENCHMARK(BM_Pow2RingBuf_Push);
+
+template <class RingType>
+static void RingBufPushPop(benchmark::State& state) {
+  RingType ring;
+  for (uint32_t ii = 0; ii < ring.Capacity() / 2; ++ii) {
+    ring.Push(TestClass(ii));
+  }
+  uint32_t ii = 0;
+  for (auto _ : state) {
+    ring.Push(TestClass(++ii));
+    benchmark::DoNotOptimize(ring.Top().id_);
+    ring.Pop();
+  }
+}
+
+static void BM_RingBuf_PushPop(benchmark::State& state) {
+  RingBufPushPop<RingBufTest>(state);
+}
+BENCHMARK(BM_RingBuf_PushPop);
+
+static void BM_Pow2RingBuf_PushPop(benchmark::State& state) {
+  RingBufPushPop<Pow2RingBufTest>(state);
+}
+BENCHMARK(BM_Pow2RingBuf_PushPop);
+
+const uint32_t kCharBufSize = 4096;
+
+// 批量写入、读取（数据跨越尾部时TopArray需要拷贝）
+template <class RingType>
+static void RingBufArray(benchmark::State& state) {
+  const uint32_t len = static_cast<uint32_t>(state.range(0));
+  std::vector<char> in_buf(len, 'a');
+  std::vector<char> out_buf(len);
+
+  RingType ring;
+  for (auto _ : state) {
+    ring.PushArray(in_buf.data(), len);
+    char* ps = out_buf.data();
+    ring.TopArray(ps, len);
+    benchmark::DoNotOptimize(ps[len - 1]);
+    ring.PopArray(len);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * len);
+}
+
+static void BM_RingBuf_Array(benchmark::State& state) {
+  RingBufArray<RingBuf<char, kCharBufSize>>(state);
+}
+BENCHMARK(BM_RingBuf_Array)->RangeMultiplier(8)->Range(8, 2048);
+
+static void BM_Pow2RingBuf_Array(benchmark::State& state) {
+  RingBufArray<Pow2RingBuf<char, kCharBufSize>>(state);
+}
+BENCHMARK(BM_Pow2RingBuf_Array)->RangeMultiplier(8)->Range(8, 2048);
+
+// 通过span直接读取，不拷贝
+static void BM_Pow2RingBuf_Spans(benchmark::State& state) {
+  const uint32_t len = static_cast<uint32_t>(state.range(0));
+  std::vector<char> in_buf(len, 'a');
+
+  Pow2RingBuf<char, kCharBufSize> ring;
+  for (auto _ : state) {
+    ring.PushArray(in_buf.data(), len);
+    auto spans = ring.ReadableSpans();
+    for (auto& span : spans) {
+      if (!span.empty()) benchmark::DoNotOptimize(span.back());
+    }
+    ring.PopArray(len);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * len);
+}
+BENCHMARK(BM_Pow2RingBuf_Spans)->RangeMultiplier(8)->Range(8, 2048);
+static void BM_RingDeque_PushBack(benchmark::State& state) {
+  for (auto _ : state) {
+    RingDeque<TestClass> dq;
+    for (uint32_t ii = 0; ii < kBufSize; ++ii) {
+      dq.EmplaceBack(ii);
+    }
+    benchmark::DoNotOptimize(dq.Back().id_);
+  }
+}
+BENCHMARK(BM_RingDeque_PushBack);
+
+static void BM_StdDeque_PushBack(benchmark::State& state) {
+  for (auto _ : state) {
+    std::deque<TestClass> dq;
+    for (uint32_t ii = 0; ii < kBufSize; ++ii) {
+      dq.emplace_back(ii);
+    }
+    benchmark::DoNotOptimize(dq.back().id_);
+  }
+}
+BENCHMARK(BM_StdDeque_PushBack);
+
+static void BM_RingDeque_Array(benchmark::State& state) {
+  const uint32_t len = static_cast<uint32_t>(state.range(0));
+  std::vector<char> in_buf(len, 'a');
+  std::vector<char> out_buf(len);
+
+  RingDeque<char> dq(kCharBufSize);
+  for (auto _ : state) {
+    dq.PushArray(in_buf.data(), len);
+    char* ps = out_buf.data();
+    dq.TopArray(ps, len);
+    benchmark::DoNotOptimize(ps[len - 1]);
+    dq.PopArray(len);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * len);
+}
+BENCHMARK(BM_RingDeque_Array)->RangeMultiplier(8)->Range(8, 2048);
+
 }  // namespace ytlib
 
 BENCHMARK_MAIN();
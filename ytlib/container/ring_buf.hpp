@@ -7,8 +7,11 @@
  */
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cinttypes>
 #include <cstring>
+#include <span>
 #include <stdexcept>
 
 namespace ytlib {
@@ -137,4 +140,326 @@ class RingBuf {
   uint32_t rpos_ = 0;  // 读位置
 };
 
+/**
+ * @brief 容量为2的幂的环形缓冲队列
+ * @note 读写位置单调递增，通过掩码计算下标，可以使用全部BUF_SIZE的容量。
+ * 可以通过ReadableSpans/WritableSpans获取可读/可写区域（最多两段），直接用于scatter/gather io，
+ * 写入可写区域后需要调用CommitWrite，读取可读区域后调用PopArray。
+ */
+template <class T, uint32_t BUF_SIZE>
+class Pow2RingBuf {
+  static_assert(BUF_SIZE >= 2 && (BUF_SIZE & (BUF_SIZE - 1)) == 0, "BUF_SIZE must be a power of 2.");
+
+ public:
+  Pow2RingBuf() = default;
+  ~Pow2RingBuf() = default;
+
+  bool Empty() const { return wpos_ == rpos_; }
+  bool Full() const { return wpos_ - rpos_ == BUF_SIZE; }
+
+  uint32_t Capacity() const { return BUF_SIZE; }
+  uint32_t Size() const { return wpos_ - rpos_; }
+  uint32_t UnusedCapacity() const { return BUF_SIZE - (wpos_ - rpos_); }
+
+  bool Push(const T& item) {
+    if (Full()) [[unlikely]]
+      return false;
+    content_[wpos_++ & kMask] = item;
+    return true;
+  }
+
+  bool Push(T&& item) {
+    if (Full()) [[unlikely]]
+      return false;
+    content_[wpos_++ & kMask] = std::move(item);
+    return true;
+  }
+
+  bool Pop() {
+    if (Empty()) [[unlikely]]
+      return false;
+    ++rpos_;
+    return true;
+  }
+
+  T& Top() {
+    if (Empty()) [[unlikely]]
+      throw std::runtime_error("Buf is empty.");
+
+    return content_[rpos_ & kMask];
+  }
+
+  T& Get(const uint32_t& pos) {
+    if (pos >= Size()) [[unlikely]]
+      throw std::invalid_argument("Pos is invalid.");
+
+    return content_[(rpos_ + pos) & kMask];
+  }
+
+  bool PushArray(const T* buf, const uint32_t& len) {
+    if (len > UnusedCapacity()) [[unlikely]]
+      return false;
+
+    const uint32_t cur_wpos = wpos_ & kMask;
+    if (cur_wpos + len <= BUF_SIZE) {
+      memcpy(content_ + cur_wpos, buf, len * sizeof(T));
+    } else {
+      const uint32_t tmp_size = BUF_SIZE - cur_wpos;
+      memcpy(content_ + cur_wpos, buf, tmp_size * sizeof(T));
+      memcpy(content_, buf + tmp_size, (len - tmp_size) * sizeof(T));
+    }
+    wpos_ += len;
+    return true;
+  }
+
+  bool PopArray(const uint32_t& len) {
+    if (len > Size()) [[unlikely]]
+      return false;
+    rpos_ += len;
+    return true;
+  }
+
+  bool TopArray(T*& buf, const uint32_t& len) {
+    return GetArray(0, buf, len);
+  }
+
+  bool GetArray(const uint32_t& pos, T*& buf, const uint32_t& len) {
+    if (len + pos > Size()) [[unlikely]]
+      return false;
+
+    const uint32_t cur_rpos = (rpos_ + pos) & kMask;
+    if (cur_rpos + len <= BUF_SIZE) {
+      buf = content_ + cur_rpos;
+    } else {
+      if (buf == nullptr) [[unlikely]]
+        return false;
+
+      const uint32_t tmp_size = BUF_SIZE - cur_rpos;
+      memcpy(buf, content_ + cur_rpos, tmp_size * sizeof(T));
+      memcpy(buf + tmp_size, content_, (len - tmp_size) * sizeof(T));
+    }
+    return true;
+  }
+
+  /// 获取可读区域，第二段为空表示数据是连续的
+  std::array<std::span<T>, 2> ReadableSpans() {
+    return Spans(rpos_, Size());
+  }
+
+  /// 获取可写区域，第二段为空表示空间是连续的。写入后需调用CommitWrite
+  std::array<std::span<T>, 2> WritableSpans() {
+    return Spans(wpos_, UnusedCapacity());
+  }
+
+  /// 提交已写入可写区域的len个元素
+  bool CommitWrite(const uint32_t& len) {
+    if (len > UnusedCapacity()) [[unlikely]]
+      return false;
+    wpos_ += len;
+    return true;
+  }
+
+  void Clear() { wpos_ = rpos_ = 0; }
+
+ protected:
+  static constexpr uint32_t kMask = BUF_SIZE - 1;
+
+  std::array<std::span<T>, 2> Spans(uint32_t pos, uint32_t len) {
+    const uint32_t cur_pos = pos & kMask;
+    if (cur_pos + len <= BUF_SIZE) return {std::span<T>(content_ + cur_pos, len), std::span<T>()};
+
+    const uint32_t tmp_size = BUF_SIZE - cur_pos;
+    return {std::span<T>(content_ + cur_pos, tmp_size), std::span<T>(content_, len - tmp_size)};
+  }
+
+  T content_[BUF_SIZE];
+
+  uint32_t wpos_ = 0;  // 写位置，单调递增
+  uint32_t rpos_ = 0;  // 读位置，单调递增
+};
+
+/**
+ * @brief 单生产者单消费者无锁环形缓冲队列
+ * @note 读写位置使用acquire/release原子操作，分别位于独立的cache line上，
+ * 并各自缓存一份对端位置，只有缓存值不足以判断时才读取对端的原子变量。
+ * 写相关接口（Push、PushArray、Full、UnusedCapacity）只能在生产者线程调用，
+ * 读相关接口（Pop、Top、Get、PopArray、TopArray、GetArray、Empty、Size）只能在消费者线程调用。
+ * 与RingBuf一样，实际容量为BUF_SIZE-1。
+ */
+template <class T, uint32_t BUF_SIZE>
+class SpscRingBuf {
+  static_assert(BUF_SIZE >= 2, "BUF_SIZE must be greater than 1.");
+
+ public:
+  SpscRingBuf() = default;
+  ~SpscRingBuf() = default;
+
+  SpscRingBuf(const SpscRingBuf&) = delete;
+  SpscRingBuf& operator=(const SpscRingBuf&) = delete;
+
+  uint32_t Capacity() const { return BUF_SIZE - 1; }
+
+  // 生产者接口
+
+  bool Full() {
+    const uint32_t next_wpos = Next(wpos_.load(std::memory_order_relaxed), 1);
+    if (next_wpos != cached_rpos_) return false;
+    cached_rpos_ = rpos_.load(std::memory_order_acquire);
+    return next_wpos == cached_rpos_;
+  }
+
+  uint32_t UnusedCapacity() {
+    cached_rpos_ = rpos_.load(std::memory_order_acquire);
+    return Unused(wpos_.load(std::memory_order_relaxed), cached_rpos_);
+  }
+
+  bool Push(const T& item) {
+    const uint32_t wpos = wpos_.load(std::memory_order_relaxed);
+    if (!CheckUnused(wpos, 1)) [[unlikely]]
+      return false;
+    content_[wpos] = item;
+    wpos_.store(Next(wpos, 1), std::memory_order_release);
+    return true;
+  }
+
+  bool Push(T&& item) {
+    const uint32_t wpos = wpos_.load(std::memory_order_relaxed);
+    if (!CheckUnused(wpos, 1)) [[unlikely]]
+      return false;
+    content_[wpos] = std::move(item);
+    wpos_.store(Next(wpos, 1), std::memory_order_release);
+    return true;
+  }
+
+  bool PushArray(const T* buf, const uint32_t& len) {
+    const uint32_t wpos = wpos_.load(std::memory_order_relaxed);
+    if (!CheckUnused(wpos, len)) [[unlikely]]
+      return false;
+
+    if (wpos + len <= BUF_SIZE) {
+      memcpy(content_ + wpos, buf, len * sizeof(T));
+    } else {
+      const uint32_t tmp_size = BUF_SIZE - wpos;
+      memcpy(content_ + wpos, buf, tmp_size * sizeof(T));
+      memcpy(content_, buf + tmp_size, (len - tmp_size) * sizeof(T));
+    }
+    wpos_.store(Next(wpos, len), std::memory_order_release);
+    return true;
+  }
+
+  // 消费者接口
+
+  bool Empty() {
+    const uint32_t rpos = rpos_.load(std::memory_order_relaxed);
+    if (rpos != cached_wpos_) return false;
+    cached_wpos_ = wpos_.load(std::memory_order_acquire);
+    return rpos == cached_wpos_;
+  }
+
+  uint32_t Size() {
+    cached_wpos_ = wpos_.load(std::memory_order_acquire);
+    return Used(cached_wpos_, rpos_.load(std::memory_order_relaxed));
+  }
+
+  bool Pop() {
+    const uint32_t rpos = rpos_.load(std::memory_order_relaxed);
+    if (!CheckUsed(rpos, 1)) [[unlikely]]
+      return false;
+    rpos_.store(Next(rpos, 1), std::memory_order_release);
+    return true;
+  }
+
+  T& Top() {
+    const uint32_t rpos = rpos_.load(std::memory_order_relaxed);
+    if (!CheckUsed(rpos, 1)) [[unlikely]]
+      throw std::runtime_error("Buf is empty.");
+
+    return content_[rpos];
+  }
+
+  T& Get(const uint32_t& pos) {
+    const uint32_t rpos = rpos_.load(std::memory_order_relaxed);
+    if (!CheckUsed(rpos, pos + 1)) [[unlikely]]
+      throw std::invalid_argument("Pos is invalid.");
+
+    return content_[Next(rpos, pos)];
+  }
+
+  bool PopArray(const uint32_t& len) {
+    const uint32_t rpos = rpos_.load(std::memory_order_relaxed);
+    if (!CheckUsed(rpos, len)) [[unlikely]]
+      return false;
+    rpos_.store(Next(rpos, len), std::memory_order_release);
+    return true;
+  }
+
+  bool TopArray(T*& buf, const uint32_t& len) {
+    return GetArray(0, buf, len);
+  }
+
+  bool GetArray(const uint32_t& pos, T*& buf, const uint32_t& len) {
+    const uint32_t rpos = rpos_.load(std::memory_order_relaxed);
+    if (!CheckUsed(rpos, pos + len)) [[unlikely]]
+      return false;
+
+    const uint32_t cur_rpos = Next(rpos, pos);
+    if (cur_rpos + len <= BUF_SIZE) {
+      buf = content_ + cur_rpos;
+    } else {
+      if (buf == nullptr) [[unlikely]]
+        return false;
+
+      const uint32_t tmp_size = BUF_SIZE - cur_rpos;
+      memcpy(buf, content_ + cur_rpos, tmp_size * sizeof(T));
+      memcpy(buf + tmp_size, content_, (len - tmp_size) * sizeof(T));
+    }
+    return true;
+  }
+
+  /// 清空，只能在没有并发读写时调用
+  void Clear() {
+    wpos_.store(0, std::memory_order_relaxed);
+    rpos_.store(0, std::memory_order_relaxed);
+    cached_rpos_ = cached_wpos_ = 0;
+  }
+
+ protected:
+  static constexpr size_t kCacheLineSize = 64;
+
+  static uint32_t Next(uint32_t pos, uint32_t n) {
+    pos += n;
+    return (pos < BUF_SIZE) ? pos : (pos - BUF_SIZE);
+  }
+
+  static uint32_t Used(uint32_t wpos, uint32_t rpos) {
+    return (wpos >= rpos) ? (wpos - rpos) : (wpos + BUF_SIZE - rpos);
+  }
+
+  static uint32_t Unused(uint32_t wpos, uint32_t rpos) {
+    return BUF_SIZE - 1 - Used(wpos, rpos);
+  }
+
+  /// 生产者检查剩余空间，缓存的读位置不够时再读取真实读位置
+  bool CheckUnused(uint32_t wpos, uint32_t len) {
+    if (len <= Unused(wpos, cached_rpos_)) return true;
+    cached_rpos_ = rpos_.load(std::memory_order_acquire);
+    return len <= Unused(wpos, cached_rpos_);
+  }
+
+  /// 消费者检查已有数据，缓存的写位置不够时再读取真实写位置
+  bool CheckUsed(uint32_t rpos, uint32_t len) {
+    if (len <= Used(cached_wpos_, rpos)) return true;
+    cached_wpos_ = wpos_.load(std::memory_order_acquire);
+    return len <= Used(cached_wpos_, rpos);
+  }
+
+  alignas(kCacheLineSize) std::atomic<uint32_t> wpos_ = 0;  // 写位置
+  uint32_t cached_rpos_ = 0;                                // 生产者缓存的读位置
+
+  alignas(kCacheLineSize) std::atomic<uint32_t> rpos_ = 0;  // 读位置
+  uint32_t cached_wpos_ = 0;                                // 消费者缓存的写位置
+
+  alignas(kCacheLineSize) T content_[BUF_SIZE];
+};
+
 }  // namespace ytlib
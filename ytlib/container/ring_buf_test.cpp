@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <string>
+#include <thread>
+
 #include "ring_buf.hpp"
 
 // todo 未完成
@@ -119,3 +122,188 @@ TEST(RING_BUF_TEST, ARRAY_TEST) {
   ASSERT_EQ(ring.Size(), 0);
   ASSERT_EQ(ring.UnusedCapacity(), kBufSize - 1);
 }
+
+TEST(RING_BUF_TEST, SPSC_BASE_TEST) {
+  const uint32_t kBufSize = 10;
+  using RingBufTest = SpscRingBuf<uint32_t, kBufSize>;
+  RingBufTest ring;
+
+  ASSERT_EQ(ring.Empty(), true);
+  ASSERT_EQ(ring.Full(), false);
+  ASSERT_EQ(ring.Capacity(), kBufSize - 1);
+  ASSERT_EQ(ring.Size(), 0);
+  ASSERT_EQ(ring.UnusedCapacity(), kBufSize - 1);
+
+  ASSERT_EQ(ring.Push(1), true);
+  ASSERT_EQ(ring.Push(2), true);
+  ASSERT_EQ(ring.Size(), 2);
+  ASSERT_EQ(ring.Top(), 1);
+  ASSERT_EQ(ring.Get(1), 2);
+  ASSERT_THROW(ring.Get(2), std::invalid_argument);
+
+  for (uint32_t ii = 3; ii < kBufSize; ++ii) {
+    ASSERT_EQ(ring.Push(ii), true);
+  }
+  ASSERT_EQ(ring.Full(), true);
+  ASSERT_EQ(ring.Push(kBufSize), false);
+
+  ASSERT_EQ(ring.Pop(), true);
+  ASSERT_EQ(ring.Full(), false);
+  ASSERT_EQ(ring.UnusedCapacity(), 1);
+
+  ring.Clear();
+  ASSERT_EQ(ring.Pop(), false);
+  ASSERT_EQ(ring.Empty(), true);
+  ASSERT_THROW(ring.Top(), std::runtime_error);
+}
+
+TEST(RING_BUF_TEST, SPSC_ARRAY_TEST) {
+  const uint32_t kBufSize = 15;
+  using RingCharBufTest = SpscRingBuf<char, kBufSize>;
+  RingCharBufTest ring;
+
+  std::string s = "0123456789";
+  uint32_t s_size = static_cast<uint32_t>(s.size());
+
+  for (uint32_t ii = 0; ii < 3; ++ii) {
+    ASSERT_EQ(ring.PushArray(s.c_str(), s_size), true);
+    ASSERT_EQ(ring.Size(), s_size);
+    ASSERT_EQ(ring.PushArray(s.c_str(), s_size), false);
+
+    char ps2[kBufSize];
+    char* ps = ps2;
+    ASSERT_EQ(ring.TopArray(ps, s_size), true);
+    ASSERT_STREQ(std::string(ps, s_size).c_str(), s.c_str());
+
+    uint32_t get_pos = 5;
+    ps = ps2;
+    ASSERT_EQ(ring.GetArray(get_pos, ps, s_size - get_pos), true);
+    ASSERT_STREQ(std::string(ps, s_size - get_pos).c_str(), s.substr(get_pos).c_str());
+
+    ASSERT_EQ(ring.PopArray(s_size), true);
+    ASSERT_EQ(ring.PopArray(s_size), false);
+    ASSERT_EQ(ring.UnusedCapacity(), kBufSize - 1);
+  }
+}
+
+TEST(RING_BUF_TEST, SPSC_THREAD_TEST) {
+  using RingCharBufTest = SpscRingBuf<char, 64>;
+  RingCharBufTest ring;
+
+  const uint32_t total_size = 100000;
+
+  std::thread t([&] {
+    char buf[7];
+    uint32_t cur = 0;
+    while (cur < total_size) {
+      uint32_t len = std::min<uint32_t>(sizeof(buf), total_size - cur);
+      for (uint32_t ii = 0; ii < len; ++ii)
+        buf[ii] = static_cast<char>((cur + ii) % 128);
+      while (!ring.PushArray(buf, len)) std::this_thread::yield();
+      cur += len;
+    }
+  });
+
+  char buf[64];
+  uint32_t cur = 0;
+  while (cur < total_size) {
+    uint32_t len = ring.Size();
+    if (len == 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    char* ps = buf;
+    ASSERT_EQ(ring.TopArray(ps, len), true);
+    for (uint32_t ii = 0; ii < len; ++ii)
+      ASSERT_EQ(ps[ii], static_cast<char>((cur + ii) % 128));
+    ASSERT_EQ(ring.PopArray(len), true);
+    cur += len;
+  }
+
+  t.join();
+  ASSERT_EQ(ring.Empty(), true);
+}
+
+TEST(RING_BUF_TEST, POW2_BASE_TEST) {
+  const uint32_t kBufSize = 8;
+  using RingBufTest = Pow2RingBuf<uint32_t, kBufSize>;
+  RingBufTest ring;
+
+  ASSERT_EQ(ring.Empty(), true);
+  ASSERT_EQ(ring.Full(), false);
+  ASSERT_EQ(ring.Capacity(), kBufSize);
+  ASSERT_EQ(ring.Size(), 0);
+  ASSERT_EQ(ring.UnusedCapacity(), kBufSize);
+
+  for (uint32_t ii = 0; ii < kBufSize; ++ii) {
+    ASSERT_EQ(ring.Push(ii), true);
+  }
+  ASSERT_EQ(ring.Full(), true);
+  ASSERT_EQ(ring.Push(kBufSize), false);
+  ASSERT_EQ(ring.Top(), 0);
+  ASSERT_EQ(ring.Get(kBufSize - 1), kBufSize - 1);
+  ASSERT_THROW(ring.Get(kBufSize), std::invalid_argument);
+
+  // 回绕
+  for (uint32_t ii = kBufSize; ii < kBufSize * 3; ++ii) {
+    ASSERT_EQ(ring.Pop(), true);
+    ASSERT_EQ(ring.Push(ii), true);
+    ASSERT_EQ(ring.Top(), ii - kBufSize + 1);
+  }
+  ASSERT_EQ(ring.Size(), kBufSize);
+
+  ring.Clear();
+  ASSERT_EQ(ring.Pop(), false);
+  ASSERT_EQ(ring.Empty(), true);
+}
+
+TEST(RING_BUF_TEST, POW2_ARRAY_TEST) {
+  const uint32_t kBufSize = 16;
+  using RingCharBufTest = Pow2RingBuf<char, kBufSize>;
+  RingCharBufTest ring;
+
+  std::string s = "0123456789";
+  uint32_t s_size = static_cast<uint32_t>(s.size());
+
+  for (uint32_t ii = 0; ii < 3; ++ii) {
+    ASSERT_EQ(ring.PushArray(s.c_str(), s_size), true);
+    ASSERT_EQ(ring.Size(), s_size);
+    ASSERT_EQ(ring.UnusedCapacity(), kBufSize - s_size);
+    ASSERT_EQ(ring.PushArray(s.c_str(), s_size), false);
+
+    char ps2[kBufSize];
+    char* ps = ps2;
+    ASSERT_EQ(ring.TopArray(ps, s_size), true);
+    ASSERT_STREQ(std::string(ps, s_size).c_str(), s.c_str());
+
+    uint32_t get_pos = 5;
+    ps = ps2;
+    ASSERT_EQ(ring.GetArray(get_pos, ps, s_size - get_pos), true);
+    ASSERT_STREQ(std::string(ps, s_size - get_pos).c_str(), s.substr(get_pos).c_str());
+
+    auto rs = ring.ReadableSpans();
+    ASSERT_EQ(rs[0].size() + rs[1].size(), s_size);
+    ASSERT_STREQ((std::string(rs[0].begin(), rs[0].end()) + std::string(rs[1].begin(), rs[1].end())).c_str(), s.c_str());
+
+    ASSERT_EQ(ring.PopArray(s_size), true);
+    ASSERT_EQ(ring.PopArray(s_size), false);
+  }
+
+  // 直接写入可写区域
+  auto ws = ring.WritableSpans();
+  ASSERT_EQ(ws[0].size() + ws[1].size(), kBufSize);
+  ASSERT_FALSE(ws[1].empty());
+  uint32_t idx = 0;
+  for (auto& span : ws) {
+    for (auto& c : span) c = s[idx++ % s_size];
+  }
+  ASSERT_EQ(ring.CommitWrite(kBufSize), true);
+  ASSERT_EQ(ring.Full(), true);
+  ASSERT_EQ(ring.CommitWrite(1), false);
+  ASSERT_EQ(ring.WritableSpans()[0].size(), 0);
+
+  for (uint32_t ii = 0; ii < kBufSize; ++ii) {
+    ASSERT_EQ(ring.Top(), s[ii % s_size]);
+    ASSERT_EQ(ring.Pop(), true);
+  }
+}
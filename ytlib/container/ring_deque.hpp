@@ -0,0 +1,317 @@
+/**
+ * @file ring_deque.hpp
+ * @brief RingDeque
+ * @note 堆上分配、容量可在运行时指定并自动增长的环形双端队列
+ * @author WT
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace ytlib {
+
+/**
+ * @brief 环形双端队列
+ * @note 存储空间为一块按cache line对齐的堆内存，容量为2的幂，通过掩码计算下标。
+ * 空间不足时容量翻倍，并将环上的两段数据依次搬移到新内存的头部。
+ * 对于可平凡复制的类型，搬移和批量读写使用memcpy。
+ * @tparam T 元素类型
+ */
+template <class T>
+class RingDeque {
+ public:
+  /**
+   * @brief 构造函数
+   * @param capacity 初始容量，会被调整为2的幂，为0时不分配内存
+   */
+  explicit RingDeque(size_t capacity = 0) {
+    if (capacity > 0) {
+      cap_ = RoundUpCapacity(capacity);
+      buf_ = Allocate(cap_);
+    }
+  }
+
+  ~RingDeque() {
+    Clear();
+    Deallocate(buf_, cap_);
+  }
+
+  RingDeque(const RingDeque& other) : RingDeque(other.size_) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (other.size_ == 0) return;
+      other.CopyTo(buf_, 0, other.size_);
+      size_ = other.size_;
+    } else {
+      for (size_t ii = 0; ii < other.size_; ++ii)
+        EmplaceBack(other[ii]);
+    }
+  }
+
+  RingDeque(RingDeque&& other) noexcept
+      : buf_(std::exchange(other.buf_, nullptr)),
+        cap_(std::exchange(other.cap_, 0)),
+        head_(std::exchange(other.head_, 0)),
+        size_(std::exchange(other.size_, 0)) {}
+
+  RingDeque& operator=(RingDeque other) noexcept {
+    Swap(other);
+    return *this;
+  }
+
+  void Swap(RingDeque& other) noexcept {
+    std::swap(buf_, other.buf_);
+    std::swap(cap_, other.cap_);
+    std::swap(head_, other.head_);
+    std::swap(size_, other.size_);
+  }
+
+  bool Empty() const { return size_ == 0; }
+  bool Full() const { return size_ == cap_; }
+
+  size_t Capacity() const { return cap_; }
+  size_t Size() const { return size_; }
+  size_t UnusedCapacity() const { return cap_ - size_; }
+
+  /// 预留至少n个元素的空间
+  void Reserve(size_t n) {
+    if (n > cap_) Reallocate(RoundUpCapacity(n));
+  }
+
+  template <class... Args>
+  T& EmplaceBack(Args&&... args) {
+    if (Full()) [[unlikely]]
+      return GrowAndEmplace(false, std::forward<Args>(args)...);
+
+    T* ptr = new (buf_ + ((head_ + size_) & Mask())) T(std::forward<Args>(args)...);
+    ++size_;
+    return *ptr;
+  }
+
+  template <class... Args>
+  T& EmplaceFront(Args&&... args) {
+    if (Full()) [[unlikely]]
+      return GrowAndEmplace(true, std::forward<Args>(args)...);
+
+    const size_t pos = (head_ - 1) & Mask();
+    T* ptr = new (buf_ + pos) T(std::forward<Args>(args)...);
+    head_ = pos;
+    ++size_;
+    return *ptr;
+  }
+
+  void PushBack(const T& item) { EmplaceBack(item); }
+  void PushBack(T&& item) { EmplaceBack(std::move(item)); }
+  void PushFront(const T& item) { EmplaceFront(item); }
+  void PushFront(T&& item) { EmplaceFront(std::move(item)); }
+
+  bool PopBack() {
+    if (Empty()) [[unlikely]]
+      return false;
+    --size_;
+    buf_[(head_ + size_) & Mask()].~T();
+    return true;
+  }
+
+  bool PopFront() {
+    if (Empty()) [[unlikely]]
+      return false;
+    buf_[head_].~T();
+    head_ = (head_ + 1) & Mask();
+    --size_;
+    return true;
+  }
+
+  T& Front() {
+    if (Empty()) [[unlikely]]
+      throw std::runtime_error("Deque is empty.");
+    return buf_[head_];
+  }
+
+  T& Back() {
+    if (Empty()) [[unlikely]]
+      throw std::runtime_error("Deque is empty.");
+    return buf_[(head_ + size_ - 1) & Mask()];
+  }
+
+  T& Get(size_t pos) {
+    if (pos >= size_) [[unlikely]]
+      throw std::invalid_argument("Pos is invalid.");
+    return buf_[(head_ + pos) & Mask()];
+  }
+
+  T& operator[](size_t pos) { return buf_[(head_ + pos) & Mask()]; }
+  const T& operator[](size_t pos) const { return buf_[(head_ + pos) & Mask()]; }
+
+  /// 在尾部批量添加元素，空间不足时自动扩容。buf可以指向容器内的元素
+  void PushArray(const T* buf, size_t len) {
+    if (len > cap_ - size_) [[unlikely]] {
+      GrowAndPushArray(buf, len);
+      return;
+    }
+
+    const size_t wpos = (head_ + size_) & Mask();
+    const size_t first = std::min(len, cap_ - wpos);
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (len == 0) return;
+      memcpy(buf_ + wpos, buf, first * sizeof(T));
+      memcpy(buf_, buf + first, (len - first) * sizeof(T));
+      size_ += len;
+    } else {
+      for (size_t ii = 0; ii < len; ++ii)
+        EmplaceBack(buf[ii]);
+    }
+  }
+
+  /// 从头部批量删除元素
+  bool PopArray(size_t len) {
+    if (len > size_) [[unlikely]]
+      return false;
+
+    if constexpr (std::is_trivially_destructible_v<T>) {
+      if (len == 0) return true;
+      head_ = (head_ + len) & Mask();
+      size_ -= len;
+    } else {
+      for (size_t ii = 0; ii < len; ++ii)
+        PopFront();
+    }
+    return true;
+  }
+
+  /**
+   * @brief 获取头部len个元素
+   * @note 数据连续时buf直接指向内部空间，否则拷贝到buf指向的空间中，此时buf不能为空
+   */
+  bool TopArray(T*& buf, size_t len) {
+    if (len > size_) [[unlikely]]
+      return false;
+
+    if (len == 0 || head_ + len <= cap_) {
+      buf = buf_ + head_;
+      return true;
+    }
+
+    if (buf == nullptr) [[unlikely]]
+      return false;
+
+    CopyTo(buf, 0, len);
+    return true;
+  }
+
+  void Clear() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (size_t ii = 0; ii < size_; ++ii)
+        buf_[(head_ + ii) & Mask()].~T();
+    }
+    head_ = size_ = 0;
+  }
+
+ private:
+  static constexpr size_t kAlignment = std::max<size_t>(alignof(T), 64);
+  static constexpr size_t kMinGrowCapacity = 16;  // 未分配内存时首次扩容的容量
+
+  static T* Allocate(size_t n) {
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(kAlignment)));
+  }
+
+  static void Deallocate(T* ptr, size_t n) {
+    if (ptr != nullptr) ::operator delete(ptr, n * sizeof(T), std::align_val_t(kAlignment));
+  }
+
+  static size_t RoundUpCapacity(size_t n) {
+    size_t cap = 1;
+    while (cap < n) cap <<= 1;
+    return cap;
+  }
+
+  size_t Mask() const { return cap_ - 1; }
+
+  /// 将从pos开始的len个元素拷贝到连续的dst中，仅用于可平凡复制的类型
+  void CopyTo(T* dst, size_t pos, size_t len) const {
+    const size_t rpos = (head_ + pos) & Mask();
+    const size_t first = std::min(len, cap_ - rpos);
+    memcpy(dst, buf_ + rpos, first * sizeof(T));
+    memcpy(dst + first, buf_, (len - first) * sizeof(T));
+  }
+
+  /// 将环上的两段数据依次搬移到new_buf头部，并释放旧内存
+  void RelocateTo(T* new_buf) {
+    if (size_ > 0) {
+      if constexpr (std::is_trivially_copyable_v<T>) {
+        CopyTo(new_buf, 0, size_);
+      } else {
+        for (size_t ii = 0; ii < size_; ++ii) {
+          T& item = buf_[(head_ + ii) & Mask()];
+          new (new_buf + ii) T(std::move(item));
+          item.~T();
+        }
+      }
+    }
+    Deallocate(buf_, cap_);
+    buf_ = new_buf;
+  }
+
+  void Reallocate(size_t new_cap) {
+    T* new_buf = Allocate(new_cap);
+    RelocateTo(new_buf);
+    cap_ = new_cap;
+    head_ = 0;
+  }
+
+  /// 扩容并添加元素。先在新内存中构造新元素，保证参数引用了容器内元素时依然有效
+  template <class... Args>
+  T& GrowAndEmplace(bool front, Args&&... args) {
+    const size_t new_cap = (cap_ == 0) ? kMinGrowCapacity : (cap_ << 1);
+    T* new_buf = Allocate(new_cap);
+    const size_t pos = front ? (new_cap - 1) : size_;
+    try {
+      new (new_buf + pos) T(std::forward<Args>(args)...);
+    } catch (...) {
+      Deallocate(new_buf, new_cap);
+      throw;
+    }
+
+    RelocateTo(new_buf);
+    cap_ = new_cap;
+    head_ = front ? pos : 0;
+    ++size_;
+    return buf_[pos];
+  }
+
+  /// 扩容并批量添加元素。先在新内存中构造新元素再释放旧内存，保证buf指向容器内元素时依然有效
+  void GrowAndPushArray(const T* buf, size_t len) {
+    const size_t new_cap = RoundUpCapacity(size_ + len);
+    T* new_buf = Allocate(new_cap);
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      memcpy(new_buf + size_, buf, len * sizeof(T));
+    } else {
+      size_t ii = 0;
+      try {
+        for (; ii < len; ++ii) new (new_buf + size_ + ii) T(buf[ii]);
+      } catch (...) {
+        while (ii > 0) new_buf[size_ + (--ii)].~T();
+        Deallocate(new_buf, new_cap);
+        throw;
+      }
+    }
+
+    RelocateTo(new_buf);
+    cap_ = new_cap;
+    head_ = 0;
+    size_ += len;
+  }
+
+  T* buf_ = nullptr;  // 存储空间
+  size_t cap_ = 0;    // 容量，2的幂
+  size_t head_ = 0;   // 头部元素下标
+  size_t size_ = 0;   // 元素个数
+};
+
+}  // namespace ytlib
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "ring_deque.hpp"
+
+namespace ytlib {
+
+TEST(RING_DEQUE_TEST, BASE_TEST) {
+  RingDeque<uint32_t> dq(3);
+  ASSERT_EQ(dq.Capacity(), 4);
+  ASSERT_EQ(dq.Empty(), true);
+  ASSERT_EQ(dq.PopFront(), false);
+  ASSERT_EQ(dq.PopBack(), false);
+  ASSERT_THROW(dq.Front(), std::runtime_error);
+  ASSERT_THROW(dq.Back(), std::runtime_error);
+
+  dq.PushBack(2);
+  dq.PushFront(1);
+  dq.EmplaceBack(3);
+  dq.EmplaceFront(0);
+  ASSERT_EQ(dq.Full(), true);
+  ASSERT_EQ(dq.Size(), 4);
+  for (uint32_t ii = 0; ii < 4; ++ii) ASSERT_EQ(dq[ii], ii);
+
+  // 数据跨越尾部时扩容
+  dq.PushBack(4);
+  ASSERT_EQ(dq.Capacity(), 8);
+  ASSERT_EQ(dq.Size(), 5);
+  for (uint32_t ii = 0; ii < 5; ++ii) ASSERT_EQ(dq.Get(ii), ii);
+  ASSERT_THROW(dq.Get(5), std::invalid_argument);
+
+  ASSERT_EQ(dq.Front(), 0);
+  ASSERT_EQ(dq.Back(), 4);
+  ASSERT_EQ(dq.PopFront(), true);
+  ASSERT_EQ(dq.PopBack(), true);
+  ASSERT_EQ(dq.Front(), 1);
+  ASSERT_EQ(dq.Back(), 3);
+
+  dq.Clear();
+  ASSERT_EQ(dq.Empty(), true);
+  ASSERT_EQ(dq.Capacity(), 8);
+}
+
+TEST(RING_DEQUE_TEST, GROW_TEST) {
+  RingDeque<std::string> dq;
+  ASSERT_EQ(dq.Capacity(), 0);
+
+  const uint32_t n = 100;
+  for (uint32_t ii = 0; ii < n; ++ii) {
+    if (ii % 2) {
+      dq.EmplaceBack(std::to_string(ii));
+    } else {
+      dq.EmplaceFront(std::to_string(ii));
+    }
+  }
+  ASSERT_EQ(dq.Size(), n);
+  ASSERT_EQ(dq.Capacity(), 128);
+
+  // 前半部分为倒序的偶数，后半部分为正序的奇数
+  for (uint32_t ii = 0; ii < n / 2; ++ii) {
+    ASSERT_EQ(dq[ii], std::to_string(n - 2 - ii * 2));
+    ASSERT_EQ(dq[n / 2 + ii], std::to_string(ii * 2 + 1));
+  }
+
+  // 参数引用了容器内的元素
+  RingDeque<std::string> dq2(1);
+  dq2.PushBack("abc");
+  dq2.PushBack(dq2.Front());
+  dq2.PushFront(dq2.Back());
+  ASSERT_EQ(dq2.Size(), 3);
+  for (uint32_t ii = 0; ii < 3; ++ii) ASSERT_EQ(dq2[ii], "abc");
+
+  // 拷贝、移动
+  RingDeque<std::string> dq3(dq);
+  ASSERT_EQ(dq3.Size(), n);
+  for (uint32_t ii = 0; ii < n; ++ii) ASSERT_EQ(dq3[ii], dq[ii]);
+
+  RingDeque<std::string> dq4(std::move(dq3));
+  ASSERT_EQ(dq3.Size(), 0);
+  ASSERT_EQ(dq4.Size(), n);
+
+  dq2 = dq4;
+  ASSERT_EQ(dq2.Size(), n);
+  ASSERT_EQ(dq2.Back(), dq.Back());
+}
+
+TEST(RING_DEQUE_TEST, ARRAY_TEST) {
+  RingDeque<char> dq(16);
+
+  std::string s = "0123456789";
+  const size_t s_size = s.size();
+
+  for (uint32_t ii = 0; ii < 3; ++ii) {
+    dq.PushArray(s.c_str(), s_size);
+    ASSERT_EQ(dq.Size(), s_size);
+    ASSERT_EQ(dq.Capacity(), 16);
+
+    char ps2[16];
+    char* ps = ps2;
+    ASSERT_EQ(dq.TopArray(ps, s_size), true);
+    ASSERT_EQ(std::string(ps, s_size), s);
+
+    ASSERT_EQ(dq.PopArray(s_size), true);
+    ASSERT_EQ(dq.PopArray(1), false);
+  }
+
+  // 数据跨越尾部时扩容
+  dq.PushArray(s.c_str(), s_size);
+  dq.PushArray(s.c_str(), s_size);
+  ASSERT_EQ(dq.Capacity(), 32);
+  ASSERT_EQ(dq.Size(), s_size * 2);
+
+  char* ps = nullptr;
+  ASSERT_EQ(dq.TopArray(ps, s_size * 2), true);
+  ASSERT_EQ(std::string(ps, s_size * 2), s + s);
+
+  RingDeque<char> dq2(dq);
+  ASSERT_EQ(dq2.Size(), s_size * 2);
+  ASSERT_EQ(dq2.PopArray(s_size), true);
+  ASSERT_EQ(dq2.Front(), '0');
+}
+
+TEST(RING_DEQUE_TEST, NON_TRIVIAL_TEST) {
+  auto p = std::make_shared<uint32_t>(1);
+  {
+    RingDeque<std::shared_ptr<uint32_t>> dq;
+    for (uint32_t ii = 0; ii < 10; ++ii) dq.PushBack(p);
+    ASSERT_EQ(p.use_count(), 11);
+    ASSERT_EQ(dq.PopArray(5), true);
+    ASSERT_EQ(p.use_count(), 6);
+    dq.PushArray(&p, 1);
+    ASSERT_EQ(p.use_count(), 7);
+  }
+  ASSERT_EQ(p.use_count(), 1);
+}
+
+// 批量添加的数据来自容器自身且需要扩容
+TEST(RING_DEQUE_TEST, SELF_ARRAY_TEST) {
+  RingDeque<char> dq(16);
+  std::string s = "0123456789abcdef";
+  dq.PushArray(s.c_str(), s.size());
+  ASSERT_TRUE(dq.Full());
+
+  char* ps = nullptr;
+  ASSERT_EQ(dq.TopArray(ps, s.size()), true);
+  dq.PushArray(ps, s.size());
+  ASSERT_EQ(dq.Capacity(), 32);
+  ASSERT_EQ(dq.TopArray(ps, s.size() * 2), true);
+  ASSERT_EQ(std::string(ps, s.size() * 2), s + s);
+
+  RingDeque<std::string> dq2(2);
+  dq2.PushBack("aaa");
+  dq2.PushBack("bbb");
+  dq2.PushArray(&dq2[0], 2);
+  ASSERT_EQ(dq2.Size(), 4);
+  ASSERT_EQ(dq2[2], "aaa");
+  ASSERT_EQ(dq2[3], "bbb");
+
+  // 拷贝空容器
+  RingDeque<char> dq3;
+  RingDeque<char> dq4(dq3);
+  ASSERT_TRUE(dq4.Empty());
+}
+
+}  // namespace ytlib
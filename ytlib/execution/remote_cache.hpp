@@ -7,32 +7,73 @@
  */
 #pragma once
 
+#include <chrono>
+#include <cinttypes>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <optional>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
+#include <unifex/async_manual_reset_event.hpp>
 #include <unifex/async_mutex.hpp>
+#include <unifex/async_scope.hpp>
+#include <unifex/inline_scheduler.hpp>
+#include <unifex/on.hpp>
+#include <unifex/sync_wait.hpp>
 #include <unifex/task.hpp>
 
 #include "ytlib/cache/local_cache.hpp"
 
 namespace ytlib {
 
+/**
+ * @brief 远程数据缓存工具
+ * @note 同一个key同时只会有一个远程请求，并发的未命中请求会等待这个请求的结果。
+ * 数据超过软超时时间后，Get会立即返回旧数据，同时在后台发起一次刷新。
+ * 远程接口返回std::nullopt时，可以按negative_ttl缓存空结果。
+ * @tparam KeyType 值类型
+ * @tparam ValType 数据类型
+ */
 template <typename KeyType, typename ValType>
 class RemoteCache {
  public:
-  using LocalCacheType = LocalCache<KeyType, ValType>;
+  /// 本地缓存的数据，包括远程接口的返回结果和获取时间
+  struct CacheVal {
+    std::optional<ValType> val;
+    std::chrono::steady_clock::time_point load_time;
+  };
+
+  using LocalCacheType = LocalCache<KeyType, CacheVal>;
 
   using UpdateDataFunc = std::function<unifex::task<std::optional<ValType>>(const KeyType&)>;
 
+  /// 批量获取远程数据的函数，返回结果需要与keys一一对应
+  using BatchUpdateDataFunc = std::function<unifex::task<std::vector<std::optional<ValType>>>(std::span<const KeyType>)>;
+
  public:
   struct Cfg {
-    LocalCacheType::Cfg local_cache_cfg;
+    LocalCacheType::Cfg local_cache_cfg;  ///< 本地缓存配置，其中ttl为数据的硬超时时间
+
+    std::chrono::steady_clock::duration soft_ttl = std::chrono::steady_clock::duration::zero();      ///< 软超时时间，为0时不启用
+    std::chrono::steady_clock::duration negative_ttl = std::chrono::steady_clock::duration::zero();  ///< 空结果的缓存时间，为0时不缓存空结果
 
     static Cfg Verify(const Cfg& verify_cfg) {
       Cfg cfg(verify_cfg);
 
       cfg.local_cache_cfg = LocalCacheType::Cfg::Verify(cfg.local_cache_cfg);
 
+      if (cfg.soft_ttl < std::chrono::steady_clock::duration::zero() || cfg.soft_ttl >= cfg.local_cache_cfg.ttl)
+        cfg.soft_ttl = std::chrono::steady_clock::duration::zero();
+
+      if (cfg.negative_ttl < std::chrono::steady_clock::duration::zero())
+        cfg.negative_ttl = std::chrono::steady_clock::duration::zero();
+      if (cfg.negative_ttl > cfg.local_cache_cfg.ttl)
+        cfg.negative_ttl = cfg.local_cache_cfg.ttl;
+
       return cfg;
     }
   };
@@ -43,7 +84,10 @@ class RemoteCache {
     update_data_fun_ = [](auto) -> unifex::task<std::optional<ValType>> { co_return std::nullopt; };
   }
 
-  ~RemoteCache() = default;
+  ~RemoteCache() {
+    // 等待后台刷新完成
+    unifex::sync_wait(refresh_scope_.cleanup());
+  }
 
   void SetUpdateDataFunc(const UpdateDataFunc& update_data_fun) {
     update_data_fun_ = update_data_fun;
@@ -53,31 +97,207 @@ class RemoteCache {
     update_data_fun_ = std::move(update_data_fun);
   }
 
-  // todo: 此处处理不太好，容易在短时间内造成大量不必要的请求，最好是按key加锁
+  /**
+   * @brief 设置批量获取远程数据的函数
+   * @note 未设置时MultiGet会对每个未命中的key依次调用UpdateDataFunc
+   * @param[in] batch_update_data_fun 批量获取远程数据的函数
+   */
+  void SetBatchUpdateDataFunc(const BatchUpdateDataFunc& batch_update_data_fun) {
+    batch_update_data_fun_ = batch_update_data_fun;
+  }
+
+  void SetBatchUpdateDataFunc(BatchUpdateDataFunc&& batch_update_data_fun) {
+    batch_update_data_fun_ = std::move(batch_update_data_fun);
+  }
+
   unifex::task<std::optional<ValType>> Get(const KeyType& key) {
+    std::optional<ValType> val;
+    std::shared_ptr<InflightRequest> req;
+    bool new_req = false;
+
     co_await local_cache_mutex_.async_lock();
-    auto local_ret = local_cache_.Get(key);
+    const LookupState state = LookupLocked(key, val, req, new_req);
     local_cache_mutex_.unlock();
 
-    if (local_ret) co_return local_ret;
+    if (state == LookupState::Hit) co_return val;
 
-    auto ret = co_await update_data_fun_(key);
+    if (state == LookupState::Stale) {
+      if (new_req) refresh_scope_.spawn(Fetch(key, std::move(req)));
+      co_return val;
+    }
+
+    if (new_req) {
+      co_await Fetch(key, req);
+    } else {
+      co_await unifex::on(unifex::inline_scheduler{}, req->finish_event.async_wait());
+    }
+
+    if (req->error) std::rethrow_exception(req->error);
+    co_return req->result;
+  }
+
+  /**
+   * @brief 批量获取数据
+   * @note 只加一次锁查询所有key，未命中的key通过一次BatchUpdateDataFunc调用获取，并一次性写入本地缓存。
+   * 其他请求正在获取的key会等待其结果。keys需要在返回前保持有效
+   * @param[in] keys 待获取的key
+   * @return unifex::task<std::vector<std::optional<ValType>>> 与keys一一对应的结果
+   */
+  unifex::task<std::vector<std::optional<ValType>>> MultiGet(std::span<const KeyType> keys) {
+    std::vector<std::optional<ValType>> rets(keys.size());
+    std::vector<std::shared_ptr<InflightRequest>> reqs(keys.size());
+
+    std::vector<KeyType> fetch_keys, refresh_keys;
+    std::vector<std::shared_ptr<InflightRequest>> fetch_reqs, refresh_reqs;
+
+    co_await local_cache_mutex_.async_lock();
+    for (size_t ii = 0; ii < keys.size(); ++ii) {
+      bool new_req = false;
+      const LookupState state = LookupLocked(keys[ii], rets[ii], reqs[ii], new_req);
+      if (!new_req) continue;
+
+      if (state == LookupState::Stale) {
+        refresh_keys.emplace_back(keys[ii]);
+        refresh_reqs.emplace_back(std::move(reqs[ii]));
+      } else {
+        fetch_keys.emplace_back(keys[ii]);
+        fetch_reqs.emplace_back(reqs[ii]);
+      }
+    }
+    local_cache_mutex_.unlock();
 
-    if (ret) {
-      co_await local_cache_mutex_.async_lock();
-      local_cache_.Update(key, *ret);
-      local_cache_mutex_.unlock();
+    if (!refresh_keys.empty())
+      refresh_scope_.spawn(FetchBatch(std::move(refresh_keys), std::move(refresh_reqs)));
+
+    if (!fetch_keys.empty())
+      co_await FetchBatch(std::move(fetch_keys), std::move(fetch_reqs));
+
+    for (size_t ii = 0; ii < keys.size(); ++ii) {
+      // 命中或返回旧数据的key没有需要等待的请求
+      if (!reqs[ii] || rets[ii]) continue;
+
+      co_await unifex::on(unifex::inline_scheduler{}, reqs[ii]->finish_event.async_wait());
+      if (reqs[ii]->error) std::rethrow_exception(reqs[ii]->error);
+      rets[ii] = reqs[ii]->result;
     }
-    co_return ret;
+
+    co_return rets;
   }
 
  private:
+  /// 进行中的远程请求
+  struct InflightRequest {
+    unifex::async_manual_reset_event finish_event;
+    std::optional<ValType> result;
+    std::exception_ptr error;
+  };
+
+  enum class LookupState : uint8_t {
+    Hit,    ///< 命中
+    Stale,  ///< 命中但超过软超时时间
+    Miss,   ///< 未命中
+  };
+
+  /**
+   * @brief 查询本地缓存，需要持有local_cache_mutex_
+   * @note Hit和Stale时val为结果。Stale和Miss时req为该key进行中的请求，
+   * 没有进行中的请求时会新建一个并置new_req为true，调用者需要负责发起请求
+   */
+  LookupState LookupLocked(const KeyType& key, std::optional<ValType>& val, std::shared_ptr<InflightRequest>& req, bool& new_req) {
+    auto local_ret = local_cache_.Get(key);
+    if (local_ret) {
+      const auto age = std::chrono::steady_clock::now() - local_ret->load_time;
+
+      if (!local_ret->val) {
+        // 空结果未超过negative_ttl时直接返回，否则当作未命中
+        if (age < cfg_.negative_ttl) return LookupState::Hit;
+      } else if (cfg_.soft_ttl == std::chrono::steady_clock::duration::zero() || age < cfg_.soft_ttl) {
+        val = std::move(local_ret->val);
+        return LookupState::Hit;
+      } else {
+        // 超过软超时时间，返回旧数据，没有进行中的请求时需要在后台刷新
+        val = std::move(local_ret->val);
+        GetInflightRequest(key, req, new_req);
+        return LookupState::Stale;
+      }
+    }
+
+    // 未命中，同一个key只有第一个请求者去调用远程接口，其他请求者等待其结果
+    GetInflightRequest(key, req, new_req);
+    return LookupState::Miss;
+  }
+
+  void GetInflightRequest(const KeyType& key, std::shared_ptr<InflightRequest>& req, bool& new_req) {
+    auto [itr, inserted] = inflight_map_.try_emplace(key);
+    if (inserted) itr->second = std::make_shared<InflightRequest>();
+    req = itr->second;
+    new_req = inserted;
+  }
+
+  bool NeedCache(const std::optional<ValType>& result) const {
+    return result || cfg_.negative_ttl > std::chrono::steady_clock::duration::zero();
+  }
+
+  /// 调用远程接口并更新本地缓存，完成后唤醒所有等待者
+  unifex::task<void> Fetch(KeyType key, std::shared_ptr<InflightRequest> req) {
+    try {
+      req->result = co_await update_data_fun_(key);
+    } catch (...) {
+      req->error = std::current_exception();
+    }
+
+    co_await local_cache_mutex_.async_lock();
+    if (!req->error && NeedCache(req->result))
+      local_cache_.Update(key, CacheVal{req->result, std::chrono::steady_clock::now()});
+    inflight_map_.erase(key);
+    local_cache_mutex_.unlock();
+
+    req->finish_event.set();
+  }
+
+  /// 批量调用远程接口并一次性更新本地缓存，完成后唤醒所有等待者
+  unifex::task<void> FetchBatch(std::vector<KeyType> keys, std::vector<std::shared_ptr<InflightRequest>> reqs) {
+    std::exception_ptr error;
+    try {
+      if (batch_update_data_fun_) {
+        auto results = co_await batch_update_data_fun_(std::span<const KeyType>(keys));
+        if (results.size() != keys.size())
+          throw std::runtime_error("Batch update data func returned a wrong number of results.");
+        for (size_t ii = 0; ii < keys.size(); ++ii)
+          reqs[ii]->result = std::move(results[ii]);
+      } else {
+        for (size_t ii = 0; ii < keys.size(); ++ii)
+          reqs[ii]->result = co_await update_data_fun_(keys[ii]);
+      }
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    co_await local_cache_mutex_.async_lock();
+    const auto now = std::chrono::steady_clock::now();
+    for (size_t ii = 0; ii < keys.size(); ++ii) {
+      if (!error && NeedCache(reqs[ii]->result))
+        local_cache_.Update(keys[ii], CacheVal{reqs[ii]->result, now});
+      inflight_map_.erase(keys[ii]);
+    }
+    local_cache_mutex_.unlock();
+
+    for (auto& req : reqs) {
+      req->error = error;
+      req->finish_event.set();
+    }
+  }
+
   const RemoteCache::Cfg cfg_;
 
   unifex::async_mutex local_cache_mutex_;
   LocalCacheType local_cache_;
+  std::unordered_map<KeyType, std::shared_ptr<InflightRequest>> inflight_map_;  // 进行中的远程请求，受local_cache_mutex_保护
 
   UpdateDataFunc update_data_fun_;
+  BatchUpdateDataFunc batch_update_data_fun_;
+
+  unifex::async_scope refresh_scope_;  // 后台刷新任务
 };
 
-}  // namespace ytlib
\ No newline at end of file
+}  // namespace ytlib
@@ -3,7 +3,12 @@
 #include "ytlib/execution/execution_tools.hpp"
 #include "ytlib/execution/remote_cache.hpp"
 
+#include <atomic>
+#include <span>
+#include <vector>
+
 #include <unifex/sync_wait.hpp>
+#include <unifex/when_all.hpp>
 
 namespace ytlib {
 
@@ -59,4 +64,174 @@ TEST(EXECUTION_TEST, RemoteCache) {
   }
 }
 
-}  // namespace ytlib
\ No newline at end of file
+// 模拟异步请求，10ms后返回prefix + key，并统计调用次数
+static auto MakeAsyncUpdateDataFunc(const uint32_t& prefix, std::atomic_uint32_t& call_count, bool ret_nullopt = false) {
+  return [&prefix, &call_count, ret_nullopt](int key) -> unifex::task<std::optional<std::string>> {
+    ++call_count;
+    co_return co_await AsyncWrapper<std::optional<std::string>>(
+        [&prefix, key, ret_nullopt](const std::function<void(std::optional<std::string> &&)>& callback) {
+          std::thread t([&prefix, key, ret_nullopt, callback]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if (ret_nullopt) {
+              callback(std::nullopt);
+            } else {
+              callback(std::to_string(prefix + key));
+            }
+          });
+          t.detach();
+        });
+  };
+}
+
+TEST(EXECUTION_TEST, RemoteCacheSingleFlight) {
+  using TestRemoteCache = RemoteCache<int, std::string>;
+
+  TestRemoteCache::Cfg cfg;
+  cfg.local_cache_cfg.ttl = std::chrono::milliseconds(1000);
+  TestRemoteCache remote_cache(cfg);
+
+  uint32_t prefix = 0;
+  std::atomic_uint32_t call_count = 0;
+  remote_cache.SetUpdateDataFunc(MakeAsyncUpdateDataFunc(prefix, call_count));
+
+  // 并发获取同一个未命中的key，只调用一次远程接口
+  auto work = [&](int key) -> unifex::task<void> {
+    auto ret = co_await remote_cache.Get(key);
+    EXPECT_TRUE(ret);
+    EXPECT_STREQ(ret->c_str(), std::to_string(key).c_str());
+  };
+  unifex::sync_wait(unifex::when_all(work(1), work(1), work(1), work(2)));
+  EXPECT_EQ(call_count.load(), 2);
+
+  // 已缓存，不再调用远程接口
+  unifex::sync_wait(unifex::when_all(work(1), work(2)));
+  EXPECT_EQ(call_count.load(), 2);
+}
+
+TEST(EXECUTION_TEST, RemoteCacheSoftTtl) {
+  using TestRemoteCache = RemoteCache<int, std::string>;
+
+  TestRemoteCache::Cfg cfg;
+  cfg.local_cache_cfg.ttl = std::chrono::milliseconds(1000);
+  cfg.soft_ttl = std::chrono::milliseconds(50);
+  TestRemoteCache remote_cache(cfg);
+
+  uint32_t prefix = 0;
+  std::atomic_uint32_t call_count = 0;
+  remote_cache.SetUpdateDataFunc(MakeAsyncUpdateDataFunc(prefix, call_count));
+
+  auto ret = unifex::sync_wait(remote_cache.Get(1));
+  ASSERT_TRUE(ret && *ret);
+  EXPECT_STREQ((*ret)->c_str(), "1");
+  EXPECT_EQ(call_count.load(), 1);
+
+  // 超过软超时时间，立即返回旧数据并在后台刷新一次
+  prefix = 100;
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  for (int ii = 0; ii < 3; ++ii) {
+    ret = unifex::sync_wait(remote_cache.Get(1));
+    ASSERT_TRUE(ret && *ret);
+    EXPECT_STREQ((*ret)->c_str(), "1");
+  }
+  EXPECT_EQ(call_count.load(), 2);
+
+  // 刷新完成后返回新数据
+  std::this_thread::sleep_for(std::chrono::milliseconds(40));
+  ret = unifex::sync_wait(remote_cache.Get(1));
+  ASSERT_TRUE(ret && *ret);
+  EXPECT_STREQ((*ret)->c_str(), "101");
+  EXPECT_EQ(call_count.load(), 2);
+}
+
+TEST(EXECUTION_TEST, RemoteCacheNegativeTtl) {
+  using TestRemoteCache = RemoteCache<int, std::string>;
+
+  TestRemoteCache::Cfg cfg;
+  cfg.local_cache_cfg.ttl = std::chrono::milliseconds(1000);
+  cfg.negative_ttl = std::chrono::milliseconds(50);
+  TestRemoteCache remote_cache(cfg);
+
+  uint32_t prefix = 0;
+  std::atomic_uint32_t call_count = 0;
+  remote_cache.SetUpdateDataFunc(MakeAsyncUpdateDataFunc(prefix, call_count, true));
+
+  auto ret = unifex::sync_wait(remote_cache.Get(1));
+  ASSERT_TRUE(ret);
+  EXPECT_FALSE(*ret);
+  EXPECT_EQ(call_count.load(), 1);
+
+  // 空结果被缓存
+  ret = unifex::sync_wait(remote_cache.Get(1));
+  ASSERT_TRUE(ret);
+  EXPECT_FALSE(*ret);
+  EXPECT_EQ(call_count.load(), 1);
+
+  // 超过negative_ttl后重新请求
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  ret = unifex::sync_wait(remote_cache.Get(1));
+  ASSERT_TRUE(ret);
+  EXPECT_FALSE(*ret);
+  EXPECT_EQ(call_count.load(), 2);
+}
+
+TEST(EXECUTION_TEST, RemoteCacheMultiGet) {
+  using TestRemoteCache = RemoteCache<int, std::string>;
+
+  TestRemoteCache::Cfg cfg;
+  cfg.local_cache_cfg.ttl = std::chrono::milliseconds(1000);
+  TestRemoteCache remote_cache(cfg);
+
+  uint32_t prefix = 0;
+  std::atomic_uint32_t call_count = 0;
+  remote_cache.SetUpdateDataFunc(MakeAsyncUpdateDataFunc(prefix, call_count));
+
+  // 未设置批量接口时逐个调用UpdateDataFunc
+  std::vector<int> keys{1, 2};
+  auto rets = unifex::sync_wait(remote_cache.MultiGet(keys));
+  ASSERT_TRUE(rets);
+  ASSERT_EQ(rets->size(), 2);
+  EXPECT_STREQ((*rets)[0]->c_str(), "1");
+  EXPECT_STREQ((*rets)[1]->c_str(), "2");
+  EXPECT_EQ(call_count.load(), 2);
+
+  std::atomic_uint32_t batch_call_count = 0;
+  std::vector<int> batch_keys;
+  remote_cache.SetBatchUpdateDataFunc([&](std::span<const int> keys) -> unifex::task<std::vector<std::optional<std::string>>> {
+    ++batch_call_count;
+    batch_keys.assign(keys.begin(), keys.end());
+
+    std::vector<std::optional<std::string>> rets;
+    for (int key : keys) {
+      if (key % 2) {
+        rets.emplace_back(std::to_string(prefix + key));
+      } else {
+        rets.emplace_back(std::nullopt);
+      }
+    }
+    co_return rets;
+  });
+
+  // 已缓存的key直接返回，未命中的key通过一次批量请求获取
+  prefix = 100;
+  keys = {1, 2, 3, 4, 5, 3};
+  rets = unifex::sync_wait(remote_cache.MultiGet(keys));
+  ASSERT_TRUE(rets);
+  ASSERT_EQ(rets->size(), keys.size());
+  EXPECT_STREQ((*rets)[0]->c_str(), "1");
+  EXPECT_STREQ((*rets)[1]->c_str(), "2");
+  EXPECT_STREQ((*rets)[2]->c_str(), "103");
+  EXPECT_FALSE((*rets)[3]);
+  EXPECT_STREQ((*rets)[4]->c_str(), "105");
+  EXPECT_STREQ((*rets)[5]->c_str(), "103");
+  EXPECT_EQ(batch_call_count.load(), 1);
+  EXPECT_EQ(batch_keys, std::vector<int>({3, 4, 5}));
+  EXPECT_EQ(call_count.load(), 2);
+
+  // 批量写入的结果可以被Get命中
+  auto ret = unifex::sync_wait(remote_cache.Get(5));
+  ASSERT_TRUE(ret && *ret);
+  EXPECT_STREQ((*ret)->c_str(), "105");
+  EXPECT_EQ(call_count.load(), 2);
+}
+
+}  // namespace ytlib
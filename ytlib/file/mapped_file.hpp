@@ -0,0 +1,143 @@
+/**
+ * @file mapped_file.hpp
+ * @brief 只读内存映射文件
+ * @note 跨平台的只读内存映射文件工具
+ * @author WT
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+  #if !defined(NOMINMAX) && defined(_MSC_VER)
+    #define NOMINMAX  // required to stop windows.h messing up std::min
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace ytlib {
+
+/**
+ * @brief 只读内存映射文件
+ * @note 将整个文件只读映射到内存中，析构时解除映射。空文件可以打开，但Data()为空
+ */
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile() { Close(); }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)) {}
+
+  MappedFile& operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+      Close();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief 打开并映射文件
+   *
+   * @param[in] path 文件路径
+   * @return true 成功
+   * @return false 失败
+   */
+  bool Open(const std::string& path) {
+    Close();
+
+#if defined(_WIN32)
+    HANDLE file_hnd = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file_hnd == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_hnd, &file_size)) {
+      CloseHandle(file_hnd);
+      return false;
+    }
+
+    if (file_size.QuadPart == 0) {
+      CloseHandle(file_hnd);
+      return true;
+    }
+
+    HANDLE map_hnd = CreateFileMappingA(file_hnd, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file_hnd);
+    if (map_hnd == NULL) return false;
+
+    void* ptr = MapViewOfFile(map_hnd, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(map_hnd);
+    if (ptr == NULL) return false;
+
+    data_ = static_cast<const char*>(ptr);
+    size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      return false;
+    }
+
+    if (st.st_size == 0) {
+      close(fd);
+      return true;
+    }
+
+    void* ptr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) return false;
+
+    // 一般是顺序读取整个文件。advice是枚举值而不是标志位，需要分别设置
+    madvise(ptr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+    madvise(ptr, static_cast<size_t>(st.st_size), MADV_WILLNEED);
+
+    data_ = static_cast<const char*>(ptr);
+    size_ = static_cast<size_t>(st.st_size);
+#endif
+
+    return true;
+  }
+
+  /// 解除映射
+  void Close() {
+    if (data_ == nullptr) return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(data_);
+#else
+    munmap(const_cast<char*>(data_), size_);
+#endif
+
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  /// 获取映射的数据
+  const char* Data() const { return data_; }
+
+  /// 获取文件大小
+  size_t Size() const { return size_; }
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace ytlib
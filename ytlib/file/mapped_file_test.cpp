@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "mapped_file.hpp"
+
+namespace ytlib {
+
+TEST(MAPPED_FILE_TEST, BASE_test) {
+  const std::string path = "test_mapped_file.bin";
+  const std::string data = "mapped file test data";
+
+  std::ofstream ofile(path, std::ios::binary | std::ios::trunc);
+  ASSERT_TRUE(ofile);
+  ofile << data;
+  ofile.close();
+
+  MappedFile file;
+  ASSERT_TRUE(file.Open(path));
+  ASSERT_EQ(file.Size(), data.size());
+  EXPECT_EQ(std::string(file.Data(), file.Size()), data);
+
+  MappedFile file2(std::move(file));
+  EXPECT_EQ(file.Data(), nullptr);
+  EXPECT_EQ(std::string(file2.Data(), file2.Size()), data);
+
+  file2.Close();
+  EXPECT_EQ(file2.Data(), nullptr);
+  EXPECT_EQ(file2.Size(), 0);
+
+  // 空文件
+  std::ofstream(path, std::ios::binary | std::ios::trunc).close();
+  ASSERT_TRUE(file2.Open(path));
+  EXPECT_EQ(file2.Size(), 0);
+
+  EXPECT_FALSE(file2.Open("not_exist_mapped_file.bin"));
+
+  std::filesystem::remove(path);
+}
+
+}  // namespace ytlib
@@ -10,20 +10,35 @@
 
 namespace ytlib {
 
-template <typename>
+template <typename, size_t BufSize = YTLIB_FUNCTION_LOCAL_BUF_SIZE>
 class Function;
 
+namespace details {
+
+template <size_t BufSize>
+struct FunctionStorage {
+  alignas(void*) unsigned char object_buf[BufSize];
+  const void* ops;
+};
+
+/// 默认大小时与C结构体一致，可以与C互调
+template <size_t BufSize>
+using FunctionBaseType = std::conditional_t<BufSize == YTLIB_FUNCTION_LOCAL_BUF_SIZE, ytlib_function_base_t, FunctionStorage<BufSize>>;
+
+}  // namespace details
+
 /**
  * @brief Function
- * @note 由callable类型构造，适用性广
+ * @note 由callable类型构造，适用性广。不超过BufSize的callable直接存放在内部，否则在堆上分配
  * @todo
  * 1. noexcept类型
  * 2. 增加内存池/alloctor等参数，减少内存开销
  * @tparam R
  * @tparam Args
+ * @tparam BufSize 内部存储大小，非默认大小时不能使用NativeHandle与C互调
  */
-template <class R, class... Args>
-class Function<R(Args...)> {
+template <class R, class... Args, size_t BufSize>
+class Function<R(Args...), BufSize> {
  public:
   using InvokerType = R (*)(void* object, Args&&... args);
 
@@ -46,7 +61,9 @@ class Function<R(Args...)> {
     if (base_.ops) static_cast<const OpsType*>(base_.ops)->relocator(&(function.base_.object_buf), &(base_.object_buf));
   }
 
-  Function(ytlib_function_base_t* function_base) {
+  Function(ytlib_function_base_t* function_base)
+    requires(BufSize == YTLIB_FUNCTION_LOCAL_BUF_SIZE)
+  {
     base_.ops = std::exchange(function_base->ops, nullptr);
     if (base_.ops) static_cast<const OpsType*>(base_.ops)->relocator(&(function_base->object_buf), &(base_.object_buf));
   }
@@ -130,11 +147,15 @@ class Function<R(Args...)> {
 
   explicit operator bool() const { return (base_.ops != nullptr); }
 
-  ytlib_function_base_t* NativeHandle() { return &base_; }
-  const ytlib_function_base_t* NativeHandle() const { return &base_; }
+  ytlib_function_base_t* NativeHandle()
+    requires(BufSize == YTLIB_FUNCTION_LOCAL_BUF_SIZE)
+  { return &base_; }
+  const ytlib_function_base_t* NativeHandle() const
+    requires(BufSize == YTLIB_FUNCTION_LOCAL_BUF_SIZE)
+  { return &base_; }
 
  private:
-  mutable ytlib_function_base_t base_;
+  mutable details::FunctionBaseType<BufSize> base_;
 };
 
 template <typename>
@@ -326,16 +347,16 @@ Function(R (*)(Args...)) -> Function<R(Args...)>;
 template <class F, class Signature = details::FunctionSignature<decltype(&F::operator())>>
 Function(F) -> Function<Signature>;
 
-template <class T>
-bool operator==(const Function<T>& f, std::nullptr_t) { return !f; }
+template <class T, size_t BufSize>
+bool operator==(const Function<T, BufSize>& f, std::nullptr_t) { return !f; }
 
-template <class T>
-bool operator==(std::nullptr_t, const Function<T>& f) { return !f; }
+template <class T, size_t BufSize>
+bool operator==(std::nullptr_t, const Function<T, BufSize>& f) { return !f; }
 
-template <class T>
-bool operator!=(const Function<T>& f, std::nullptr_t) { return !(f == nullptr); }
+template <class T, size_t BufSize>
+bool operator!=(const Function<T, BufSize>& f, std::nullptr_t) { return !(f == nullptr); }
 
-template <class T>
-bool operator!=(std::nullptr_t, const Function<T>& f) { return !(f == nullptr); }
+template <class T, size_t BufSize>
+bool operator!=(std::nullptr_t, const Function<T, BufSize>& f) { return !(f == nullptr); }
 
 }  // namespace ytlib
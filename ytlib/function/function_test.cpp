@@ -131,6 +131,32 @@ TEST(FUNCTION_TEST, LargeFunctorTest) {
   }
 }
 
+TEST(FUNCTION_TEST, BufSizeTest) {
+  struct Payload {
+    char buf[40];
+  };
+
+  Payload payload;
+  payload.buf[39] = 42;
+
+  Function<int(), 48> f = [payload] { return payload.buf[39]; };
+  static_assert(sizeof(f) == 48 + sizeof(void*));
+  ASSERT_EQ(42, f());
+
+  Function<int(), 48> f2(std::move(f));
+  ASSERT_FALSE(f);
+  ASSERT_EQ(42, f2());
+
+  // 超过内部存储大小时在堆上分配
+  char large_payload[100];
+  large_payload[99] = 24;
+  f = [large_payload] { return large_payload[99]; };
+  ASSERT_EQ(24, f());
+
+  f = nullptr;
+  ASSERT_TRUE(f == nullptr);
+}
+
 TEST(FUNCTION_TEST, FunctorMoveTest) {
   struct OnlyCopyable {
     OnlyCopyable() : v(new std::vector<int>()) {}
@@ -12,6 +12,8 @@
 #include <functional>
 #include <mutex>
 #include <queue>
+#include <ranges>
+#include <type_traits>
 
 namespace ytlib {
 /**
@@ -49,23 +51,35 @@ class BlockQueue {
   /// 添加元素
   bool Enqueue(const T &item) {
     std::lock_guard<std::mutex> lck(mutex_);
-    if (queue_.size() < maxcount_) {
-      queue_.emplace(item);
-      cond_.notify_one();
-      return true;
-    }
-    return false;
+    if (!PushLocked(item)) return false;
+    cond_.notify_one();
+    return true;
   }
 
   /// 添加元素
   bool Enqueue(T &&item) {
     std::lock_guard<std::mutex> lck(mutex_);
-    if (queue_.size() < maxcount_) {
-      queue_.emplace(std::move(item));
-      cond_.notify_one();
-      return true;
+    if (!PushLocked(std::move(item))) return false;
+    cond_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief 批量添加元素
+   * @note 只加一次锁、只进行一次唤醒。元素的move/copy规则见RangeItem
+   * @param items 元素range
+   * @return size_t 成功添加的个数，队列满时后续元素不会被添加
+   */
+  template <std::ranges::input_range R>
+  size_t EnqueueBatch(R &&items) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    size_t n = 0;
+    for (auto &&item : items) {
+      if (!PushLocked(RangeItem<R>(item))) break;
+      ++n;
     }
-    return false;
+    NotifyBatch(n);
+    return n;
   }
 
   /// 非阻塞式取出元素
@@ -79,6 +93,19 @@ class BlockQueue {
     return false;
   }
 
+  /**
+   * @brief 非阻塞式批量取出元素
+   * @note 只加一次锁
+   * @param out 输出迭代器，例如std::back_inserter(vec)
+   * @param max_n 最多取出的个数
+   * @return size_t 实际取出的个数
+   */
+  template <class OutputIt>
+  size_t DequeueBatch(OutputIt out, size_t max_n) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    return PopBatch(out, max_n);
+  }
+
   /// 阻塞式取出元素
   bool BlockDequeue(T &item) {
     std::unique_lock<std::mutex> lck(mutex_);
@@ -109,7 +136,78 @@ class BlockQueue {
     return true;
   }
 
+  /**
+   * @brief 阻塞式批量取出元素
+   * @note 只加一次锁。队列为空时阻塞，被唤醒后取出当前所有可取的元素（最多max_n个）
+   * @param out 输出迭代器，例如std::back_inserter(vec)
+   * @param max_n 最多取出的个数
+   * @return size_t 实际取出的个数，为0表示队列已停止或未取到元素
+   */
+  template <class OutputIt>
+  size_t BlockDequeueBatch(OutputIt out, size_t max_n) {
+    std::unique_lock<std::mutex> lck(mutex_);
+    if (queue_.empty()) {
+      if (!running_flag_) return 0;
+      cond_.wait(lck);
+    }
+    return PopBatch(out, max_n);
+  }
+
  protected:
+  /**
+   * @brief 批量添加时取出range中的元素
+   * @note 只有持有元素的右值range（如临时的vector）中的元素才会被move。
+   * 左值range以及span、filter等view即使是右值也可能引用调用方的数据，其中的元素会被拷贝
+   * @tparam R EnqueueBatch的range参数类型
+   */
+  template <class R, class U>
+  static constexpr auto &&RangeItem(U &item) {
+    if constexpr (!std::is_lvalue_reference_v<R> && !std::ranges::view<std::remove_cvref_t<R>> && !std::ranges::borrowed_range<R>) {
+      return std::move(item);
+    } else {
+      return item;
+    }
+  }
+
+  /**
+   * @brief 在持有锁的情况下添加一个元素
+   * @note 所有添加接口都经过此函数，派生类可以重写以改变元素的去向
+   * @return false 队列已满
+   */
+  virtual bool PushLocked(const T &item) {
+    if (queue_.size() >= maxcount_) return false;
+    queue_.emplace(item);
+    return true;
+  }
+
+  /// 在持有锁的情况下添加一个元素
+  virtual bool PushLocked(T &&item) {
+    if (queue_.size() >= maxcount_) return false;
+    queue_.emplace(std::move(item));
+    return true;
+  }
+
+  /// 在持有锁的情况下取出最多max_n个元素
+  template <class OutputIt>
+  size_t PopBatch(OutputIt &out, size_t max_n) {
+    size_t n = 0;
+    for (; n < max_n && !queue_.empty(); ++n) {
+      *out = std::move(queue_.front());
+      ++out;
+      queue_.pop();
+    }
+    return n;
+  }
+
+  /// 批量添加n个元素后进行一次唤醒
+  void NotifyBatch(size_t n) {
+    if (n == 1) {
+      cond_.notify_one();
+    } else if (n > 1) {
+      cond_.notify_all();
+    }
+  }
+
   const size_t maxcount_;  ///< 队列可支持最大个数
 
   mutable std::mutex mutex_;      ///< 同步锁
@@ -1,24 +1,191 @@
 /**
  * @file block_ring.hpp
  * @brief 阻塞环形队列
- * @note 线程安全的阻塞环形队列
+ * @note 线程安全的阻塞环形队列，基于每个槽位的序列号实现的无锁有界多生产者多消费者队列
  * @author WT
  * @date 2021-05-06
  */
 #pragma once
 
+#include <atomic>
 #include <cinttypes>
+#include <cstddef>
+#include <new>
+#include <utility>
 
 namespace ytlib {
 /**
  * @brief 线程安全的阻塞环形队列
+ * @note 固定容量的无锁MPMC队列。每个槽位带一个序列号，生产者/消费者通过CAS抢占读写位置，
+ * 读写位置分别位于独立的cache line上以避免伪共享。
+ * 阻塞式接口基于c++20中atomic的wait/notify实现，只有存在等待者时才会进行唤醒。
+ * T的构造、移动赋值不应抛出异常。
+ * @tparam T 元素类型
+ * @tparam BUF_SIZE 容量，必须为2的幂
  */
 template <class T, uint32_t BUF_SIZE>
 class BlockRing {
+  static_assert(BUF_SIZE >= 2 && (BUF_SIZE & (BUF_SIZE - 1)) == 0, "BUF_SIZE must be a power of 2.");
+
  public:
-  BlockRing() = default;
-  virtual ~BlockRing() = default;
+  BlockRing() {
+    for (uint32_t ii = 0; ii < BUF_SIZE; ++ii)
+      slots_[ii].seq.store(ii, std::memory_order_relaxed);
+  }
+
+  virtual ~BlockRing() {
+    Stop();
+    uint64_t pos = head_.load(std::memory_order_relaxed);
+    const uint64_t end = tail_.load(std::memory_order_relaxed);
+    for (; pos != end; ++pos)
+      slots_[pos & kMask].Ptr()->~T();
+  }
+
+  BlockRing(const BlockRing &) = delete;
+  BlockRing &operator=(const BlockRing &) = delete;
+
+  /// 获取最大容量
+  constexpr size_t GetMaxCount() const { return BUF_SIZE; }
+
+  /// 获取当前容量，并发情况下仅为近似值
+  size_t Count() const {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    const uint64_t tail = tail_.load(std::memory_order_acquire);
+    return (tail > head) ? static_cast<size_t>(tail - head) : 0;
+  }
+
+  /// 是否为空，并发情况下仅为近似值
+  bool Empty() const { return Count() == 0; }
+
+  /// 停止队列，唤醒所有阻塞的读写操作
+  void Stop() {
+    running_flag_.store(false);
+    push_event_.fetch_add(1);
+    push_event_.notify_all();
+    pop_event_.fetch_add(1);
+    pop_event_.notify_all();
+  }
+
+  /// 非阻塞式构造添加元素
+  template <class... Args>
+  bool TryEmplace(Args &&...args) {
+    Slot *slot;
+    uint64_t pos = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      slot = &slots_[pos & kMask];
+      const int64_t dif = static_cast<int64_t>(slot->seq.load(std::memory_order_acquire)) - static_cast<int64_t>(pos);
+      if (dif == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (dif < 0) {
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+
+    new (slot->data) T(std::forward<Args>(args)...);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    Notify(pop_waiters_, push_event_);
+    return true;
+  }
+
+  /// 非阻塞式添加元素
+  bool TryPush(const T &item) { return TryEmplace(item); }
+
+  /// 非阻塞式添加元素
+  bool TryPush(T &&item) { return TryEmplace(std::move(item)); }
+
+  /// 非阻塞式取出元素
+  bool TryPop(T &item) {
+    Slot *slot;
+    uint64_t pos = head_.load(std::memory_order_relaxed);
+    while (true) {
+      slot = &slots_[pos & kMask];
+      const int64_t dif = static_cast<int64_t>(slot->seq.load(std::memory_order_acquire)) - static_cast<int64_t>(pos + 1);
+      if (dif == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (dif < 0) {
+        return false;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+
+    T *ptr = slot->Ptr();
+    item = std::move(*ptr);
+    ptr->~T();
+    slot->seq.store(pos + BUF_SIZE, std::memory_order_release);
+    Notify(push_waiters_, pop_event_);
+    return true;
+  }
+
+  /// 阻塞式添加元素，队列满时等待，队列停止后返回false
+  bool BlockPush(const T &item) {
+    return BlockWait(push_waiters_, pop_event_, [&] { return TryEmplace(item); });
+  }
+
+  /// 阻塞式添加元素，队列满时等待，队列停止后返回false
+  bool BlockPush(T &&item) {
+    return BlockWait(push_waiters_, pop_event_, [&] { return TryEmplace(std::move(item)); });
+  }
+
+  /// 阻塞式取出元素，队列空时等待，队列停止且为空时返回false
+  bool BlockPop(T &item) {
+    return BlockWait(pop_waiters_, push_event_, [&] { return TryPop(item); });
+  }
+
+ private:
+  static constexpr uint64_t kMask = BUF_SIZE - 1;
+  static constexpr size_t kCacheLineSize = 64;
+
+  struct Slot {
+    T *Ptr() { return std::launder(reinterpret_cast<T *>(data)); }
+
+    std::atomic<uint64_t> seq;
+    alignas(T) unsigned char data[sizeof(T)];
+  };
+
+  /// 完成一次读/写后，若存在对端的等待者则唤醒
+  static void Notify(std::atomic<uint32_t> &waiters, std::atomic<uint32_t> &event) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) == 0) return;
+    event.fetch_add(1);
+    event.notify_all();
+  }
+
+  /// 循环尝试op，失败时在event上等待
+  template <class Op>
+  bool BlockWait(std::atomic<uint32_t> &waiters, std::atomic<uint32_t> &event, const Op &op) {
+    if (op()) return true;
+
+    while (true) {
+      waiters.fetch_add(1);
+      const uint32_t cur_event = event.load();
+      if (op()) {
+        waiters.fetch_sub(1);
+        return true;
+      }
+      if (!running_flag_.load()) {
+        waiters.fetch_sub(1);
+        return false;
+      }
+      event.wait(cur_event);
+      waiters.fetch_sub(1);
+      if (op()) return true;
+    }
+  }
+
+  alignas(kCacheLineSize) std::atomic<uint64_t> head_ = 0;  ///< 读位置
+  alignas(kCacheLineSize) std::atomic<uint64_t> tail_ = 0;  ///< 写位置
+
+  alignas(kCacheLineSize) std::atomic<uint32_t> push_event_ = 0;  ///< 写入事件计数
+  std::atomic<uint32_t> pop_waiters_ = 0;                         ///< 阻塞读等待者数
+
+  alignas(kCacheLineSize) std::atomic<uint32_t> pop_event_ = 0;  ///< 取出事件计数
+  std::atomic<uint32_t> push_waiters_ = 0;                       ///< 阻塞写等待者数
+
+  alignas(kCacheLineSize) std::atomic_bool running_flag_ = true;  ///< 运行标志，为false时，阻塞式操作失败后直接返回
 
- protected:
+  alignas(kCacheLineSize) Slot slots_[BUF_SIZE];  ///< 槽位
 };
-}  // namespace ytlib
\ No newline at end of file
+}  // namespace ytlib
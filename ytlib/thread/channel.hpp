@@ -7,10 +7,17 @@
  */
 #pragma once
 
+#include <iterator>
 #include <list>
+#include <memory>
+#include <ranges>
+#include <span>
 #include <thread>
+#include <vector>
 
+#include "ytlib/misc/misc_macro.h"
 #include "ytlib/thread/block_queue.hpp"
+#include "ytlib/thread/work_stealing_executor.hpp"
 
 namespace ytlib {
 
@@ -20,6 +27,7 @@ namespace ytlib {
  * 单队列，异步添加，可以多线程处理数据的通道。
  * 从进入通道到取出通道数据会经过复制操作。因此建议始终传递share_ptr一类的指针。
  * 使用阻塞取出，无法暂停，一旦开启将一直取出数据进行处理，直到无数据可取时阻塞。
+ * 也可以通过InitExecutor将处理函数运行在WorkStealingExecutor上，此时不会启动消费者线程。
  */
 template <class T>
 class Channel : public BlockQueue<T> {
@@ -38,11 +46,86 @@ class Channel : public BlockQueue<T> {
    */
   void Init(const std::function<void(T &&)> &f, uint32_t th_size = 1) {
     f_ = f;
+    batch_f_ = nullptr;
+    executor_ptr_ = nullptr;
     th_size_ = th_size;
   }
 
+  /**
+   * @brief 以批处理模式初始化
+   * @note 每个消费者线程加一次锁取出最多batch_size个元素，再一次性交给处理函数。
+   * 处理函数可以move走span中的元素
+   * @param f 批量处理内容的函数
+   * @param th_size 消费者线程数
+   * @param batch_size 每批最多元素数
+   */
+  void InitBatch(const std::function<void(std::span<T>)> &f, uint32_t th_size = 1, size_t batch_size = 64) {
+    f_ = nullptr;
+    batch_f_ = f;
+    executor_ptr_ = nullptr;
+    th_size_ = th_size;
+    batch_size_ = (batch_size == 0) ? 1 : batch_size;
+  }
+
+  /**
+   * @brief 以线程池模式初始化
+   * @note 开启后每个元素直接作为一个任务投递到executor中处理，不经过队列的锁。
+   * 开启前添加的元素会缓存在队列中，开启时统一投递。
+   * 开启后通过Channel或BlockQueue接口添加的元素都直接投递，通过Channel对象调用时不加锁。
+   * 队列容量限制的是已投递但未处理完的元素个数。
+   * executor停止后添加元素会失败。executor的生命周期需要长于Channel
+   * @param f 处理内容的函数。参数推荐使用（智能）指针
+   * @param executor 运行处理函数的线程池
+   */
+  void InitExecutor(const std::function<void(T &&)> &f, WorkStealingExecutor &executor) {
+    f_ = f;
+    batch_f_ = nullptr;
+    executor_ptr_ = &executor;
+    if (!executor_state_ptr_) executor_state_ptr_ = std::make_shared<ExecutorState>();
+  }
+
+  /// 添加元素
+  bool Enqueue(const T &item) {
+    if (executor_ptr_ == nullptr) return BlockQueue<T>::Enqueue(item);
+    return ExecutorEnqueue(item);
+  }
+
+  /// 添加元素
+  bool Enqueue(T &&item) {
+    if (executor_ptr_ == nullptr) return BlockQueue<T>::Enqueue(std::move(item));
+    return ExecutorEnqueue(std::move(item));
+  }
+
+  /**
+   * @brief 批量添加元素
+   * @note 元素的move/copy规则与BlockQueue::EnqueueBatch相同
+   * @param items 元素range
+   * @return size_t 成功添加的个数，队列满时后续元素不会被添加
+   */
+  template <std::ranges::input_range R>
+  size_t EnqueueBatch(R &&items) {
+    if (executor_ptr_ == nullptr) return BlockQueue<T>::EnqueueBatch(std::forward<R>(items));
+
+    size_t n = 0;
+    for (auto &&item : items) {
+      if (!ExecutorEnqueue(BlockQueue<T>::template RangeItem<R>(item))) break;
+      ++n;
+    }
+    return n;
+  }
+
   /// 开启线程
   void StartProcess() {
+    if (executor_ptr_) {
+      StartExecutorProcess();
+      return;
+    }
+
+    if (batch_f_) {
+      StartBatchProcess();
+      return;
+    }
+
     if (!f_) throw std::logic_error("Invalid HandleFun.");
 
     for (uint32_t ii = 0; ii < th_size_; ++ii) {
@@ -71,12 +154,129 @@ class Channel : public BlockQueue<T> {
         itr->join();
       threads_.erase(itr++);
     }
+
+    if (!executor_state_ptr_) return;
+
+    // 等待投递到线程池中的元素处理完
+    auto &pending = executor_state_ptr_->pending;
+    for (size_t n = pending.load(); n != 0; n = pending.load())
+      pending.wait(n);
   }
 
  protected:
-  std::function<void(T &&)> f_;     ///< 处理函数
-  uint32_t th_size_ = 1;            ///< 线程数
-  std::list<std::thread> threads_;  ///< 运行线程
+  /// 线程池模式下，通过BlockQueue接口添加的元素也按Channel的规则缓存或投递
+  bool PushLocked(const T &item) override {
+    if (executor_ptr_ == nullptr) return BlockQueue<T>::PushLocked(item);
+    return ExecutorPushLocked(item);
+  }
+
+  bool PushLocked(T &&item) override {
+    if (executor_ptr_ == nullptr) return BlockQueue<T>::PushLocked(std::move(item));
+    return ExecutorPushLocked(std::move(item));
+  }
+
+  void StartBatchProcess() {
+    for (uint32_t ii = 0; ii < th_size_; ++ii) {
+      threads_.emplace(threads_.end(), [&] {
+        std::vector<T> batch;
+        batch.reserve(batch_size_);
+        std::unique_lock<std::mutex> lck(BlockQueue<T>::mutex_);
+        while (true) {
+          while (!BlockQueue<T>::queue_.empty()) {
+            auto out = std::back_inserter(batch);
+            BlockQueue<T>::PopBatch(out, batch_size_);
+            lck.unlock();
+            batch_f_(std::span<T>(batch));
+            batch.clear();
+            lck.lock();
+          }
+          if (!BlockQueue<T>::running_flag_) return;
+          BlockQueue<T>::cond_.wait(lck);
+        }
+      });
+    }
+  }
+
+  void StartExecutorProcess() {
+    if (!f_) throw std::logic_error("Invalid HandleFun.");
+
+    std::lock_guard<std::mutex> lck(BlockQueue<T>::mutex_);
+    if (executor_start_flag_.load(std::memory_order_relaxed)) return;
+
+    PostQueueToExecutor();
+    executor_start_flag_.store(true, std::memory_order_release);
+  }
+
+  /// 在持有锁的情况下将队列中的元素全部投递到线程池，线程池已经停止时丢弃
+  void PostQueueToExecutor() {
+    while (!BlockQueue<T>::queue_.empty()) {
+      executor_state_ptr_->pending.fetch_add(1);
+      if (!PostToExecutor(std::move(BlockQueue<T>::queue_.front()))) [[unlikely]] {
+        DBG_PRINT("Channel executor is stopped, drop item.");
+        executor_state_ptr_->FinishOne();
+      }
+      BlockQueue<T>::queue_.pop();
+    }
+  }
+
+  template <class U>
+  bool ExecutorEnqueue(U &&item) {
+    if (!executor_start_flag_.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lck(BlockQueue<T>::mutex_);
+      return ExecutorPushLocked(std::forward<U>(item));
+    }
+    return ExecutorPost(std::forward<U>(item));
+  }
+
+  /// 在持有锁的情况下添加元素，开启前缓存在队列中，开启后直接投递
+  template <class U>
+  bool ExecutorPushLocked(U &&item) {
+    if (executor_start_flag_.load(std::memory_order_relaxed)) return ExecutorPost(std::forward<U>(item));
+    return BlockQueue<T>::PushLocked(std::forward<U>(item));
+  }
+
+  template <class U>
+  bool ExecutorPost(U &&item) {
+    // 队列已满或线程池已经停止时，元素不会被处理，也不计入pending
+    if (executor_state_ptr_->pending.fetch_add(1) >= BlockQueue<T>::maxcount_ ||
+        !PostToExecutor(std::forward<U>(item))) [[unlikely]] {
+      executor_state_ptr_->FinishOne();
+      return false;
+    }
+    return true;
+  }
+
+  template <class U>
+  bool PostToExecutor(U &&item) {
+    // 任务持有共享状态的引用，处理完最后一个元素后StopProcess可能立即返回、Channel随即析构，此后不能再访问this
+    return executor_ptr_->Post([this, state_ptr = executor_state_ptr_, item = T(std::forward<U>(item))]() mutable {
+      try {
+        f_(std::move(item));
+      } catch (const std::exception &e) {
+        DBG_PRINT("Channel handle get exception, %s", e.what());
+      }
+      state_ptr->FinishOne();
+    });
+  }
+
+  /// 线程池模式下Channel与已投递的任务共享的状态
+  struct ExecutorState {
+    std::atomic<size_t> pending = 0;  ///< 已投递但未处理完的元素个数
+
+    void FinishOne() {
+      if (pending.fetch_sub(1) == 1) pending.notify_all();
+    }
+  };
+
+  std::function<void(T &&)> f_;                ///< 处理函数
+  std::function<void(std::span<T>)> batch_f_;  ///< 批量处理函数
+  uint32_t th_size_ = 1;                       ///< 线程数
+  size_t batch_size_ = 64;                     ///< 批量处理时每批最多元素数
+  std::list<std::thread> threads_;             ///< 运行线程
+
+  WorkStealingExecutor *executor_ptr_ = nullptr;       ///< 线程池模式下运行处理函数的线程池
+  std::atomic_bool executor_start_flag_ = false;       ///< 线程池模式是否已开启
+  std::shared_ptr<ExecutorState> executor_state_ptr_;  ///< 线程池模式下与已投递的任务共享的状态
 };
 
 }  // namespace ytlib
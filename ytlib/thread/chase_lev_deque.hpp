@@ -0,0 +1,144 @@
+/**
+ * @file chase_lev_deque.hpp
+ * @brief Chase-Lev工作窃取双端队列
+ * @note 基于《Correct and Efficient Work-Stealing for Weak Memory Models》中的c11实现
+ * @author WT
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace ytlib {
+
+/**
+ * @brief Chase-Lev工作窃取双端队列
+ * @note 无界无锁队列。只有拥有者线程可以调用Push/Pop（在底部操作，LIFO），
+ * 其他任意线程可以调用Steal（从顶部窃取，FIFO）。
+ * 扩容时旧数组会保留到队列析构，以保证并发的Steal不会访问已释放内存。
+ * @tparam T 元素类型，必须可平凡复制，一般为指针
+ */
+template <class T>
+class ChaseLevDeque {
+  static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable.");
+
+ public:
+  /**
+   * @brief 构造函数
+   * @param capacity 初始容量，会被调整为2的幂
+   */
+  explicit ChaseLevDeque(size_t capacity = 1024) {
+    size_t real_capacity = 2;
+    while (real_capacity < capacity) real_capacity <<= 1;
+    arrays_.emplace_back(std::make_unique<Array>(static_cast<int64_t>(real_capacity)));
+    array_.store(arrays_.back().get(), std::memory_order_relaxed);
+  }
+
+  ~ChaseLevDeque() = default;
+
+  ChaseLevDeque(const ChaseLevDeque&) = delete;
+  ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+  /// 获取当前元素数，并发情况下仅为近似值
+  size_t Size() const {
+    const int64_t b = bottom_.load(std::memory_order_relaxed);
+    const int64_t t = top_.load(std::memory_order_relaxed);
+    return (b > t) ? static_cast<size_t>(b - t) : 0;
+  }
+
+  /// 是否为空，并发情况下仅为近似值
+  bool Empty() const { return Size() == 0; }
+
+  /// 获取当前容量
+  size_t Capacity() const {
+    return static_cast<size_t>(array_.load(std::memory_order_relaxed)->capacity);
+  }
+
+  /// 在底部添加元素，只能由拥有者线程调用
+  void Push(T item) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed);
+    const int64_t t = top_.load(std::memory_order_acquire);
+    Array* a = array_.load(std::memory_order_relaxed);
+    if (b - t > a->capacity - 1) {
+      a = Grow(a, b, t);
+    }
+    a->Put(b, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  /// 从底部取出元素，只能由拥有者线程调用
+  bool Pop(T& item) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Array* a = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+
+    item = a->Get(b);
+    if (t == b) {
+      // 最后一个元素，与Steal竞争
+      const bool ret = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return ret;
+    }
+    return true;
+  }
+
+  /// 从顶部窃取元素，任意线程可调用。竞争失败时也会返回false
+  bool Steal(T& item) {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom_.load(std::memory_order_acquire);
+
+    if (t >= b) return false;
+
+    Array* a = array_.load(std::memory_order_acquire);
+    item = a->Get(t);
+    return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  struct Array {
+    explicit Array(int64_t cap)
+        : capacity(cap), mask(cap - 1), buf(std::make_unique<std::atomic<T>[]>(static_cast<size_t>(cap))) {}
+
+    T Get(int64_t i) const { return buf[i & mask].load(std::memory_order_relaxed); }
+    void Put(int64_t i, T item) { buf[i & mask].store(item, std::memory_order_relaxed); }
+
+    const int64_t capacity;
+    const int64_t mask;
+    std::unique_ptr<std::atomic<T>[]> buf;
+  };
+
+  Array* Grow(Array* a, int64_t b, int64_t t) {
+    auto new_array = std::make_unique<Array>(a->capacity * 2);
+    for (int64_t ii = t; ii < b; ++ii)
+      new_array->Put(ii, a->Get(ii));
+
+    Array* ptr = new_array.get();
+    arrays_.emplace_back(std::move(new_array));
+    array_.store(ptr, std::memory_order_release);
+    return ptr;
+  }
+
+  alignas(kCacheLineSize) std::atomic<int64_t> top_ = 0;     ///< 顶部位置，窃取者竞争
+  alignas(kCacheLineSize) std::atomic<int64_t> bottom_ = 0;  ///< 底部位置，拥有者操作
+  alignas(kCacheLineSize) std::atomic<Array*> array_;        ///< 当前数组
+
+  std::vector<std::unique_ptr<Array>> arrays_;  ///< 所有分配过的数组，只由拥有者线程修改
+};
+
+}  // namespace ytlib
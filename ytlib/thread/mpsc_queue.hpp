@@ -0,0 +1,96 @@
+/**
+ * @file mpsc_queue.hpp
+ * @brief 侵入式无锁多生产者单消费者队列
+ * @note 基于Dmitry Vyukov的intrusive MPSC node-based queue实现
+ * @author WT
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+
+namespace ytlib {
+
+/// MpscQueue的侵入式链接，元素类型需要继承此类型
+struct MpscQueueHook {
+  std::atomic<MpscQueueHook*> mpsc_next = nullptr;
+};
+
+/**
+ * @brief 侵入式无锁多生产者单消费者队列
+ * @note 无界队列，不分配内存，元素的生命周期由使用者管理。
+ * Push为wait-free，任意线程可以调用；Pop只能由一个消费者线程调用。
+ * 某个生产者在Push过程中被挂起时，Pop可能暂时取不到在其之后入队的元素，挂起的生产者完成Push后即可取到
+ * @tparam T 元素类型，需要继承MpscQueueHook
+ */
+template <class T>
+  requires std::derived_from<T, MpscQueueHook>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(&stub_), tail_(&stub_) {}
+  ~MpscQueue() = default;
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  /// 添加元素，可以由任意线程调用
+  void Push(T* item) { PushHook(item); }
+
+  /**
+   * @brief 取出元素，只能由消费者线程调用
+   *
+   * @return T* 队列为空或暂时取不到时返回nullptr
+   */
+  T* Pop() {
+    MpscQueueHook* head = head_;
+    MpscQueueHook* next = head->mpsc_next.load(std::memory_order_acquire);
+
+    if (head == &stub_) {
+      if (next == nullptr) return nullptr;
+      head_ = head = next;
+      next = next->mpsc_next.load(std::memory_order_acquire);
+    }
+
+    if (next != nullptr) {
+      head_ = next;
+      return static_cast<T*>(head);
+    }
+
+    // head是最后一个元素，或者有生产者还没有完成链接
+    if (head != tail_.load(std::memory_order_acquire)) return nullptr;
+
+    // 放回stub以便取出最后一个元素
+    PushHook(&stub_);
+    next = head->mpsc_next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      head_ = next;
+      return static_cast<T*>(head);
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief 是否为空
+   * @note 可以由任意线程调用，并发情况下仅为近似值。有生产者正在Push时返回false
+   */
+  bool Empty() const {
+    return tail_.load(std::memory_order_acquire) == &stub_;
+  }
+
+ private:
+  void PushHook(MpscQueueHook* hook) {
+    hook->mpsc_next.store(nullptr, std::memory_order_relaxed);
+    MpscQueueHook* prev = tail_.exchange(hook, std::memory_order_acq_rel);
+    prev->mpsc_next.store(hook, std::memory_order_release);
+  }
+
+  static constexpr size_t kCacheLineSize = 64;
+
+  alignas(kCacheLineSize) MpscQueueHook* head_;            // 消费者使用
+  alignas(kCacheLineSize) std::atomic<MpscQueueHook*> tail_;  // 生产者竞争
+  MpscQueueHook stub_;
+};
+
+}  // namespace ytlib
@@ -0,0 +1,189 @@
+/**
+ * @file object_pool.hpp
+ * @brief 线程缓存的对象池
+ * @note 每个线程缓存一部分空闲内存块，缓存过多时按批归还到全局空闲链表，缓存为空时从全局取一批。
+ * 适用于对象在一个线程中创建、在另一个线程中销毁的场景，稳定状态下不会再分配内存
+ * @author WT
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <utility>
+
+namespace ytlib {
+
+/**
+ * @brief 线程缓存的对象池
+ * @note 只有静态接口，同一类型的所有实例共用一个池。空闲内存块不会还给系统，
+ * 除非全局空闲链表已满。线程退出时将其缓存的内存块全部归还到全局。
+ * 全局池故意不析构，静态对象的析构函数以及main返回后才退出的线程中仍然可以创建/销毁对象。
+ * 线程缓存析构后（例如在更早构造的thread_local对象的析构函数中）创建/销毁对象时不经过线程缓存，直接使用全局池
+ * @tparam T 对象类型
+ * @tparam BatchSize 线程缓存与全局之间每批交换的内存块数，线程缓存最多2*BatchSize个内存块
+ * @tparam MaxGlobalBatchNum 全局最多缓存的批数
+ */
+template <typename T, size_t BatchSize = 64, size_t MaxGlobalBatchNum = 256>
+class ObjectPool {
+  static_assert(BatchSize > 0, "BatchSize must be positive");
+
+ public:
+  /// 创建对象，可以由任意线程调用
+  template <typename... Args>
+  static T* New(Args&&... args) {
+    if (LocalCacheDestroyed()) [[unlikely]] {
+      Block* block = new Block;
+      try {
+        return new (block->storage) T(std::forward<Args>(args)...);
+      } catch (...) {
+        delete block;
+        throw;
+      }
+    }
+
+    LocalCache& local_cache = GetLocalCache();
+
+    Block* block = local_cache.Get();
+    if (block == nullptr) block = new Block;
+
+    try {
+      return new (block->storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+      local_cache.Put(block);
+      throw;
+    }
+  }
+
+  /// 销毁对象，可以由任意线程调用
+  static void Delete(T* obj) {
+    if (obj == nullptr) return;
+
+    obj->~T();
+
+    Block* block = reinterpret_cast<Block*>(obj);
+    if (LocalCacheDestroyed()) [[unlikely]] {
+      block->link.next = nullptr;
+      GetGlobalPool().PutBatch(block, 1);
+      return;
+    }
+
+    GetLocalCache().Put(block);
+  }
+
+ private:
+  /// 内存块，空闲时复用对象的内存作为链表节点
+  union Block {
+    struct {
+      Block* next;        // 批内的下一个内存块
+      Block* next_batch;  // 全局链表中下一批的首个内存块，只在每批的首个内存块中有效
+      size_t batch_num;   // 本批的内存块数，只在每批的首个内存块中有效
+    } link;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  static void FreeBlocks(Block* block) {
+    while (block != nullptr) {
+      Block* next = block->link.next;
+      delete block;
+      block = next;
+    }
+  }
+
+  class GlobalPool {
+   public:
+    std::pair<Block*, size_t> GetBatch() {
+      std::lock_guard<std::mutex> lck(mutex_);
+
+      if (batch_head_ == nullptr) return {nullptr, 0};
+
+      Block* batch = batch_head_;
+      batch_head_ = batch->link.next_batch;
+      --batch_count_;
+      return {batch, batch->link.batch_num};
+    }
+
+    void PutBatch(Block* batch, size_t num) {
+      {
+        std::lock_guard<std::mutex> lck(mutex_);
+
+        if (batch_count_ < MaxGlobalBatchNum) {
+          batch->link.next_batch = batch_head_;
+          batch->link.batch_num = num;
+          batch_head_ = batch;
+          ++batch_count_;
+          return;
+        }
+      }
+
+      FreeBlocks(batch);
+    }
+
+   private:
+    std::mutex mutex_;
+    Block* batch_head_ = nullptr;
+    size_t batch_count_ = 0;
+  };
+
+  class LocalCache {
+   public:
+    ~LocalCache() {
+      LocalCacheDestroyed() = true;
+      if (head_ != nullptr) GetGlobalPool().PutBatch(head_, num_);
+    }
+
+    Block* Get() {
+      if (head_ == nullptr) {
+        std::tie(head_, num_) = GetGlobalPool().GetBatch();
+        if (head_ == nullptr) return nullptr;
+      }
+
+      Block* block = head_;
+      head_ = block->link.next;
+      --num_;
+      return block;
+    }
+
+    void Put(Block* block) {
+      // 缓存已满，将前BatchSize个内存块归还到全局
+      if (num_ == 2 * BatchSize) {
+        Block* batch = head_;
+        Block* tail = head_;
+        for (size_t ii = 1; ii < BatchSize; ++ii) tail = tail->link.next;
+        head_ = tail->link.next;
+        tail->link.next = nullptr;
+        num_ -= BatchSize;
+        GetGlobalPool().PutBatch(batch, BatchSize);
+      }
+
+      block->link.next = head_;
+      head_ = block;
+      ++num_;
+    }
+
+   private:
+    Block* head_ = nullptr;
+    size_t num_ = 0;
+  };
+
+  // 故意泄漏，保证程序退出的任何阶段都可以访问
+  static GlobalPool& GetGlobalPool() {
+    static GlobalPool& global_pool = *new GlobalPool;
+    return global_pool;
+  }
+
+  static LocalCache& GetLocalCache() {
+    static thread_local LocalCache local_cache;
+    return local_cache;
+  }
+
+  // 本线程的线程缓存是否已经析构。bool没有析构函数，线程退出的任何阶段都可以访问
+  static bool& LocalCacheDestroyed() {
+    static thread_local bool destroyed = false;
+    return destroyed;
+  }
+};
+
+}  // namespace ytlib
@@ -1,13 +1,19 @@
 #include <benchmark/benchmark.h>
 
+#include <span>
+#include <vector>
+
 #include "block_queue.hpp"
+#include "block_ring.hpp"
 #include "channel.hpp"
 #include "guid.hpp"
+#include "work_stealing_executor.hpp"
 
 namespace ytlib {
 
 using TestQueue = BlockQueue<uint32_t>;
 using TestChannel = Channel<uint32_t>;
+using TestRing = BlockRing<uint32_t, 1024>;
 
 // 测试Enqueue耗时
 static void BM_BlockQueue_Enqueue(benchmark::State& state) {
@@ -90,6 +96,138 @@ static void BM_Channel(benchmark::State& state) {
 }
 BENCHMARK(BM_Channel)->Threads(1)->RangeMultiplier(2)->Range(1, 4);
 
+// 测试EnqueueBatch耗时
+static void BM_BlockQueue_EnqueueBatch(benchmark::State& state) {
+  uint32_t obj_num = 1000;
+  std::vector<uint32_t> objs(obj_num);
+  for (uint32_t ii = 0; ii < obj_num; ++ii)
+    objs[ii] = ii;
+
+  for (auto _ : state) {
+    TestQueue qu;
+    qu.EnqueueBatch(objs);
+  }
+}
+BENCHMARK(BM_BlockQueue_EnqueueBatch);
+
+// 测试DequeueBatch在单线程下耗时
+static void BM_BlockQueue_DequeueBatch(benchmark::State& state) {
+  auto batch_size = static_cast<size_t>(state.range(0));
+  uint32_t obj_num = 1000;
+  std::vector<uint32_t> out;
+  out.reserve(batch_size);
+
+  for (auto _ : state) {
+    state.PauseTiming();  // 暂停计时
+    TestQueue qu;
+    for (uint32_t ii = 0; ii < obj_num; ++ii) {
+      qu.Enqueue(ii);
+    }
+    state.ResumeTiming();  // 恢复计时
+
+    while (qu.DequeueBatch(std::back_inserter(out), batch_size) > 0)
+      out.clear();
+  }
+}
+BENCHMARK(BM_BlockQueue_DequeueBatch)->RangeMultiplier(4)->Range(1, 256);
+
+// 测试多线程下BlockQueue入队+出队耗时
+static void BM_BlockQueue_MultiThread(benchmark::State& state) {
+  static TestQueue qu;
+
+  for (auto _ : state) {
+    qu.Enqueue(1);
+    uint32_t re;
+    benchmark::DoNotOptimize(qu.Dequeue(re));
+  }
+}
+BENCHMARK(BM_BlockQueue_MultiThread)->ThreadRange(1, 16);
+
+// 测试多线程下BlockRing入队+出队耗时
+static void BM_BlockRing_MultiThread(benchmark::State& state) {
+  static TestRing qu;
+
+  for (auto _ : state) {
+    qu.TryPush(1);
+    uint32_t re;
+    benchmark::DoNotOptimize(qu.TryPop(re));
+  }
+}
+BENCHMARK(BM_BlockRing_MultiThread)->ThreadRange(1, 16);
+
+// 测试Channel批处理模式性能
+static void BM_Channel_Batch(benchmark::State& state) {
+  auto ch_size = state.range(0);
+
+  uint32_t obj_num = 1000;
+
+  auto f = [](std::span<uint32_t> inputs) {
+    for (auto& input : inputs) {
+      uint32_t re = input;
+      ++re;
+    }
+  };
+  for (auto _ : state) {
+    state.PauseTiming();  // 暂停计时
+    TestChannel ch;
+    ch.InitBatch(f, static_cast<uint32_t>(ch_size));
+    for (uint32_t jj = 0; jj < obj_num; ++jj)
+      ch.Enqueue(jj);
+    state.ResumeTiming();  // 恢复计时
+
+    ch.StartProcess();
+    ch.StopProcess();
+  }
+}
+BENCHMARK(BM_Channel_Batch)->Threads(1)->RangeMultiplier(2)->Range(1, 4);
+
+// 测试Channel线程池模式性能
+static void BM_Channel_Executor(benchmark::State& state) {
+  auto th_size = state.range(0);
+
+  uint32_t obj_num = 1000;
+
+  auto f = [](uint32_t&& input) {
+    uint32_t re = input;
+    ++re;
+  };
+  WorkStealingExecutor executor(static_cast<uint32_t>(th_size));
+  executor.Start();
+  for (auto _ : state) {
+    state.PauseTiming();  // 暂停计时
+    TestChannel ch;
+    ch.InitExecutor(f, executor);
+    for (uint32_t jj = 0; jj < obj_num; ++jj)
+      ch.Enqueue(jj);
+    state.ResumeTiming();  // 恢复计时
+
+    ch.StartProcess();
+    ch.StopProcess();
+  }
+}
+BENCHMARK(BM_Channel_Executor)->Threads(1)->RangeMultiplier(2)->Range(1, 4);
+
+// 测试WorkStealingExecutor投递耗时
+static void BM_WorkStealingExecutor_Post(benchmark::State& state) {
+  auto th_size = state.range(0);
+
+  uint32_t obj_num = 1000;
+
+  for (auto _ : state) {
+    WorkStealingExecutor executor(static_cast<uint32_t>(th_size));
+    executor.Start();
+    for (uint32_t jj = 0; jj < obj_num; ++jj) {
+      executor.Post([jj] {
+        uint32_t re = jj;
+        benchmark::DoNotOptimize(++re);
+      });
+    }
+    executor.Stop();
+    executor.Join();
+  }
+}
+BENCHMARK(BM_WorkStealingExecutor_Post)->Threads(1)->RangeMultiplier(2)->Range(1, 4);
+
 static void BM_GuidGener(benchmark::State& state) {
   // 生成mac值
   std::string mac = "testmac::abc::def";
@@ -3,16 +3,25 @@
 #include <atomic>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <ranges>
 #include <set>
+#include <span>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "block_queue.hpp"
+#include "block_ring.hpp"
+#include "chase_lev_deque.hpp"
 #include "channel.hpp"
 #include "coroutine_tools.hpp"
 #include "guid.hpp"
+#include "mpsc_queue.hpp"
+#include "object_pool.hpp"
 #include "signal.hpp"
 #include "thread_id.hpp"
+#include "work_stealing_executor.hpp"
 
 #include "ytlib/misc/misc_macro.h"
 
@@ -104,6 +113,132 @@ TEST(THREAD_TEST, Channel_BASE) {
   ASSERT_EQ(ct, obj_num);
 }
 
+// 测试Channel批处理模式
+TEST(THREAD_TEST, Channel_BATCH) {
+  using TestChannel = Channel<TestObj>;
+
+  std::atomic<uint32_t> ct = 0;
+  std::atomic<size_t> max_batch = 0;
+
+  auto f = [&](std::span<TestObj> objs) {
+    ct += static_cast<uint32_t>(objs.size());
+    size_t cur_max = max_batch;
+    while (objs.size() > cur_max && !max_batch.compare_exchange_weak(cur_max, objs.size())) {
+    }
+  };
+
+  TestChannel ch;
+  ch.InitBatch(f, 2, 8);
+  uint32_t obj_num = 100;
+  std::vector<TestObj> objs(obj_num);
+  ASSERT_EQ(ch.EnqueueBatch(std::move(objs)), obj_num);
+  ch.StartProcess();
+  ch.StopProcess();
+  ASSERT_EQ(ch.Count(), 0);
+  ASSERT_EQ(ct, obj_num);
+  ASSERT_LE(max_batch, 8);
+}
+
+// 测试Channel线程池模式
+TEST(THREAD_TEST, Channel_EXECUTOR) {
+  using TestChannel = Channel<TestObj>;
+
+  std::atomic<uint32_t> ct = 0;
+
+  auto f = [&](TestObj &&obj) {
+    ++ct;
+  };
+
+  WorkStealingExecutor executor(2);
+  executor.Start();
+
+  TestChannel ch;
+  ch.InitExecutor(f, executor);
+  uint32_t obj_num = 100;
+  for (uint32_t ii = 0; ii < obj_num / 2; ++ii) {
+    ch.Enqueue(TestObj());
+  }
+  ASSERT_EQ(ch.Count(), obj_num / 2);
+  ch.StartProcess();
+  for (uint32_t ii = obj_num / 2; ii < obj_num; ++ii) {
+    TestObj obj;
+    ch.Enqueue(obj);
+  }
+  ch.StopProcess();
+  ASSERT_EQ(ch.Count(), 0);
+  ASSERT_EQ(ct, obj_num);
+}
+
+// 测试Channel线程池模式下的批量添加
+TEST(THREAD_TEST, Channel_EXECUTOR_BATCH) {
+  using TestChannel = Channel<uint32_t>;
+
+  std::atomic<uint32_t> ct = 0;
+  std::atomic<uint32_t> sum = 0;
+
+  auto f = [&](uint32_t &&obj) {
+    ++ct;
+    sum += obj;
+  };
+
+  WorkStealingExecutor executor(2);
+  executor.Start();
+
+  TestChannel ch;
+  ch.InitExecutor(f, executor);
+
+  std::vector<uint32_t> in{1, 2, 3};
+  ASSERT_EQ(ch.EnqueueBatch(in), 3);
+  ch.StartProcess();
+  ASSERT_EQ(ch.EnqueueBatch(std::span(in)), 3);
+  ASSERT_EQ(ch.EnqueueBatch(std::vector<uint32_t>{10, 20}), 2);
+  ASSERT_EQ(in, std::vector<uint32_t>({1, 2, 3}));
+
+  // 通过BlockQueue接口添加的元素也直接投递，不会留在队列中
+  BlockQueue<uint32_t> &qu = ch;
+  ASSERT_EQ(qu.EnqueueBatch(std::vector<uint32_t>{100, 200}), 2);
+  ASSERT_TRUE(qu.Enqueue(300));
+  ASSERT_EQ(ch.Count(), 0);
+  for (int ii = 0; ii < 1000 && ct < 11; ++ii)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  ASSERT_EQ(ct, 11);
+
+  ch.StopProcess();
+  ASSERT_EQ(ch.Count(), 0);
+  ASSERT_EQ(ct, 11);
+  ASSERT_EQ(sum, 642);
+}
+
+// 测试Channel线程池模式下线程池先停止
+TEST(THREAD_TEST, Channel_EXECUTOR_STOP) {
+  using TestChannel = Channel<uint32_t>;
+
+  std::atomic<uint32_t> ct = 0;
+  auto f = [&](uint32_t &&obj) { ++ct; };
+
+  WorkStealingExecutor executor(2);
+  executor.Start();
+
+  {
+    TestChannel ch;
+    ch.InitExecutor(f, executor);
+    ASSERT_TRUE(ch.Enqueue(1));
+    ch.StartProcess();
+    ASSERT_TRUE(ch.Enqueue(2));
+
+    executor.Stop();
+    executor.Join();
+    ASSERT_EQ(ct, 2);
+
+    // 线程池停止后添加失败，Channel析构时不会阻塞
+    ASSERT_FALSE(ch.Enqueue(3));
+    ASSERT_EQ(ch.EnqueueBatch(std::vector<uint32_t>{4, 5}), 0);
+  }
+  ASSERT_EQ(ct, 2);
+
+  ASSERT_FALSE(executor.Post([&] { ++ct; }));
+}
+
 // 测试BlockQueue基础同步操作
 TEST(THREAD_TEST, BlockQueue_BASE) {
   using BckQueue = BlockQueue<TestObj>;
@@ -143,6 +278,80 @@ TEST(THREAD_TEST, BlockQueue_BASE) {
   ASSERT_EQ(qu.Count(), 0);
 }
 
+// 测试BlockQueue批量操作
+TEST(THREAD_TEST, BlockQueue_BATCH) {
+  BlockQueue<uint32_t> qu(5);
+
+  std::vector<uint32_t> in{0, 1, 2, 3};
+  ASSERT_EQ(qu.EnqueueBatch(in), 4);
+  ASSERT_EQ(in.size(), 4);
+  ASSERT_EQ(qu.EnqueueBatch(in), 1);
+  ASSERT_EQ(qu.Count(), 5);
+
+  std::vector<uint32_t> out;
+  ASSERT_EQ(qu.DequeueBatch(std::back_inserter(out), 3), 3);
+  ASSERT_EQ(out, std::vector<uint32_t>({0, 1, 2}));
+  ASSERT_EQ(qu.BlockDequeueBatch(std::back_inserter(out), 10), 2);
+  ASSERT_EQ(out, std::vector<uint32_t>({0, 1, 2, 3, 0}));
+  ASSERT_EQ(qu.DequeueBatch(std::back_inserter(out), 10), 0);
+
+  std::thread t([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    qu.EnqueueBatch(std::vector<uint32_t>{7, 8});
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    qu.Stop();
+  });
+
+  out.clear();
+  ASSERT_EQ(qu.BlockDequeueBatch(std::back_inserter(out), 10), 2);
+  ASSERT_EQ(out, std::vector<uint32_t>({7, 8}));
+  ASSERT_EQ(qu.BlockDequeueBatch(std::back_inserter(out), 10), 0);
+
+  t.join();
+}
+
+// 测试BlockQueue批量添加不持有元素的range时不会move走调用方的元素
+TEST(THREAD_TEST, BlockQueue_BATCH_BORROWED) {
+  BlockQueue<std::string> qu;
+
+  std::vector<std::string> in{"aaa", "bbb", "ccc"};
+  ASSERT_EQ(qu.EnqueueBatch(std::span(in)), 3);
+  ASSERT_EQ(qu.EnqueueBatch(in | std::views::take(2)), 2);
+  ASSERT_EQ(in, std::vector<std::string>({"aaa", "bbb", "ccc"}));
+
+  // 右值view也不会move走调用方的数据
+  ASSERT_EQ(qu.EnqueueBatch(in | std::views::filter([](const std::string &s) { return s != "bbb"; })), 2);
+  ASSERT_EQ(in, std::vector<std::string>({"aaa", "bbb", "ccc"}));
+
+  ASSERT_EQ(qu.EnqueueBatch(std::move(in)), 3);
+
+  std::vector<std::string> out;
+  ASSERT_EQ(qu.DequeueBatch(std::back_inserter(out), 20), 10);
+  ASSERT_EQ(out, std::vector<std::string>({"aaa", "bbb", "ccc", "aaa", "bbb", "aaa", "ccc", "aaa", "bbb", "ccc"}));
+
+  // Channel线程池模式下规则相同
+  std::vector<std::string> handled;
+  std::mutex handled_mutex;
+  auto f = [&](std::string &&s) {
+    std::lock_guard<std::mutex> lck(handled_mutex);
+    handled.emplace_back(std::move(s));
+  };
+
+  WorkStealingExecutor executor(1);
+  executor.Start();
+  {
+    Channel<std::string> ch;
+    ch.InitExecutor(f, executor);
+    ch.StartProcess();
+
+    std::vector<std::string> ch_in{"aaa", "bbb", "ccc"};
+    ASSERT_EQ(ch.EnqueueBatch(ch_in | std::views::filter([](const std::string &s) { return s != "bbb"; })), 2);
+    ASSERT_EQ(ch_in, std::vector<std::string>({"aaa", "bbb", "ccc"}));
+  }
+  std::sort(handled.begin(), handled.end());
+  ASSERT_EQ(handled, std::vector<std::string>({"aaa", "ccc"}));
+}
+
 // 测试BlockQueue异步操作
 TEST(THREAD_TEST, BlockQueue_ANYSC) {
   using BckQueue = BlockQueue<TestObj>;
@@ -179,6 +388,336 @@ TEST(THREAD_TEST, BlockQueue_ANYSC) {
   ASSERT_EQ(ct, 1);
 }
 
+// 测试BlockRing基础同步操作
+TEST(THREAD_TEST, BlockRing_BASE) {
+  using BckRing = BlockRing<TestObj, 4>;
+  TestObj::gid = 0;
+  BckRing qu;
+  ASSERT_EQ(qu.GetMaxCount(), 4);
+  ASSERT_EQ(qu.Count(), 0);
+  ASSERT_TRUE(qu.Empty());
+
+  TestObj obj;
+  ASSERT_EQ(qu.TryPop(obj), false);
+
+  for (uint32_t ii = 0; ii < qu.GetMaxCount(); ++ii) {
+    TestObj obj_tmp;
+    obj_tmp.data = std::to_string(ii);
+    ASSERT_EQ(qu.TryPush(std::move(obj_tmp)), true);
+  }
+  ASSERT_EQ(qu.TryPush(obj), false);
+  ASSERT_EQ(qu.Count(), qu.GetMaxCount());
+
+  for (uint32_t ii = 0; ii < qu.GetMaxCount(); ++ii) {
+    ASSERT_EQ(qu.TryPop(obj), true);
+    ASSERT_STREQ(obj.data.c_str(), std::to_string(ii).c_str());
+  }
+  ASSERT_EQ(qu.TryPop(obj), false);
+
+  // 回绕
+  for (uint32_t ii = 0; ii < 10; ++ii) {
+    ASSERT_EQ(qu.TryEmplace(), true);
+    ASSERT_EQ(qu.TryPush(obj), true);
+    ASSERT_EQ(qu.BlockPop(obj), true);
+    ASSERT_EQ(qu.BlockPop(obj), true);
+  }
+  ASSERT_EQ(qu.Count(), 0);
+
+  ASSERT_EQ(qu.BlockPush(obj), true);
+  qu.Stop();
+  ASSERT_EQ(qu.BlockPop(obj), true);
+  ASSERT_EQ(qu.BlockPop(obj), false);
+}
+
+// 测试BlockRing多生产者多消费者
+TEST(THREAD_TEST, BlockRing_MPMC) {
+  BlockRing<uint32_t, 8> qu;
+  const uint32_t th_num = 4;
+  const uint32_t obj_num = 10000;
+
+  std::atomic<uint64_t> sum = 0;
+  std::atomic<uint32_t> ct = 0;
+
+  std::list<std::thread> producers, consumers;
+  for (uint32_t ii = 0; ii < th_num; ++ii) {
+    producers.emplace(producers.end(), [&] {
+      for (uint32_t jj = 1; jj <= obj_num; ++jj)
+        ASSERT_EQ(qu.BlockPush(jj), true);
+    });
+    consumers.emplace(consumers.end(), [&] {
+      uint32_t item;
+      while (qu.BlockPop(item)) {
+        sum += item;
+        ++ct;
+      }
+    });
+  }
+
+  for (auto &t : producers) t.join();
+  while (!qu.Empty()) std::this_thread::yield();
+  qu.Stop();
+  for (auto &t : consumers) t.join();
+
+  ASSERT_EQ(ct, th_num * obj_num);
+  ASSERT_EQ(sum, static_cast<uint64_t>(th_num) * obj_num * (obj_num + 1) / 2);
+}
+
+// 测试ChaseLevDeque
+TEST(THREAD_TEST, ChaseLevDeque_BASE) {
+  ChaseLevDeque<uint32_t> qu(2);
+  ASSERT_EQ(qu.Capacity(), 2);
+  ASSERT_TRUE(qu.Empty());
+
+  uint32_t item;
+  ASSERT_FALSE(qu.Pop(item));
+  ASSERT_FALSE(qu.Steal(item));
+
+  for (uint32_t ii = 0; ii < 10; ++ii) qu.Push(ii);
+  ASSERT_EQ(qu.Size(), 10);
+  ASSERT_GE(qu.Capacity(), 10);
+
+  ASSERT_TRUE(qu.Pop(item));
+  ASSERT_EQ(item, 9);
+  ASSERT_TRUE(qu.Steal(item));
+  ASSERT_EQ(item, 0);
+
+  for (uint32_t ii = 1; ii < 9; ++ii) {
+    ASSERT_TRUE(qu.Steal(item));
+    ASSERT_EQ(item, ii);
+  }
+  ASSERT_FALSE(qu.Pop(item));
+  ASSERT_TRUE(qu.Empty());
+}
+
+// 测试ChaseLevDeque并发窃取
+TEST(THREAD_TEST, ChaseLevDeque_STEAL) {
+  ChaseLevDeque<uint32_t> qu(16);
+  const uint32_t thief_num = 3;
+  const uint32_t obj_num = 100000;
+
+  std::atomic<uint64_t> sum = 0;
+  std::atomic<uint32_t> ct = 0;
+  std::atomic_bool done = false;
+
+  std::list<std::thread> thieves;
+  for (uint32_t ii = 0; ii < thief_num; ++ii) {
+    thieves.emplace(thieves.end(), [&] {
+      uint32_t item;
+      while (!done.load() || !qu.Empty()) {
+        if (qu.Steal(item)) {
+          sum += item;
+          ++ct;
+        }
+      }
+    });
+  }
+
+  uint32_t item;
+  for (uint32_t ii = 1; ii <= obj_num; ++ii) {
+    qu.Push(ii);
+    if (ii % 3 == 0 && qu.Pop(item)) {
+      sum += item;
+      ++ct;
+    }
+  }
+  while (qu.Pop(item)) {
+    sum += item;
+    ++ct;
+  }
+  done = true;
+  for (auto &t : thieves) t.join();
+
+  ASSERT_EQ(ct, obj_num);
+  ASSERT_EQ(sum, static_cast<uint64_t>(obj_num) * (obj_num + 1) / 2);
+}
+
+// 测试MpscQueue
+TEST(THREAD_TEST, MpscQueue_BASE) {
+  struct Item : public MpscQueueHook {
+    uint32_t val = 0;
+  };
+
+  MpscQueue<Item> qu;
+  ASSERT_TRUE(qu.Empty());
+  ASSERT_EQ(qu.Pop(), nullptr);
+
+  std::vector<Item> items(10);
+  for (uint32_t ii = 0; ii < items.size(); ++ii) {
+    items[ii].val = ii;
+    qu.Push(&items[ii]);
+  }
+  ASSERT_FALSE(qu.Empty());
+
+  for (uint32_t ii = 0; ii < items.size(); ++ii) {
+    Item* item = qu.Pop();
+    ASSERT_NE(item, nullptr);
+    ASSERT_EQ(item->val, ii);
+  }
+  ASSERT_EQ(qu.Pop(), nullptr);
+  ASSERT_TRUE(qu.Empty());
+
+  // 取空后可以继续使用
+  qu.Push(&items[3]);
+  ASSERT_EQ(qu.Pop(), &items[3]);
+  ASSERT_EQ(qu.Pop(), nullptr);
+}
+
+// 测试MpscQueue多生产者
+TEST(THREAD_TEST, MpscQueue_MPSC) {
+  struct Item : public MpscQueueHook {
+    uint32_t th = 0;
+    uint32_t val = 0;
+  };
+
+  MpscQueue<Item> qu;
+  const uint32_t th_num = 4;
+  const uint32_t obj_num = 100000;
+
+  std::vector<std::unique_ptr<Item[]>> items;
+  for (uint32_t ii = 0; ii < th_num; ++ii) items.emplace_back(std::make_unique<Item[]>(obj_num));
+  std::list<std::thread> producers;
+  for (uint32_t ii = 0; ii < th_num; ++ii) {
+    producers.emplace(producers.end(), [&, ii] {
+      for (uint32_t jj = 0; jj < obj_num; ++jj) {
+        items[ii][jj].th = ii;
+        items[ii][jj].val = jj;
+        qu.Push(&items[ii][jj]);
+      }
+    });
+  }
+
+  // 每个生产者的元素保持顺序
+  std::vector<uint32_t> next_vals(th_num, 0);
+  uint32_t ct = 0;
+  while (ct < th_num * obj_num) {
+    Item* item = qu.Pop();
+    if (item == nullptr) continue;
+    ASSERT_EQ(item->val, next_vals[item->th]);
+    ++next_vals[item->th];
+    ++ct;
+  }
+  for (auto &t : producers) t.join();
+
+  ASSERT_EQ(qu.Pop(), nullptr);
+}
+
+TEST(THREAD_TEST, ObjectPool_BASE) {
+  struct Obj {
+    explicit Obj(uint32_t v) : val(v) {}
+    uint32_t val;
+    std::string str = "obj";
+  };
+  using Pool = ObjectPool<Obj, 4, 2>;
+
+  Obj* obj = Pool::New(42);
+  ASSERT_EQ(obj->val, 42);
+  ASSERT_EQ(obj->str, "obj");
+  Pool::Delete(obj);
+
+  // 释放的内存被复用
+  Obj* obj2 = Pool::New(1);
+  ASSERT_EQ(obj2, obj);
+  Pool::Delete(obj2);
+  Pool::Delete(nullptr);
+
+  std::vector<Obj*> objs;
+  for (uint32_t ii = 0; ii < 100; ++ii) objs.emplace_back(Pool::New(ii));
+  for (uint32_t ii = 0; ii < 100; ++ii) ASSERT_EQ(objs[ii]->val, ii);
+  for (auto* item : objs) Pool::Delete(item);
+}
+
+TEST(THREAD_TEST, ObjectPool_CROSS_THREAD) {
+  struct Obj : public MpscQueueHook {
+    uint32_t val = 0;
+  };
+  using Pool = ObjectPool<Obj, 16>;
+
+  // 生产者创建，消费者销毁
+  MpscQueue<Obj> qu;
+  const uint32_t th_num = 4;
+  const uint32_t obj_num = 100000;
+
+  std::list<std::thread> producers;
+  for (uint32_t ii = 0; ii < th_num; ++ii) {
+    producers.emplace(producers.end(), [&] {
+      for (uint32_t jj = 0; jj < obj_num; ++jj) {
+        Obj* obj = Pool::New();
+        obj->val = jj;
+        qu.Push(obj);
+      }
+    });
+  }
+
+  uint32_t ct = 0;
+  while (ct < th_num * obj_num) {
+    Obj* obj = qu.Pop();
+    if (obj == nullptr) continue;
+    Pool::Delete(obj);
+    ++ct;
+  }
+  for (auto &t : producers) t.join();
+}
+
+TEST(THREAD_TEST, ObjectPool_THREAD_EXIT) {
+  struct Obj {
+    uint32_t val = 0;
+  };
+  using Pool = ObjectPool<Obj, 4>;
+
+  // holder先于线程缓存构造，因此在线程缓存析构之后才析构
+  struct Holder {
+    ~Holder() {
+      Pool::Delete(obj);
+      Pool::Delete(Pool::New());
+    }
+    Obj* obj = nullptr;
+  };
+
+  for (uint32_t ii = 0; ii < 4; ++ii) {
+    std::thread t([] {
+      static thread_local Holder holder;
+      holder.obj = Pool::New();
+      holder.obj->val = 1;
+    });
+    t.join();
+  }
+
+  Obj* obj = Pool::New();
+  ASSERT_NE(obj, nullptr);
+  Pool::Delete(obj);
+}
+
+// 测试WorkStealingExecutor
+TEST(THREAD_TEST, WorkStealingExecutor_BASE) {
+  std::atomic<uint32_t> ct = 0;
+  const uint32_t task_num = 1000;
+
+  {
+    WorkStealingExecutor executor(4);
+    ASSERT_EQ(executor.ThreadsNum(), 4);
+
+    // Start前投递
+    executor.Post([&] { ++ct; });
+    executor.Start();
+
+    for (uint32_t ii = 1; ii < task_num; ++ii) {
+      if (ii % 2) {
+        executor.Post([&] { ++ct; });
+      } else {
+        // 在工作线程中投递到本地队列
+        executor.Post([&] {
+          executor.Post([&] { ++ct; });
+        });
+      }
+    }
+
+    executor.Stop();
+    executor.Join();
+  }
+
+  ASSERT_EQ(ct, task_num);
+}
+
 // 测试LightSignal
 TEST(THREAD_TEST, LightSignal_BASE) {
   LightSignal s;
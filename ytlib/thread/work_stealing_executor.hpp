@@ -0,0 +1,274 @@
+/**
+ * @file work_stealing_executor.hpp
+ * @brief 工作窃取线程池
+ * @note 每个工作线程一个Chase-Lev队列，外部线程通过全局注入队列投递任务，空闲线程基于atomic wait休眠
+ * @author WT
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "ytlib/function/function.hpp"
+#include "ytlib/misc/misc_macro.h"
+#include "ytlib/thread/chase_lev_deque.hpp"
+
+namespace ytlib {
+
+/**
+ * @brief 工作窃取线程池
+ * @note 在工作线程中投递的任务进入该线程自己的本地队列，其他线程投递的任务进入全局注入队列。
+ * 工作线程依次从本地队列、全局注入队列、其他线程的本地队列获取任务，都获取不到时休眠，
+ * 只有存在休眠线程时投递任务才会进行唤醒。
+ * Stop后会等待所有已投递的任务执行完成后线程才退出。Stop后只有工作线程中投递的任务会被接受，其他线程投递会失败。
+ */
+class WorkStealingExecutor {
+ public:
+  using TaskType = Function<void()>;
+
+  explicit WorkStealingExecutor(uint32_t threads_num = std::max<uint32_t>(std::thread::hardware_concurrency(), 1))
+      : threads_num_(std::max<uint32_t>(threads_num, 1)) {
+    for (uint32_t ii = 0; ii < threads_num_; ++ii)
+      workers_.emplace_back(std::make_unique<Worker>());
+  }
+
+  ~WorkStealingExecutor() {
+    try {
+      Stop();
+      Join();
+    } catch (const std::exception& e) {
+      DBG_PRINT("WorkStealingExecutor destruct get exception, %s", e.what());
+    }
+
+    TaskNode* node;
+    while (PopInjection(node)) delete node;
+    for (auto& worker : workers_) {
+      while (worker->deque.Pop(node)) delete node;
+    }
+  }
+
+  WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+  WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+  /// 获取线程数
+  uint32_t ThreadsNum() const { return threads_num_; }
+
+  /**
+   * @brief 开始运行
+   * @note 异步，启动指定数量的线程
+   */
+  void Start() {
+    if (std::atomic_exchange(&start_flag_, true)) return;
+
+    for (uint32_t ii = 0; ii < threads_num_; ++ii) {
+      threads_.emplace(threads_.end(), [this, ii] { WorkerLoop(ii); });
+    }
+  }
+
+  /**
+   * @brief 停止
+   * @note 异步，线程会在执行完所有任务后退出
+   */
+  void Stop() {
+    {
+      // 与Post互斥，保证Stop之前投递成功的任务都能被工作线程看到
+      std::lock_guard<std::mutex> lck(injection_mutex_);
+      running_flag_.store(false);
+    }
+    wake_event_.fetch_add(1);
+    wake_event_.notify_all();
+  }
+
+  /**
+   * @brief join
+   * @note 阻塞直到所有线程退出
+   */
+  void Join() {
+    for (auto itr = threads_.begin(); itr != threads_.end();) {
+      if (itr->joinable())
+        itr->join();
+      threads_.erase(itr++);
+    }
+  }
+
+  /**
+   * @brief 投递任务
+   * @note 线程安全。在本线程池的工作线程中调用时投递到本地队列，否则投递到全局注入队列
+   * @param task 任务
+   * @return true 投递成功
+   * @return false 已经Stop且不在工作线程中调用，任务被丢弃
+   */
+  bool Post(TaskType&& task) {
+    const Context& ctx = CurContext();
+    if (ctx.executor_ptr == this) {
+      // 工作线程执行完本地队列中的所有任务才会退出，Stop后也可以接受
+      workers_[ctx.index]->deque.Push(new TaskNode{std::move(task)});
+    } else {
+      std::lock_guard<std::mutex> lck(injection_mutex_);
+      if (!running_flag_.load()) return false;
+      injection_queue_.emplace_back(new TaskNode{std::move(task)});
+      injection_size_.store(injection_queue_.size(), std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+      wake_event_.fetch_add(1);
+      wake_event_.notify_one();
+    }
+    return true;
+  }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+  static constexpr size_t kInjectionBatchSize = 32;  ///< 每次从全局注入队列最多取出的任务数
+
+  struct TaskNode {
+    TaskType task;
+  };
+
+  struct alignas(kCacheLineSize) Worker {
+    ChaseLevDeque<TaskNode*> deque;
+  };
+
+  struct Context {
+    WorkStealingExecutor* executor_ptr = nullptr;
+    uint32_t index = 0;
+  };
+
+  static Context& CurContext() {
+    thread_local Context ctx;
+    return ctx;
+  }
+
+  static void RunTask(TaskNode* node) {
+    try {
+      node->task();
+    } catch (const std::exception& e) {
+      DBG_PRINT("WorkStealingExecutor task get exception, %s", e.what());
+    }
+    delete node;
+  }
+
+  bool PopInjection(TaskNode*& node) {
+    if (injection_size_.load(std::memory_order_relaxed) == 0) return false;
+
+    std::lock_guard<std::mutex> lck(injection_mutex_);
+    if (injection_queue_.empty()) return false;
+    node = injection_queue_.front();
+    injection_queue_.pop_front();
+    injection_size_.store(injection_queue_.size(), std::memory_order_relaxed);
+    return true;
+  }
+
+  /// 从全局注入队列取出一批任务，第一个返回，其余放入本地队列
+  bool PopInjectionBatch(Worker& self, TaskNode*& node) {
+    if (injection_size_.load(std::memory_order_relaxed) == 0) return false;
+
+    std::lock_guard<std::mutex> lck(injection_mutex_);
+    if (injection_queue_.empty()) return false;
+
+    // 平分给各个线程，避免单个线程一次拿走全部任务
+    const size_t size = injection_queue_.size();
+    const size_t n = std::min({kInjectionBatchSize, size / threads_num_ + 1, size});
+    node = injection_queue_.front();
+    injection_queue_.pop_front();
+    for (size_t ii = 1; ii < n; ++ii) {
+      self.deque.Push(injection_queue_.front());
+      injection_queue_.pop_front();
+    }
+    injection_size_.store(injection_queue_.size(), std::memory_order_relaxed);
+    return true;
+  }
+
+  TaskNode* FindTask(uint32_t index, uint64_t& rand_seed) {
+    Worker& self = *workers_[index];
+    TaskNode* node = nullptr;
+
+    if (self.deque.Pop(node)) return node;
+
+    if (PopInjectionBatch(self, node)) return node;
+
+    // 从随机位置开始依次尝试窃取
+    rand_seed ^= rand_seed << 13;
+    rand_seed ^= rand_seed >> 7;
+    rand_seed ^= rand_seed << 17;
+    const uint32_t start = static_cast<uint32_t>(rand_seed % threads_num_);
+    for (uint32_t ii = 0; ii < threads_num_; ++ii) {
+      const uint32_t victim = (start + ii) % threads_num_;
+      if (victim == index) continue;
+      if (workers_[victim]->deque.Steal(node)) return node;
+    }
+
+    return nullptr;
+  }
+
+  void WorkerLoop(uint32_t index) {
+    DBG_PRINT("WorkStealingExecutor thread %u start.", index);
+
+    CurContext() = Context{this, index};
+    uint64_t rand_seed = index + 1;
+
+    while (true) {
+      TaskNode* node = FindTask(index, rand_seed);
+      if (node != nullptr) {
+        RunTask(node);
+        continue;
+      }
+
+      // 准备休眠，先登记再检查一次，避免丢失唤醒
+      sleepers_.fetch_add(1);
+      const uint32_t cur_event = wake_event_.load();
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      node = FindTask(index, rand_seed);
+      if (node != nullptr) {
+        sleepers_.fetch_sub(1);
+        RunTask(node);
+        continue;
+      }
+
+      if (!running_flag_.load()) {
+        // Stop之前投递成功的任务此时一定可见，再检查一次后退出
+        node = FindTask(index, rand_seed);
+        sleepers_.fetch_sub(1);
+        if (node != nullptr) {
+          RunTask(node);
+          continue;
+        }
+        break;
+      }
+
+      wake_event_.wait(cur_event);
+      sleepers_.fetch_sub(1);
+    }
+
+    CurContext() = Context{};
+
+    DBG_PRINT("WorkStealingExecutor thread %u exit.", index);
+  }
+
+  const uint32_t threads_num_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  alignas(kCacheLineSize) std::mutex injection_mutex_;
+  std::deque<TaskNode*> injection_queue_;
+  std::atomic<size_t> injection_size_ = 0;
+
+  alignas(kCacheLineSize) std::atomic<uint32_t> sleepers_ = 0;
+  std::atomic<uint32_t> wake_event_ = 0;
+
+  std::atomic_bool running_flag_ = true;
+  std::atomic_bool start_flag_ = false;
+  std::list<std::thread> threads_;
+};
+
+}  // namespace ytlib
@@ -6,30 +6,41 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <cassert>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <functional>
-#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
 #include <thread>
+#include <utility>
 
-namespace ytlib {
+#include "ytlib/function/function.hpp"
+#include "ytlib/thread/mpsc_queue.hpp"
+#include "ytlib/thread/object_pool.hpp"
+#include "ytlib/thread/thread_id.hpp"
 
-// 先全部加锁，实现完成后再看哪些地方可以用atomic或无锁方式优化的
+namespace ytlib {
 
 /**
  * @brief 定时器
- * @note 采用时间轮实现
- * TODO：解决空推进问题
- * TODO：采用无锁方式提高效率
- *
+ * @note 采用多层时间轮实现。时间轮只由定时器线程访问，
+ * 其他线程通过ExecuteAt提交的任务先放入按线程分片的无锁MPSC提交队列中，由定时器线程取出并放入时间轮。
+ * 每层时间轮用位图记录非空槽位，定时器线程据此找到最早需要处理的tick，直接跳过中间的空tick并sleep到该tick，
+ * 期间提交了更早的任务、调速或关闭时会被唤醒。
+ * 同一个tick到期的任务组成一个TaskBatch，注册了BatchExecutor时整批交给它，一次post即可转移到其他线程执行，
+ * 避免大量任务同时到期时阻塞定时器线程。
  */
 class Timer {
+ private:
+  struct TaskNode;
+
  public:
   struct Options {
     /// 时间轮的最小分辨率
@@ -41,13 +52,26 @@ class Timer {
     /// 时间轮层级与尺寸
     std::vector<size_t> wheel_size_array = {1000, 60, 60};
 
+    /// 提交队列数，提交任务的线程按线程id分散到各个队列中
+    size_t submit_queue_num = 16;
+
     /// 校验配置
     static Options Verify(const Options& verify_options) {
       Options options(verify_options);
 
+      if (options.dt <= std::chrono::steady_clock::duration::zero())
+        throw std::runtime_error("options.dt must be positive!");
+
       if (options.wheel_size_array.empty())
         throw std::runtime_error("options.wheel_size_array is empty!");
 
+      for (auto wheel_size : options.wheel_size_array) {
+        if (wheel_size == 0)
+          throw std::runtime_error("options.wheel_size_array has zero size wheel!");
+      }
+
+      if (options.submit_queue_num == 0) options.submit_queue_num = 1;
+
       return options;
     }
   };
@@ -59,64 +83,238 @@ class Timer {
     Shutdown,
   };
 
-  using Task = std::function<void()>;
+  /// 任务，不超过48字节的闭包直接存放在任务节点中，不会分配内存
+  using Task = Function<void(), 48>;
   using Executor = std::function<void(Task&&)>;
 
+  /**
+   * @brief 任务句柄
+   * @note 可以在任意线程中取消对应的任务，句柄可以在定时器析构后继续持有
+   */
+  class TaskHandle {
+   public:
+    TaskHandle() = default;
+    ~TaskHandle() { Reset(); }
+
+    TaskHandle(const TaskHandle& other) : node_(other.node_) {
+      if (node_) node_->AddRef();
+    }
+
+    TaskHandle(TaskHandle&& other) noexcept : node_(std::exchange(other.node_, nullptr)) {}
+
+    TaskHandle& operator=(TaskHandle other) noexcept {
+      std::swap(node_, other.node_);
+      return *this;
+    }
+
+    /// 是否关联了任务
+    bool Valid() const { return node_ != nullptr; }
+
+    /**
+     * @brief 取消任务
+     * @note O(1)，任务的闭包会被立即释放。周期任务正在执行时，闭包在本次执行结束后释放
+     * @return true 取消成功
+     * @return false 任务已经执行或已经被取消
+     */
+    bool Cancel() { return node_ && node_->Cancel(); }
+
+    /// 解除与任务的关联，不会取消任务
+    void Reset() {
+      if (node_) std::exchange(node_, nullptr)->Release();
+    }
+
+   private:
+    friend class Timer;
+
+    explicit TaskHandle(TaskNode* node) : node_(node) { node_->AddRef(); }
+
+    TaskNode* node_ = nullptr;
+  };
+
+  /**
+   * @brief 同一个tick到期的一批任务
+   * @note 只能移动，可以在任意线程中执行。持有任务节点的引用，可以在定时器析构后执行。
+   * 未执行就析构时丢弃其中的任务，周期任务只跳过本次执行
+   */
+  class TaskBatch {
+   public:
+    TaskBatch() = default;
+    ~TaskBatch() { Clear(); }
+
+    TaskBatch(const TaskBatch&) = delete;
+    TaskBatch& operator=(const TaskBatch&) = delete;
+
+    TaskBatch(TaskBatch&& other) noexcept
+        : head_(std::exchange(other.head_, nullptr)),
+          tail_(std::exchange(other.tail_, nullptr)),
+          size_(std::exchange(other.size_, 0)) {}
+
+    TaskBatch& operator=(TaskBatch&& other) noexcept {
+      if (this != &other) {
+        Clear();
+        head_ = std::exchange(other.head_, nullptr);
+        tail_ = std::exchange(other.tail_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+      }
+      return *this;
+    }
+
+    bool Empty() const { return head_ == nullptr; }
+
+    size_t Size() const { return size_; }
+
+    /// 按提交顺序依次执行所有任务
+    void Run() {
+      ConsumeAll([](TaskNode* node) { node->Run(); });
+    }
+
+    /**
+     * @brief 拆分为单个任务，依次交给f
+     * @param[in] f 接收Task&&的可调用对象
+     */
+    template <typename F>
+    void Split(F&& f) {
+      ConsumeAll([&f](TaskNode* node) {
+        if (node->period_ticks == 0) {
+          f(std::move(node->task));
+          node->Release();
+        } else {
+          f(Task(PeriodicTaskRunner(node)));
+        }
+      });
+    }
+
+    /// 丢弃所有任务
+    void Clear() {
+      ConsumeAll([](TaskNode* node) { node->Abandon(); });
+    }
+
+   private:
+    friend class Timer;
+
+    /// Split出的周期任务，持有节点的引用，未执行就析构时与Clear一样只跳过本次执行
+    class PeriodicTaskRunner {
+     public:
+      explicit PeriodicTaskRunner(TaskNode* node) : node_(node) {}
+      ~PeriodicTaskRunner() {
+        if (node_) node_->Abandon();
+      }
+
+      PeriodicTaskRunner(const PeriodicTaskRunner&) = delete;
+      PeriodicTaskRunner& operator=(const PeriodicTaskRunner&) = delete;
+
+      PeriodicTaskRunner(PeriodicTaskRunner&& other) noexcept : node_(std::exchange(other.node_, nullptr)) {}
+      PeriodicTaskRunner& operator=(PeriodicTaskRunner&&) = delete;
+
+      void operator()() { std::exchange(node_, nullptr)->Run(); }
+
+     private:
+      TaskNode* node_;
+    };
+
+    void PushBack(TaskNode* node) {
+      node->batch_next = nullptr;
+      if (tail_) {
+        tail_->batch_next = node;
+      } else {
+        head_ = node;
+      }
+      tail_ = node;
+      ++size_;
+    }
+
+    template <typename F>
+    void ConsumeAll(F&& f) {
+      TaskNode* node = std::exchange(head_, nullptr);
+      tail_ = nullptr;
+      size_ = 0;
+      while (node) {
+        TaskNode* next = node->batch_next;
+        f(node);
+        node = next;
+      }
+    }
+
+    TaskNode* head_ = nullptr;
+    TaskNode* tail_ = nullptr;
+    size_t size_ = 0;
+  };
+
+  using BatchExecutor = std::function<void(TaskBatch&&)>;
+
  public:
   Timer() : task_executor_([](Task&& task) { task(); }) {}
 
-  ~Timer() { Shutdown(); }
+  ~Timer() {
+    Shutdown();
+
+    // 释放尚未执行的任务
+    for (auto& submit_queue : submit_queues_) {
+      while (TaskNode* node = submit_queue->Pop()) node->Drop();
+    }
+    for (auto& timing_wheel : timing_wheel_vec_) {
+      for (auto& task_list : timing_wheel.slots) DropTaskList(task_list);
+    }
+    for (auto& itr : timing_task_map_) DropTaskList(itr.second);
+  }
 
   Timer(const Timer&) = delete;
   Timer& operator=(const Timer&) = delete;
 
+  /**
+   * @brief 注册单个任务的执行器
+   * @note 用于执行提交时已经到期的任务，以及未注册BatchExecutor时逐个执行到期的任务。默认在当前线程直接执行。
+   * 需要在Start之前调用
+   */
   template <typename... Args>
     requires std::constructible_from<Executor, Args...>
   void RegisterExecutor(Args&&... args) {
     task_executor_ = Executor(std::forward<Args>(args)...);
   }
 
+  /**
+   * @brief 注册批量执行器
+   * @note 注册后定时器线程将每个tick到期的所有任务整批交给它，需要在Start之前调用
+   */
+  template <typename... Args>
+    requires std::constructible_from<BatchExecutor, Args...>
+  void RegisterBatchExecutor(Args&&... args) {
+    batch_executor_ = BatchExecutor(std::forward<Args>(args)...);
+  }
+
   void Initialize(const Options& options) {
     if (std::atomic_exchange(&state_, State::Init) != State::PreInit)
       throw std::runtime_error("Timer can only be initialized once.");
 
-    options_ = options;
+    options_ = Options::Verify(options);
 
     SetTimeRatio(options_.init_ratio);
 
-    uint64_t cur_scale = 1;
+    for (size_t ii = 0; ii < options_.submit_queue_num; ++ii)
+      submit_queues_.emplace_back(std::make_unique<MpscQueue<TaskNode>>());
+
+    uint64_t granularity = 1;
     for (size_t ii = 0; ii < options_.wheel_size_array.size(); ++ii) {
-      timing_wheel_vec_.emplace_back(TimingWheelTool{
-          .current_pos = 0,
-          .scale = (cur_scale *= options_.wheel_size_array[ii]),
-          .wheel = std::vector<TaskList>(options_.wheel_size_array[ii]),
-          .borrow_func = [ii, this]() {
-            TaskList task_list;
-            if (ii < options_.wheel_size_array.size() - 1) {
-              ++(timing_wheel_vec_[ii + 1].current_pos);
-              task_list = timing_wheel_vec_[ii + 1].Tick();
-            } else {
-              ++timing_task_map_pos_;
-              auto itr = timing_task_map_.find(timing_task_map_pos_);
-              if (itr != timing_task_map_.end()) {
-                task_list = std::move(itr->second);
-                timing_task_map_.erase(itr);
-              }
-            }
-
-            while (!task_list.empty()) {
-              auto itr = task_list.begin();
-              auto& cur_list = timing_wheel_vec_[ii].wheel[itr->tick_count % timing_wheel_vec_[ii].scale];
-              cur_list.splice(cur_list.begin(), task_list, itr);
-            }
-          }});
+      const size_t wheel_size = options_.wheel_size_array[ii];
+      timing_wheel_vec_.emplace_back(TimingWheel{
+          .granularity = granularity,
+          .slots = std::vector<TaskList>(wheel_size),
+          .slot_bits = std::vector<uint64_t>((wheel_size + 63) / 64, 0)});
+      granularity *= wheel_size;
     }
+    total_scale_ = granularity;
   }
 
   void Start() {
     if (std::atomic_exchange(&state_, State::Start) != State::Init)
       throw std::runtime_error("Timer can only start when state is 'Init'.");
 
+    // 记录初始时间，线程启动前写入，保证其他线程在Start之后读取到的是正确值
+    start_time_point_ = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+
     timer_thread_ = std::make_unique<std::thread>(std::bind(&Timer::TimerLoop, this));
   }
 
@@ -124,7 +322,9 @@ class Timer {
     if (std::atomic_exchange(&state_, State::Shutdown) == State::Shutdown)
       return;
 
-    if (timer_thread_->joinable()) timer_thread_->join();
+    Wakeup();
+
+    if (timer_thread_ && timer_thread_->joinable()) timer_thread_->join();
   }
 
   std::chrono::steady_clock::time_point StartTimePoint() const {
@@ -133,85 +333,85 @@ class Timer {
     return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(start_time_point_));
   }
 
+  /**
+   * @brief 获取定时器的当前虚拟时间
+   * @note 定时器线程sleep期间按时间速率推算，但不会超过下一个待执行任务的时间
+   * @return std::chrono::steady_clock::time_point 当前虚拟时间，精度为dt
+   */
   std::chrono::steady_clock::time_point Now() const {
     assert(state_.load() == State::Start);
 
-    std::shared_lock<std::shared_mutex> lck(tick_mutex_);
-
     return std::chrono::steady_clock::time_point(
-        std::chrono::nanoseconds(current_tick_count_ * options_.dt.count() + start_time_point_));
+        std::chrono::nanoseconds(NowTick() * options_.dt.count() + start_time_point_));
   }
 
-  void ExecuteAt(std::chrono::steady_clock::time_point tp, Task&& task) {
+  /**
+   * @brief 在指定时间点执行任务
+   * @note 无锁，可以由任意线程调用。时间点已经过去时直接在当前线程通过executor执行，此时返回空句柄
+   * @param[in] tp 时间点
+   * @param[in] task 任务
+   * @return TaskHandle 任务句柄
+   */
+  TaskHandle ExecuteAt(std::chrono::steady_clock::time_point tp, Task&& task) {
     assert(state_.load() == State::Start);
 
-    uint64_t virtual_tp =
-        static_cast<uint64_t>(
-            std::chrono::duration_cast<std::chrono::nanoseconds>(
-                tp.time_since_epoch())
-                .count()) -
-        start_time_point_;
+    const int64_t virtual_tp =
+        static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count()) -
+        static_cast<int64_t>(start_time_point_);
 
-    std::unique_lock<std::shared_mutex> lck(tick_mutex_);
-
-    if (virtual_tp < current_tick_count_ * options_.dt.count()) {
-      lck.unlock();
+    if (virtual_tp < static_cast<int64_t>(NowTick() * options_.dt.count())) {
       task_executor_(std::move(task));
-      return;
+      return TaskHandle();
     }
 
-    // 当前时间点 time_point_
-    uint64_t temp_current_tick_count = current_tick_count_;
-    uint64_t diff_tick_count = virtual_tp / options_.dt.count() - current_tick_count_;
-
-    const size_t len = options_.wheel_size_array.size();
-    for (size_t ii = 0; ii < len; ++ii) {
-      if (diff_tick_count < options_.wheel_size_array[ii]) {
-        auto pos = (diff_tick_count + temp_current_tick_count) % options_.wheel_size_array[ii];
+    return Submit(static_cast<uint64_t>(virtual_tp) / options_.dt.count(), 0, std::move(task));
+  }
 
-        // TODO：基于时间将任务排序后插进去
-        timing_wheel_vec_[ii].wheel[pos].emplace_back(
-            TaskWithTimestamp{virtual_tp / options_.dt.count(), std::move(task)});
-        return;
-      } else {
-        diff_tick_count /= options_.wheel_size_array[ii];
-        temp_current_tick_count /= options_.wheel_size_array[ii];
-      }
-    }
+  TaskHandle ExecuteAfter(std::chrono::steady_clock::duration dt, Task&& task) {
+    assert(state_.load() == State::Start);
 
-    timing_task_map_[diff_tick_count + temp_current_tick_count].emplace_back(
-        TaskWithTimestamp{virtual_tp / options_.dt.count(), std::move(task)});
+    return ExecuteAt(Now() + dt, std::move(task));
   }
 
-  void ExecuteAfter(std::chrono::steady_clock::duration dt, Task&& task) {
+  /**
+   * @brief 周期性执行任务
+   * @note 首次在period之后执行。每次执行后在原节点上重新计时，不会重新分配内存。
+   * 上一次执行尚未结束时跳过本次执行。周期小于dt时按dt处理
+   * @param[in] period 周期
+   * @param[in] task 任务
+   * @return TaskHandle 任务句柄，取消后不再执行
+   */
+  TaskHandle ExecuteEvery(std::chrono::steady_clock::duration period, Task&& task) {
     assert(state_.load() == State::Start);
 
-    ExecuteAt(Now() + dt, std::move(task));
+    const uint64_t period_ticks = std::max<uint64_t>(period / options_.dt, 1);
+    return Submit(NowTick() + period_ticks, period_ticks, std::move(task));
   }
 
   void SetTimeRatio(double ratio) {
     assert(state_.load() == State::Init || state_.load() == State::Start);
 
-    std::unique_lock<std::shared_mutex> lck(ratio_mutex_);
-
-    // 大于1，快进
-    if (ratio >= 1.0) {
-      ratio_direction_ = true;
-      real_ratio_ = static_cast<uint32_t>(ratio);
-      return;
-    }
-
-    ratio_direction_ = false;
-
-    // 大于0小于1，慢放
-    if (ratio > 1e-15 && ratio < 1.0 &&
-        (1.0 / ratio) < std::numeric_limits<uint32_t>::max()) {
-      real_ratio_ = static_cast<uint32_t>(1.0 / ratio);
-      return;
+    {
+      std::unique_lock<std::shared_mutex> lck(ratio_mutex_);
+
+      if (ratio >= 1.0) {
+        // 大于1，快进
+        ratio_direction_ = true;
+        real_ratio_ = static_cast<uint32_t>(ratio);
+      } else if (ratio > 1e-15 && ratio < 1.0 &&
+                 (1.0 / ratio) < std::numeric_limits<uint32_t>::max()) {
+        // 大于0小于1，慢放
+        ratio_direction_ = false;
+        real_ratio_ = static_cast<uint32_t>(1.0 / ratio);
+      } else {
+        // 小于0等于0，暂停
+        ratio_direction_ = false;
+        real_ratio_ = std::numeric_limits<uint32_t>::max();
+      }
     }
 
-    // 小于0等于0，暂停
-    real_ratio_ = std::numeric_limits<uint32_t>::max();
+    ratio_changed_.store(true);
+    Wakeup();
   }
 
   double GetTimeRatio() const {
@@ -229,124 +429,494 @@ class Timer {
   }
 
  private:
+  /// 时间基准，tick_count = anchor_tick + floor((now - anchor_time) / step) * ticks_per_step
+  struct ClockAnchor {
+    uint64_t anchor_tick = 0;
+    int64_t anchor_ns = 0;
+    int64_t step_ns = 1;
+    uint64_t ticks_per_step = 0;  // 为0时表示暂停
+
+    uint64_t TickAt(int64_t now_ns) const {
+      if (ticks_per_step == 0 || now_ns <= anchor_ns) return anchor_tick;
+      return anchor_tick + static_cast<uint64_t>((now_ns - anchor_ns) / step_ns) * ticks_per_step;
+    }
+  };
+
+  static int64_t SteadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  /// 按当前时间速率生成从anchor_tick开始的时间基准
+  ClockAnchor MakeClockAnchor(uint64_t anchor_tick, int64_t anchor_ns) const {
+    ClockAnchor anchor{.anchor_tick = anchor_tick, .anchor_ns = anchor_ns};
+
+    std::shared_lock<std::shared_mutex> lck(ratio_mutex_);
+
+    if (real_ratio_ == std::numeric_limits<uint32_t>::max()) return anchor;
+
+    anchor.step_ns = ratio_direction_ ? options_.dt.count() : (options_.dt.count() * real_ratio_);
+    anchor.ticks_per_step = ratio_direction_ ? real_ratio_ : 1;
+    return anchor;
+  }
+
   void TimerLoop() {
-    auto last_loop_time_point = std::chrono::steady_clock::now();
+    // 最长sleep时间
+    static constexpr int64_t kMaxSleepNs = std::chrono::nanoseconds(std::chrono::seconds(1)).count();
 
-    // 记录初始时间
-    start_time_point_ = static_cast<uint64_t>(
-        std::chrono::duration_cast<std::chrono::nanoseconds>(
-            last_loop_time_point.time_since_epoch())
-            .count());
+    ratio_changed_.store(false);
+    ClockAnchor anchor = MakeClockAnchor(0, static_cast<int64_t>(start_time_point_));
+
+    uint64_t cursor = 0;   // 下一个要处理的tick
+    uint64_t horizon = 0;  // Now()可以推算到的最大tick
 
     while (state_.load() != State::Shutdown) {
-      // 获取时间比例。注意：调速只能在下一个tick生效
-      ratio_mutex_.lock_shared();
+      // 调速从当前tick开始生效
+      if (ratio_changed_.exchange(false))
+        anchor = MakeClockAnchor(PublishedBaseTick(), SteadyNowNs());
 
-      bool ratio_direction = ratio_direction_;
-      uint32_t real_ratio = real_ratio_;
+      const int64_t now_ns = SteadyNowNs();
+      const uint64_t target = std::max(anchor.TickAt(now_ns), cursor);
 
-      ratio_mutex_.unlock_shared();
+      // sleep期间Now()最多推算到horizon，已经返回过的时间不能回退
+      const uint64_t floor_tick = std::max(cursor, std::min(target, horizon));
+      PublishClock(anchor, floor_tick, floor_tick);
 
-      // sleep一个tick
-      if (real_ratio == std::numeric_limits<uint32_t>::max()) {
-        // 暂停了
-        std::this_thread::sleep_until(last_loop_time_point += std::chrono::seconds(1));
-        continue;
+      // 走时间轮
+      while (cursor < target) {
+        // 将新提交的任务放入时间轮
+        DrainSubmitQueues(cursor);
+
+        // 跳过空tick
+        const uint64_t due = EarliestDueTick(cursor);
+        if (due >= target) {
+          cursor = target;
+          break;
+        }
+        cursor = due;
+        if (cursor > floor_tick) PublishClock(anchor, cursor, cursor);
+
+        ProcessTick(cursor);
+        ++cursor;
+
+        if (ratio_changed_.load()) break;
       }
 
-      auto real_dt = ratio_direction ? options_.dt : (options_.dt * real_ratio);
-      do {
-        // 最长sleep时间
-        static constexpr auto max_sleep_dt = std::chrono::seconds(1);
+      const uint64_t base_tick = std::max(cursor, floor_tick);
 
-        auto sleep_time = (real_dt > max_sleep_dt) ? max_sleep_dt : real_dt;
-        real_dt -= sleep_time;
+      if (ratio_changed_.load() || state_.load() == State::Shutdown) {
+        PublishClock(anchor, base_tick, base_tick);
+        continue;
+      }
 
-        // 一个小优化，防止real_dt太小
-        if (options_.dt < max_sleep_dt && real_dt <= options_.dt) {
-          sleep_time += real_dt;
-          real_dt -= real_dt;
+      // 计算下次需要处理的tick，sleep到该tick
+      DrainSubmitQueues(cursor);
+      const uint64_t due = EarliestDueTick(cursor);
+      horizon = std::max(due, base_tick);
+      PublishClock(anchor, base_tick, horizon);
+
+      int64_t sleep_ns = kMaxSleepNs;
+      if (anchor.ticks_per_step != 0 && due != kNoTick) {
+        // due所在step的起始时间，超过最长sleep时间的不需要计算，避免溢出
+        const uint64_t steps = (due + 1 > anchor.anchor_tick)
+                                   ? (due + 1 - anchor.anchor_tick + anchor.ticks_per_step - 1) / anchor.ticks_per_step
+                                   : 0;
+        const int64_t cur_ns = SteadyNowNs();
+        const uint64_t cur_steps = (cur_ns > anchor.anchor_ns) ? (cur_ns - anchor.anchor_ns) / anchor.step_ns : 0;
+        if (steps <= cur_steps + static_cast<uint64_t>(kMaxSleepNs / anchor.step_ns))
+          sleep_ns = std::min(anchor.anchor_ns + static_cast<int64_t>(steps) * anchor.step_ns - cur_ns, kMaxSleepNs);
+      }
+
+      // 先公布计划sleep到的tick再检查提交队列，与ExecuteAt中先提交再读取sleep_until_tick_对应，避免漏掉唤醒
+      sleep_until_tick_.store(due);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      bool has_new_task = false;
+      for (auto& submit_queue : submit_queues_) {
+        if (!submit_queue->Empty()) {
+          has_new_task = true;
+          break;
         }
+      }
 
-        std::this_thread::sleep_until(last_loop_time_point += sleep_time);
+      if (!has_new_task && sleep_ns > 0) {
+        std::unique_lock<std::mutex> lck(sleep_mutex_);
+        sleep_cv_.wait_for(lck, std::chrono::nanoseconds(sleep_ns), [this] { return wakeup_flag_; });
+        wakeup_flag_ = false;
+      }
 
-      } while (state_.load() != State::Shutdown && real_dt.count());
+      sleep_until_tick_.store(0);
+    }
+  }
 
-      // 走时间轮
+  /// 创建任务节点并放入提交队列
+  TaskHandle Submit(uint64_t tick_count, uint64_t period_ticks, Task&& task) {
+    auto* node = ObjectPool<TaskNode>::New();
+    node->tick_count = tick_count;
+    node->period_ticks = period_ticks;
+    node->task = std::move(task);
 
-      // 要走的tick数
-      uint64_t diff_tick_count = ratio_direction ? real_ratio : 1;
+    TaskHandle handle(node);
+    submit_queues_[GetThreadId() % submit_queues_.size()]->Push(node);
+
+    // 定时器线程计划sleep到更晚的tick时唤醒它
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (tick_count < sleep_until_tick_.load()) Wakeup();
+
+    return handle;
+  }
+
+  /// 唤醒定时器线程
+  void Wakeup() {
+    {
+      std::lock_guard<std::mutex> lck(sleep_mutex_);
+      wakeup_flag_ = true;
+    }
+    sleep_cv_.notify_one();
+  }
 
-      tick_mutex_.lock();
+ private:
+  static constexpr uint64_t kNoTick = std::numeric_limits<uint64_t>::max();
+
+  /**
+   * @brief 任务节点
+   * @note 从ObjectPool中分配，依次位于提交队列和时间轮槽位中，由定时器和句柄共同引用计数。
+   * 状态通过CAS转换，只有将状态从kPending转换走的一方可以访问task
+   */
+  struct TaskNode : public MpscQueueHook {
+    static constexpr uint32_t kPending = 0;    // 等待执行
+    static constexpr uint32_t kRunning = 1;    // 周期任务正在执行
+    static constexpr uint32_t kDone = 2;       // 一次性任务已经交给executor
+    static constexpr uint32_t kCancelled = 3;  // 已取消
+
+    void AddRef() { ref_count.fetch_add(1, std::memory_order_relaxed); }
+
+    /// 执行已经交给executor的任务并释放引用。周期任务在等待执行或执行期间被取消时释放闭包
+    void Run() {
+      if (period_ticks != 0 && state.load() == kCancelled) {
+        task = nullptr;
+        Release();
+        return;
+      }
 
-      do {
-        // 取出task
-        TaskList task_list = timing_wheel_vec_[0].Tick();
+      task();
 
-        // 执行任务
-        if (!task_list.empty()) {
-          tick_mutex_.unlock();
+      if (period_ticks == 0) {
+        task = nullptr;
+      } else {
+        uint32_t cur_state = kRunning;
+        if (!state.compare_exchange_strong(cur_state, kPending)) task = nullptr;
+      }
 
-          for (auto itr = task_list.begin(); itr != task_list.end(); ++itr) {
-            task_executor_(std::move(itr->task));
-          }
+      Release();
+    }
 
-          tick_mutex_.lock();
+    /// 取消任务，从kPending取消时释放闭包，从kRunning取消时由执行方释放
+    bool Cancel() {
+      uint32_t cur_state = state.load();
+      while (cur_state == kPending || cur_state == kRunning) {
+        if (state.compare_exchange_weak(cur_state, kCancelled)) {
+          if (cur_state == kPending) task = nullptr;
+          return true;
         }
+      }
+      return false;
+    }
 
-        // 更新time point
-        ++current_tick_count_;
+    /// 丢弃提交队列或时间轮中的任务并释放引用
+    void Drop() {
+      Cancel();
+      Release();
+    }
 
-      } while (--diff_tick_count);
+    /// 丢弃已经交给executor但未执行的任务并释放引用，周期任务只跳过本次执行
+    void Abandon() {
+      uint32_t cur_state = kRunning;
+      if (period_ticks == 0 || !state.compare_exchange_strong(cur_state, kPending)) task = nullptr;
 
-      tick_mutex_.unlock();
+      Release();
     }
-  }
 
- private:
-  struct TaskWithTimestamp {
-    uint64_t tick_count;  // 距离start_time的时间tick
+    void Release() {
+      if (ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) ObjectPool<TaskNode>::Delete(this);
+    }
+
+    uint64_t tick_count = 0;    // 距离start_time的时间tick
+    uint64_t period_ticks = 0;  // 周期任务的周期，一次性任务为0
+    TaskNode* wheel_next = nullptr;  // 时间轮槽位链表中的下一个节点，只由定时器线程访问
+    TaskNode* batch_next = nullptr;  // TaskBatch链表中的下一个节点，由持有TaskBatch的线程访问
+    std::atomic<uint32_t> state = kPending;
+    std::atomic<uint32_t> ref_count = 1;  // 初始引用由定时器持有
     Task task;
   };
 
-  using TaskList = std::list<TaskWithTimestamp>;
+  /// 侵入式单向任务链表
+  struct TaskList {
+    TaskNode* head = nullptr;
+    TaskNode* tail = nullptr;
 
-  struct TimingWheelTool {
-    uint64_t current_pos;
-    uint64_t scale;
-    std::vector<TaskList> wheel;
-    std::function<void()> borrow_func;
+    bool Empty() const { return head == nullptr; }
 
-    TaskList Tick() {
-      TaskList task_list;
-      task_list.swap(wheel[current_pos]);
+    void PushBack(TaskNode* node) {
+      node->wheel_next = nullptr;
+      if (tail) {
+        tail->wheel_next = node;
+      } else {
+        head = node;
+      }
+      tail = node;
+    }
 
-      ++current_pos;
-      if (current_pos == wheel.size()) [[unlikely]] {
-        current_pos = 0;
-        borrow_func();
+    /// 取出所有节点，依次调用f
+    template <typename F>
+    void ConsumeAll(F&& f) {
+      TaskNode* node = std::exchange(head, nullptr);
+      tail = nullptr;
+      while (node) {
+        TaskNode* next = node->wheel_next;
+        f(node);
+        node = next;
       }
+    }
+  };
+
+  /// 一层时间轮。任务按tick_count / granularity放入对应槽位，只存放与当前tick位于上一层同一个槽位内的任务
+  struct TimingWheel {
+    uint64_t granularity;              // 每个槽位跨越的tick数
+    std::vector<TaskList> slots;       // 槽位
+    std::vector<uint64_t> slot_bits;   // 非空槽位的位图
+
+    size_t Size() const { return slots.size(); }
 
-      return task_list;
+    void Add(size_t pos, TaskNode* node) {
+      slots[pos].PushBack(node);
+      slot_bits[pos >> 6] |= (uint64_t(1) << (pos & 63));
+    }
+
+    TaskList Take(size_t pos) {
+      slot_bits[pos >> 6] &= ~(uint64_t(1) << (pos & 63));
+      return std::exchange(slots[pos], TaskList{});
+    }
+
+    /// 查找从pos开始的第一个非空槽位，没有则返回Size()
+    size_t FindNonEmpty(size_t pos) const {
+      size_t word_idx = pos >> 6;
+      if (word_idx >= slot_bits.size()) return Size();
+
+      uint64_t word = slot_bits[word_idx] & (~uint64_t(0) << (pos & 63));
+      while (word == 0) {
+        if (++word_idx == slot_bits.size()) return Size();
+        word = slot_bits[word_idx];
+      }
+      return (word_idx << 6) + static_cast<size_t>(std::countr_zero(word));
     }
   };
 
+  /// 定时器线程sleep期间Now()的推算依据，由定时器线程通过seqlock发布
+  struct PublishedClock {
+    std::atomic<uint64_t> seq = 0;
+    std::atomic<uint64_t> base_tick = 0;     // 已经推进到的tick
+    std::atomic<uint64_t> horizon_tick = 0;  // 推算的上限
+    std::atomic<uint64_t> anchor_tick = 0;
+    std::atomic<int64_t> anchor_ns = 0;
+    std::atomic<int64_t> step_ns = 1;
+    std::atomic<uint64_t> ticks_per_step = 0;
+  };
+
+  void PublishClock(const ClockAnchor& anchor, uint64_t base_tick, uint64_t horizon_tick) {
+    published_clock_.seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    published_clock_.base_tick.store(base_tick, std::memory_order_relaxed);
+    published_clock_.horizon_tick.store(horizon_tick, std::memory_order_relaxed);
+    published_clock_.anchor_tick.store(anchor.anchor_tick, std::memory_order_relaxed);
+    published_clock_.anchor_ns.store(anchor.anchor_ns, std::memory_order_relaxed);
+    published_clock_.step_ns.store(anchor.step_ns, std::memory_order_relaxed);
+    published_clock_.ticks_per_step.store(anchor.ticks_per_step, std::memory_order_relaxed);
+
+    published_clock_.seq.fetch_add(1, std::memory_order_release);
+  }
+
+  uint64_t NowTick() const {
+    while (true) {
+      const uint64_t seq = published_clock_.seq.load(std::memory_order_acquire);
+      if (seq & 1) continue;
+
+      const uint64_t base_tick = published_clock_.base_tick.load(std::memory_order_relaxed);
+      const uint64_t horizon_tick = published_clock_.horizon_tick.load(std::memory_order_relaxed);
+      const ClockAnchor anchor{
+          .anchor_tick = published_clock_.anchor_tick.load(std::memory_order_relaxed),
+          .anchor_ns = published_clock_.anchor_ns.load(std::memory_order_relaxed),
+          .step_ns = published_clock_.step_ns.load(std::memory_order_relaxed),
+          .ticks_per_step = published_clock_.ticks_per_step.load(std::memory_order_relaxed)};
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (published_clock_.seq.load(std::memory_order_relaxed) != seq) continue;
+
+      if (base_tick >= horizon_tick) return base_tick;
+      return std::clamp(anchor.TickAt(SteadyNowNs()), base_tick, horizon_tick);
+    }
+  }
+
+  /// 获取已发布的tick，只能由定时器线程调用
+  uint64_t PublishedBaseTick() const {
+    return published_clock_.base_tick.load(std::memory_order_relaxed);
+  }
+
+  /// 取出所有提交队列中的任务放入时间轮，只能由定时器线程调用
+  void DrainSubmitQueues(uint64_t cursor) {
+    for (auto& submit_queue : submit_queues_) {
+      while (TaskNode* node = submit_queue->Pop()) InsertTask(cursor, node);
+    }
+    DispatchExpiredTasks();
+  }
+
+  /**
+   * @brief 将任务放入时间轮，只能由定时器线程调用
+   * @note 放入最低的、与cursor位于上一层同一个槽位内的一层，超过所有层的范围时放入timing_task_map_
+   */
+  void InsertTask(uint64_t cursor, TaskNode* node) {
+    // 已取消的任务直接释放
+    if (node->state.load(std::memory_order_relaxed) == TaskNode::kCancelled) {
+      node->Release();
+      return;
+    }
+
+    const uint64_t tick_count = node->tick_count;
+
+    // 提交后、放入时间轮前时间已经过去了，直接执行
+    if (tick_count < cursor) {
+      FireTask(cursor, node);
+      return;
+    }
+
+    for (auto& timing_wheel : timing_wheel_vec_) {
+      const uint64_t span = timing_wheel.granularity * timing_wheel.Size();
+      if (tick_count / span == cursor / span) {
+        timing_wheel.Add((tick_count / timing_wheel.granularity) % timing_wheel.Size(), node);
+        return;
+      }
+    }
+
+    timing_task_map_[tick_count / total_scale_].PushBack(node);
+  }
+
+  /**
+   * @brief 将到期的任务放入expired_batch_，只能由定时器线程调用
+   * @note 一次性任务将定时器持有的引用转交给batch。周期任务的batch持有额外的引用，
+   * 原节点重新计时放回时间轮，上一次执行尚未结束时跳过本次执行
+   * @param[in] tick 当前处理的tick
+   * @param[in] node 任务节点
+   */
+  void FireTask(uint64_t tick, TaskNode* node) {
+    uint32_t state = TaskNode::kPending;
+
+    if (node->period_ticks == 0) {
+      if (node->state.compare_exchange_strong(state, TaskNode::kDone)) {
+        expired_batch_.PushBack(node);
+      } else {
+        node->Release();
+      }
+      return;
+    }
+
+    if (node->state.compare_exchange_strong(state, TaskNode::kRunning)) {
+      node->AddRef();
+      expired_batch_.PushBack(node);
+    } else if (state == TaskNode::kCancelled) {
+      node->Release();
+      return;
+    }
+
+    node->tick_count = std::max(node->tick_count + node->period_ticks, tick + 1);
+    InsertTask(tick, node);
+  }
+
+  /// 将expired_batch_交给executor，只能由定时器线程调用
+  void DispatchExpiredTasks() {
+    if (expired_batch_.Empty()) return;
+
+    if (batch_executor_) {
+      batch_executor_(std::move(expired_batch_));
+    } else {
+      expired_batch_.Split(task_executor_);
+    }
+  }
+
+  static void DropTaskList(TaskList& task_list) {
+    task_list.ConsumeAll([](TaskNode* node) { node->Drop(); });
+  }
+
+  /// 获取从cursor开始最早需要处理的tick，可能是任务到期的tick，也可能是需要将上层任务下放的tick
+  uint64_t EarliestDueTick(uint64_t cursor) const {
+    uint64_t due = kNoTick;
+
+    for (const auto& timing_wheel : timing_wheel_vec_) {
+      const uint64_t span = timing_wheel.granularity * timing_wheel.Size();
+      const size_t pos = timing_wheel.FindNonEmpty((cursor / timing_wheel.granularity) % timing_wheel.Size());
+      if (pos == timing_wheel.Size()) continue;
+
+      due = std::min(due, std::max(cursor / span * span + pos * timing_wheel.granularity, cursor));
+    }
+
+    if (!timing_task_map_.empty())
+      due = std::min(due, std::max(timing_task_map_.begin()->first * total_scale_, cursor));
+
+    return due;
+  }
+
+  /// 处理一个tick：先将上层到期槽位中的任务逐层下放，再执行最底层槽位中的任务
+  void ProcessTick(uint64_t tick) {
+    if (tick % total_scale_ == 0) {
+      auto itr = timing_task_map_.find(tick / total_scale_);
+      if (itr != timing_task_map_.end()) {
+        TaskList task_list = itr->second;
+        timing_task_map_.erase(itr);
+        task_list.ConsumeAll([this, tick](TaskNode* node) { InsertTask(tick, node); });
+      }
+    }
+
+    for (size_t ii = timing_wheel_vec_.size() - 1; ii > 0; --ii) {
+      auto& timing_wheel = timing_wheel_vec_[ii];
+      if (tick % timing_wheel.granularity != 0) continue;
+
+      TaskList task_list = timing_wheel.Take((tick / timing_wheel.granularity) % timing_wheel.Size());
+      task_list.ConsumeAll([this, tick](TaskNode* node) { InsertTask(tick, node); });
+    }
+
+    TaskList task_list = timing_wheel_vec_[0].Take(tick % timing_wheel_vec_[0].Size());
+    task_list.ConsumeAll([this, tick](TaskNode* node) { FireTask(tick, node); });
+
+    DispatchExpiredTasks();
+  }
+
  private:
   Options options_;
   std::atomic<State> state_ = State::PreInit;
 
   Executor task_executor_;
+  BatchExecutor batch_executor_;
+  TaskBatch expired_batch_;  // 当前tick到期的任务，只由定时器线程访问
 
   mutable std::shared_mutex ratio_mutex_;
   bool ratio_direction_ = true;
   uint32_t real_ratio_ = 1;
+  std::atomic<bool> ratio_changed_ = false;
 
   uint64_t start_time_point_ = 0;
 
-  mutable std::shared_mutex tick_mutex_;
-  uint64_t current_tick_count_ = 0;
-  std::vector<TimingWheelTool> timing_wheel_vec_;
-  uint64_t timing_task_map_pos_ = 0;
+  PublishedClock published_clock_;
+  std::vector<std::unique_ptr<MpscQueue<TaskNode>>> submit_queues_;
+
+  // 定时器线程的sleep与唤醒
+  std::atomic<uint64_t> sleep_until_tick_ = 0;  // 定时器线程计划sleep到的tick，未sleep时为0
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  bool wakeup_flag_ = false;
+
+  // 以下只由定时器线程访问
+  std::vector<TimingWheel> timing_wheel_vec_;
+  uint64_t total_scale_ = 1;
   std::map<uint64_t, TaskList> timing_task_map_;
 
   std::unique_ptr<std::thread> timer_thread_;
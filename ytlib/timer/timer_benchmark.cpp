@@ -0,0 +1,371 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+#if defined(YTLIB_BUILD_WITH_BOOST)
+  #include <boost/asio.hpp>
+#endif
+
+#include "timer.hpp"
+
+using namespace std::chrono_literals;
+
+// 统计堆内存分配次数
+static std::atomic<uint64_t> g_alloc_count = 0;
+
+[[gnu::noinline]] void* operator new(size_t size) {
+  g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* ptr) noexcept { std::free(ptr); }
+[[gnu::noinline]] void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace ytlib {
+
+static std::unique_ptr<Timer> g_timer;
+
+// 测量触发延迟时每轮提交的探测任务数，分散在之后的1~50ms
+static constexpr uint32_t kProbeNum = 1000;
+
+// 背景任务分散在之后的1s~1h，benchmark期间不会到期
+static std::chrono::milliseconds RandomBackgroundDelay(std::mt19937_64& rng) {
+  return std::chrono::milliseconds(1000 + rng() % 3599000);
+}
+
+// 等待已经提交的任务都被定时器线程放入时间轮
+static void WaitSubmitted(Timer& timer) {
+  std::atomic_bool done = false;
+  timer.ExecuteAfter(std::chrono::nanoseconds(0), [&done]() { done = true; });
+  while (!done.load()) std::this_thread::sleep_for(1ms);
+}
+
+/// 记录触发延迟，输出p50/p99/p999，单位us
+class LatenessRecorder {
+ public:
+  void Add(std::chrono::steady_clock::duration lateness) { lateness_vec_.emplace_back(lateness.count()); }
+
+  void Report(benchmark::State& state) {
+    if (lateness_vec_.empty()) return;
+
+    std::sort(lateness_vec_.begin(), lateness_vec_.end());
+    auto percentile = [this](double p) {
+      const size_t idx = std::min(static_cast<size_t>(p * lateness_vec_.size()), lateness_vec_.size() - 1);
+      return static_cast<double>(lateness_vec_[idx]) / 1000.0;
+    };
+
+    state.counters["p50_us"] = percentile(0.5);
+    state.counters["p99_us"] = percentile(0.99);
+    state.counters["p999_us"] = percentile(0.999);
+  }
+
+ private:
+  std::vector<int64_t> lateness_vec_;
+};
+
+/// 测量一段时间内进程的cpu使用率
+class CpuUsageMeter {
+ public:
+  CpuUsageMeter() : cpu_begin_(std::clock()), wall_begin_(std::chrono::steady_clock::now()) {}
+
+  double Usage() const {
+    const double cpu_sec = static_cast<double>(std::clock() - cpu_begin_) / CLOCKS_PER_SEC;
+    const double wall_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_begin_).count();
+    return cpu_sec / wall_sec;
+  }
+
+ private:
+  std::clock_t cpu_begin_;
+  std::chrono::steady_clock::time_point wall_begin_;
+};
+
+#if defined(YTLIB_BUILD_WITH_BOOST)
+
+/// asio基线：每个任务一个steady_timer，io_context运行在单独的线程中
+class AsioTimerBaseline {
+ public:
+  AsioTimerBaseline() : work_guard_(io_.get_executor()), io_thread_([this]() { io_.run(); }) {}
+
+  ~AsioTimerBaseline() {
+    work_guard_.reset();
+    io_.stop();
+    io_thread_.join();
+    background_timers_.clear();
+  }
+
+  template <typename Handler>
+  std::shared_ptr<boost::asio::steady_timer> ExecuteAt(std::chrono::steady_clock::time_point tp, Handler&& handler) {
+    auto timer_ptr = std::make_shared<boost::asio::steady_timer>(io_, tp);
+    timer_ptr->async_wait([timer_ptr, handler = std::forward<Handler>(handler)](const boost::system::error_code& ec) mutable {
+      if (!ec) handler();
+    });
+    return timer_ptr;
+  }
+
+  void AddBackgroundTimer(std::chrono::steady_clock::time_point tp) {
+    auto& timer = background_timers_.emplace_back(std::make_unique<boost::asio::steady_timer>(io_, tp));
+    timer->async_wait([](const boost::system::error_code&) {});
+  }
+
+ private:
+  boost::asio::io_context io_{1};
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard_;
+  std::thread io_thread_;
+  std::vector<std::unique_ptr<boost::asio::steady_timer>> background_timers_;
+};
+
+#endif
+
+// 多个线程同时提交任务的吞吐
+static void BM_Timer_ExecuteAt(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    g_timer = std::make_unique<Timer>();
+    g_timer->Initialize(Timer::Options{});
+    g_timer->Start();
+  }
+
+  uint64_t ct = 0;
+  for (auto _ : state) {
+    // 任务分散到未来的1~60秒，在benchmark期间不会被执行
+    g_timer->ExecuteAt(g_timer->Now() + 1s + std::chrono::milliseconds(ct++ % 59000), []() {});
+  }
+
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    g_timer.reset();
+  }
+}
+BENCHMARK(BM_Timer_ExecuteAt)->ThreadRange(1, 16)->UseRealTime();
+
+// 提交后立即取消
+static void BM_Timer_ExecuteAtAndCancel(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    g_timer = std::make_unique<Timer>();
+    g_timer->Initialize(Timer::Options{});
+    g_timer->Start();
+  }
+
+  uint64_t ct = 0;
+  for (auto _ : state) {
+    auto handle = g_timer->ExecuteAt(g_timer->Now() + 1s + std::chrono::milliseconds(ct++ % 59000), []() {});
+    handle.Cancel();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    g_timer.reset();
+  }
+}
+BENCHMARK(BM_Timer_ExecuteAtAndCancel)->ThreadRange(1, 16)->UseRealTime();
+
+// 稳定状态下每个定时任务的堆内存分配次数，任务很快到期，节点被回收复用
+template <size_t CaptureSize>
+static void BM_Timer_AllocsPerTimer(benchmark::State& state) {
+  Timer timer;
+  timer.Initialize(Timer::Options{});
+  timer.Start();
+
+  std::array<char, CaptureSize> payload{};
+  std::atomic<uint64_t> done_count = 0;
+  uint64_t submit_count = 0;
+
+  auto submit = [&]() {
+    ++submit_count;
+    timer.ExecuteAfter(1ms, [payload, &done_count]() mutable {
+      benchmark::DoNotOptimize(payload);
+      done_count.fetch_add(1, std::memory_order_relaxed);
+    });
+  };
+
+  // 预热，填充对象池
+  for (uint32_t ii = 0; ii < 100000; ++ii) submit();
+  while (done_count.load() < submit_count) std::this_thread::sleep_for(1ms);
+
+  const uint64_t alloc_count_begin = g_alloc_count.load();
+  for (auto _ : state) {
+    submit();
+    // 控制在途任务数量，避免对象池持续扩容
+    while (submit_count - done_count.load(std::memory_order_relaxed) > 10000) std::this_thread::yield();
+  }
+  const uint64_t alloc_count = g_alloc_count.load() - alloc_count_begin;
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["allocs_per_timer"] = static_cast<double>(alloc_count) / state.iterations();
+
+  timer.Shutdown();
+}
+BENCHMARK_TEMPLATE(BM_Timer_AllocsPerTimer, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Timer_AllocsPerTimer, 40)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Timer_AllocsPerTimer, 128)->UseRealTime();
+
+// 取消已经提交的任务
+static void BM_Timer_Cancel(benchmark::State& state) {
+  Timer timer;
+  timer.Initialize(Timer::Options{});
+  timer.Start();
+
+  std::vector<Timer::TaskHandle> handles;
+  size_t idx = 0;
+  uint64_t ct = 0;
+  for (auto _ : state) {
+    if (idx == handles.size()) {
+      state.PauseTiming();
+      handles.clear();
+      for (uint32_t ii = 0; ii < 100000; ++ii)
+        handles.emplace_back(timer.ExecuteAt(timer.Now() + 1s + std::chrono::milliseconds(ct++ % 59000), []() {}));
+      idx = 0;
+      state.ResumeTiming();
+    }
+
+    benchmark::DoNotOptimize(handles[idx++].Cancel());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+
+  timer.Shutdown();
+}
+BENCHMARK(BM_Timer_Cancel)->UseRealTime();
+
+// 有pending个等待中的任务时的触发延迟
+static void BM_Timer_Lateness(benchmark::State& state) {
+  Timer timer;
+  timer.Initialize(Timer::Options{});
+  timer.Start();
+
+  std::mt19937_64 rng(0);
+  for (int64_t ii = 0; ii < state.range(0); ++ii) timer.ExecuteAfter(RandomBackgroundDelay(rng), []() {});
+  WaitSubmitted(timer);
+
+  // 默认executor在定时器线程中直接执行，只有定时器线程访问recorder
+  LatenessRecorder recorder;
+  for (auto _ : state) {
+    std::atomic<uint32_t> done_count = 0;
+    const auto base_tp = timer.Now();
+    for (uint32_t ii = 0; ii < kProbeNum; ++ii) {
+      const auto tp = base_tp + 1ms + std::chrono::milliseconds(ii % 50);
+      timer.ExecuteAt(tp, [&recorder, &done_count, tp]() {
+        recorder.Add(std::chrono::steady_clock::now() - tp);
+        ++done_count;
+      });
+    }
+
+    while (done_count.load() < kProbeNum) std::this_thread::sleep_for(1ms);
+  }
+
+  recorder.Report(state);
+  state.SetItemsProcessed(state.iterations() * kProbeNum);
+
+  timer.Shutdown();
+}
+BENCHMARK(BM_Timer_Lateness)->Arg(1000)->Arg(100000)->Arg(10000000)->Iterations(10)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// 有pending个等待中的任务时，空闲状态的cpu使用率
+static void BM_Timer_IdleCpu(benchmark::State& state) {
+  Timer timer;
+  timer.Initialize(Timer::Options{});
+  timer.Start();
+
+  std::mt19937_64 rng(0);
+  for (int64_t ii = 0; ii < state.range(0); ++ii) timer.ExecuteAfter(RandomBackgroundDelay(rng) + 10s, []() {});
+  WaitSubmitted(timer);
+
+  CpuUsageMeter meter;
+  for (auto _ : state) std::this_thread::sleep_for(1s);
+  state.counters["cpu_usage"] = meter.Usage();
+
+  timer.Shutdown();
+}
+BENCHMARK(BM_Timer_IdleCpu)->Arg(0)->Arg(100000)->Iterations(3)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+#if defined(YTLIB_BUILD_WITH_BOOST)
+
+// asio基线：提交任务的吞吐
+static void BM_AsioSteadyTimer_ExecuteAt(benchmark::State& state) {
+  AsioTimerBaseline baseline;
+
+  uint64_t ct = 0;
+  for (auto _ : state) {
+    baseline.ExecuteAt(std::chrono::steady_clock::now() + 1s + std::chrono::milliseconds(ct++ % 59000), []() {});
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AsioSteadyTimer_ExecuteAt)->UseRealTime();
+
+// asio基线：提交后立即取消
+static void BM_AsioSteadyTimer_ExecuteAtAndCancel(benchmark::State& state) {
+  AsioTimerBaseline baseline;
+
+  uint64_t ct = 0;
+  for (auto _ : state) {
+    auto timer_ptr = baseline.ExecuteAt(std::chrono::steady_clock::now() + 1s + std::chrono::milliseconds(ct++ % 59000), []() {});
+    timer_ptr->cancel();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AsioSteadyTimer_ExecuteAtAndCancel)->UseRealTime();
+
+// asio基线：有pending个等待中的任务时的触发延迟
+static void BM_AsioSteadyTimer_Lateness(benchmark::State& state) {
+  AsioTimerBaseline baseline;
+
+  std::mt19937_64 rng(0);
+  const auto now = std::chrono::steady_clock::now();
+  for (int64_t ii = 0; ii < state.range(0); ++ii) baseline.AddBackgroundTimer(now + RandomBackgroundDelay(rng));
+
+  // 只有io线程访问recorder
+  LatenessRecorder recorder;
+  for (auto _ : state) {
+    std::atomic<uint32_t> done_count = 0;
+    const auto base_tp = std::chrono::steady_clock::now();
+    for (uint32_t ii = 0; ii < kProbeNum; ++ii) {
+      const auto tp = base_tp + 1ms + std::chrono::milliseconds(ii % 50);
+      baseline.ExecuteAt(tp, [&recorder, &done_count, tp]() {
+        recorder.Add(std::chrono::steady_clock::now() - tp);
+        ++done_count;
+      });
+    }
+
+    while (done_count.load() < kProbeNum) std::this_thread::sleep_for(1ms);
+  }
+
+  recorder.Report(state);
+  state.SetItemsProcessed(state.iterations() * kProbeNum);
+}
+BENCHMARK(BM_AsioSteadyTimer_Lateness)->Arg(1000)->Arg(100000)->Arg(10000000)->Iterations(10)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// asio基线：有pending个等待中的任务时，空闲状态的cpu使用率
+static void BM_AsioSteadyTimer_IdleCpu(benchmark::State& state) {
+  AsioTimerBaseline baseline;
+
+  std::mt19937_64 rng(0);
+  const auto now = std::chrono::steady_clock::now();
+  for (int64_t ii = 0; ii < state.range(0); ++ii) baseline.AddBackgroundTimer(now + RandomBackgroundDelay(rng) + 10s);
+
+  std::this_thread::sleep_for(100ms);
+
+  CpuUsageMeter meter;
+  for (auto _ : state) std::this_thread::sleep_for(1s);
+  state.counters["cpu_usage"] = meter.Usage();
+}
+BENCHMARK(BM_AsioSteadyTimer_IdleCpu)->Arg(0)->Arg(100000)->Iterations(3)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+#endif
+
+}  // namespace ytlib
+
+BENCHMARK_MAIN();
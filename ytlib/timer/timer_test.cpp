@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "timer.hpp"
 #include "ytlib/misc/misc_macro.h"
 
@@ -75,4 +82,229 @@ TEST(Timer, base) {
   timer.Shutdown();
 }
 
+TEST(Timer, multi_level) {
+  Timer timer;
+
+  Timer::Options op{
+      .dt = 1ms,
+      .wheel_size_array = {10, 10}};
+
+  timer.Initialize(op);
+  timer.Start();
+
+  // 任务分布在各层时间轮以及超出时间轮范围的部分，都不能提前执行
+  std::mutex mu;
+  std::vector<int64_t> lateness;
+  const auto start_tp = timer.Now();
+  const std::vector<uint32_t> delays = {0, 3, 9, 10, 11, 37, 99, 100, 101, 250, 333};
+  for (auto delay : delays) {
+    auto tp = start_tp + delay * 1ms;
+    timer.ExecuteAt(tp, [&, tp]() {
+      std::lock_guard<std::mutex> lck(mu);
+      lateness.emplace_back((std::chrono::steady_clock::now() - tp).count());
+    });
+  }
+
+  std::this_thread::sleep_for(500ms);
+
+  std::lock_guard<std::mutex> lck(mu);
+  ASSERT_EQ(lateness.size(), delays.size());
+  for (auto item : lateness) EXPECT_GE(item, 0);
+
+  timer.Shutdown();
+}
+
+TEST(Timer, idle) {
+  Timer timer;
+  timer.Initialize(Timer::Options{});
+  timer.Start();
+
+  // 空闲时定时器线程sleep，Now()依然按时间推进
+  std::this_thread::sleep_for(100ms);
+  auto virtual_du = timer.Now() - timer.StartTimePoint();
+  EXPECT_GE(virtual_du, 90ms);
+  EXPECT_LE(virtual_du, 110ms);
+
+  // 先提交较晚的任务，再提交较早的任务，较早的任务需要唤醒定时器线程
+  std::atomic_bool late_done = false, early_done = false;
+  timer.ExecuteAfter(10s, [&]() { late_done = true; });
+  std::this_thread::sleep_for(10ms);
+  timer.ExecuteAfter(20ms, [&]() { early_done = true; });
+
+  std::this_thread::sleep_for(100ms);
+  EXPECT_TRUE(early_done);
+  EXPECT_FALSE(late_done);
+
+  // 运行超过最长sleep时间后依然按时唤醒
+  std::this_thread::sleep_for(1s);
+  std::atomic_bool done = false;
+  timer.ExecuteAfter(20ms, [&]() { done = true; });
+  std::this_thread::sleep_for(100ms);
+  EXPECT_TRUE(done);
+  EXPECT_FALSE(late_done);
+
+  timer.Shutdown();
+}
+
+TEST(Timer, cancel) {
+  Timer timer;
+  timer.Initialize(Timer::Options{});
+  timer.Start();
+
+  // 取消后闭包立即释放
+  std::atomic_bool done = false;
+  auto flag = std::make_shared<int>(0);
+  auto handle = timer.ExecuteAfter(50ms, [&done, flag]() { done = true; });
+  ASSERT_TRUE(handle.Valid());
+  EXPECT_EQ(flag.use_count(), 2);
+
+  EXPECT_TRUE(handle.Cancel());
+  EXPECT_EQ(flag.use_count(), 1);
+  EXPECT_FALSE(handle.Cancel());
+
+  // 执行后无法取消
+  std::atomic_bool done2 = false;
+  auto handle2 = timer.ExecuteAfter(10ms, [&done2]() { done2 = true; });
+
+  std::this_thread::sleep_for(100ms);
+  EXPECT_FALSE(done);
+  EXPECT_TRUE(done2);
+  EXPECT_FALSE(handle2.Cancel());
+
+  // 时间点已经过去的任务直接执行，返回空句柄
+  std::atomic_bool done3 = false;
+  auto handle3 = timer.ExecuteAt(timer.StartTimePoint(), [&done3]() { done3 = true; });
+  EXPECT_TRUE(done3);
+  EXPECT_FALSE(handle3.Valid());
+  EXPECT_FALSE(handle3.Cancel());
+
+  // 定时器析构后句柄依然可用
+  auto handle4 = timer.ExecuteAfter(10s, []() {});
+  timer.Shutdown();
+  EXPECT_TRUE(handle4.Cancel());
+}
+
+TEST(Timer, execute_every) {
+  Timer timer;
+  timer.Initialize(Timer::Options{});
+  timer.Start();
+
+  std::atomic_uint32_t count = 0;
+  auto flag = std::make_shared<int>(0);
+  auto handle = timer.ExecuteEvery(10ms, [&count, flag]() { ++count; });
+
+  std::this_thread::sleep_for(105ms);
+  const uint32_t cur_count = count.load();
+  EXPECT_GE(cur_count, 8);
+  EXPECT_LE(cur_count, 11);
+
+  // 取消后不再执行，闭包被释放
+  EXPECT_TRUE(handle.Cancel());
+  EXPECT_EQ(flag.use_count(), 1);
+
+  std::this_thread::sleep_for(50ms);
+  EXPECT_EQ(count.load(), cur_count);
+  EXPECT_FALSE(handle.Cancel());
+
+  timer.Shutdown();
+}
+
+TEST(Timer, batch_executor) {
+  Timer timer;
+
+  // 提交期间时间暂停，保证所有任务在同一个tick到期
+  timer.Initialize(Timer::Options{.init_ratio = 0.0});
+
+  // 同一个tick到期的任务整批交给executor，在其他线程中执行
+  std::mutex mu;
+  std::vector<Timer::TaskBatch> batches;
+  timer.RegisterBatchExecutor([&](Timer::TaskBatch&& batch) {
+    std::lock_guard<std::mutex> lck(mu);
+    batches.emplace_back(std::move(batch));
+  });
+  timer.Start();
+
+  const uint32_t task_num = 100000;
+  std::atomic_uint32_t count = 0;
+  const auto tp = timer.Now() + 100ms;
+  for (uint32_t ii = 0; ii < task_num; ++ii) timer.ExecuteAt(tp, [&count]() { ++count; });
+
+  // 周期任务在batch中等待执行时被取消，不会再执行
+  std::atomic_uint32_t every_count = 0;
+  auto handle = timer.ExecuteEvery(15ms, [&every_count]() { ++every_count; });
+
+  timer.SetTimeRatio(1.0);
+
+  std::this_thread::sleep_for(200ms);
+  EXPECT_EQ(count.load(), 0);
+
+  std::vector<Timer::TaskBatch> cur_batches;
+  {
+    std::lock_guard<std::mutex> lck(mu);
+    cur_batches.swap(batches);
+  }
+
+  size_t max_batch_size = 0;
+  for (auto& batch : cur_batches) max_batch_size = std::max(max_batch_size, batch.Size());
+  EXPECT_EQ(max_batch_size, task_num);
+
+  EXPECT_TRUE(handle.Cancel());
+  std::thread t([&cur_batches]() {
+    for (auto& batch : cur_batches) batch.Run();
+  });
+  t.join();
+
+  EXPECT_EQ(count.load(), task_num);
+  EXPECT_EQ(every_count.load(), 0);
+
+  timer.Shutdown();
+}
+
+TEST(Timer, batch_executor_split) {
+  Timer timer;
+  timer.Initialize(Timer::Options{});
+
+  // 拆分为单个任务，丢弃阶段收集后直接析构，不执行
+  std::mutex mu;
+  std::vector<Timer::Task> dropped_tasks;
+  std::atomic_bool drop_flag = true;
+  timer.RegisterBatchExecutor([&](Timer::TaskBatch&& batch) {
+    batch.Split([&](Timer::Task&& task) {
+      if (drop_flag.load()) {
+        std::lock_guard<std::mutex> lck(mu);
+        dropped_tasks.emplace_back(std::move(task));
+      } else {
+        task();
+      }
+    });
+  });
+  timer.Start();
+
+  std::atomic_uint32_t every_count = 0;
+  auto flag = std::make_shared<int>(0);
+  auto handle = timer.ExecuteEvery(10ms, [&every_count, flag]() { ++every_count; });
+
+  std::this_thread::sleep_for(50ms);
+  {
+    std::lock_guard<std::mutex> lck(mu);
+    EXPECT_FALSE(dropped_tasks.empty());
+    dropped_tasks.clear();
+  }
+  EXPECT_EQ(every_count.load(), 0);
+
+  // 未执行就析构的周期任务只跳过本次执行，之后照常执行
+  drop_flag = false;
+  std::this_thread::sleep_for(50ms);
+  EXPECT_GT(every_count.load(), 0);
+
+  // 取消后闭包被释放
+  EXPECT_TRUE(handle.Cancel());
+  timer.Shutdown();
+  {
+    std::lock_guard<std::mutex> lck(mu);
+    dropped_tasks.clear();
+  }
+  EXPECT_EQ(flag.use_count(), 1);
+}
+
 }  // namespace ytlib
@@ -0,0 +1,126 @@
+/**
+ * @file asio_buffer_vec_writer.hpp
+ * @brief 将BufferVec聚合写入socket的工具
+ * @note asio的async_write每次系统调用最多只提交64段内存，发送队列中积累了大量小包时会拆成很多次系统调用。
+ * posix平台下直接使用sendmsg，每次最多提交IOV_MAX段内存，socket缓冲区满时再通过asio等待可写
+ * @author WT
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#if !defined(_WIN32)
+  #include <cerrno>
+  #include <climits>
+
+  #include <sys/socket.h>
+  #include <sys/uio.h>
+#endif
+
+namespace ytlib {
+namespace ytrpc {
+
+/**
+ * @brief 将多段内存聚合写入tcp socket
+ * @note 内部缓存了每次写入时使用的iovec数组，同一时间只能有一个协程使用
+ */
+class AsioBufferVecWriter {
+ public:
+#if defined(_WIN32)
+  static constexpr size_t kMaxIovNum = 64;
+#elif defined(IOV_MAX)
+  static constexpr size_t kMaxIovNum = IOV_MAX;
+#else
+  static constexpr size_t kMaxIovNum = 1024;
+#endif
+
+  AsioBufferVecWriter() = default;
+  ~AsioBufferVecWriter() = default;
+
+  AsioBufferVecWriter(const AsioBufferVecWriter&) = delete;
+  AsioBufferVecWriter& operator=(const AsioBufferVecWriter&) = delete;
+
+  /**
+   * @brief 将buffer_vec中的数据全部写入sock
+   * @note 出错时抛出boost::system::system_error异常
+   * @param[in] sock tcp socket，需要在socket所在的strand中调用
+   * @param[in] buffer_vec 待写入的各段内存
+   * @return boost::asio::awaitable<size_t> 写入的字节数
+   */
+  boost::asio::awaitable<size_t> AsyncWrite(boost::asio::ip::tcp::socket& sock, std::span<const std::pair<void*, size_t>> buffer_vec) {
+#if defined(_WIN32)
+    iov_vec_.clear();
+    for (const auto& buffer : buffer_vec) {
+      iov_vec_.emplace_back(buffer.first, buffer.second);
+    }
+
+    co_return co_await boost::asio::async_write(sock, iov_vec_, boost::asio::use_awaitable);
+#else
+    const size_t buffer_num = buffer_vec.size();
+    size_t write_data_size = 0;
+    size_t cur_index = 0;   // 当前未写完的第一段内存
+    size_t cur_offset = 0;  // 当前段内存中已经写入的大小
+
+    for (;;) {
+      while (cur_index < buffer_num && cur_offset == buffer_vec[cur_index].second) {
+        ++cur_index;
+        cur_offset = 0;
+      }
+      if (cur_index == buffer_num) break;
+
+      iov_vec_.clear();
+      for (size_t ii = cur_index; ii < buffer_num && iov_vec_.size() < kMaxIovNum; ++ii) {
+        const size_t offset = (ii == cur_index) ? cur_offset : 0;
+        iov_vec_.emplace_back(iovec{static_cast<char*>(buffer_vec[ii].first) + offset, buffer_vec[ii].second - offset});
+      }
+
+      msghdr msg{};
+      msg.msg_iov = iov_vec_.data();
+      msg.msg_iovlen = iov_vec_.size();
+
+      const ssize_t ret = ::sendmsg(sock.native_handle(), &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+      if (ret < 0) {
+        if (errno == EINTR) continue;
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          co_await sock.async_wait(boost::asio::ip::tcp::socket::wait_write, boost::asio::use_awaitable);
+          continue;
+        }
+
+        throw boost::system::system_error(errno, boost::system::system_category(), "sendmsg");
+      }
+
+      write_data_size += ret;
+
+      for (size_t left_size = ret; left_size > 0;) {
+        const size_t cur_left_size = buffer_vec[cur_index].second - cur_offset;
+        if (left_size < cur_left_size) {
+          cur_offset += left_size;
+          break;
+        }
+
+        left_size -= cur_left_size;
+        ++cur_index;
+        cur_offset = 0;
+      }
+    }
+
+    co_return write_data_size;
+#endif
+  }
+
+ private:
+#if defined(_WIN32)
+  std::vector<boost::asio::const_buffer> iov_vec_;
+#else
+  std::vector<iovec> iov_vec_;
+#endif
+};
+
+}  // namespace ytrpc
+}  // namespace ytlib
@@ -10,7 +10,9 @@
 #include <algorithm>
 #include <atomic>
 #include <memory>
-#include <unordered_map>
+#include <optional>
+#include <span>
+#include <vector>
 
 #include <boost/asio.hpp>
 
@@ -18,9 +20,12 @@
 #include "ytlib/boost_tools_asio/net_util.hpp"
 #include "ytlib/misc/misc_macro.h"
 
+#include "asio_buffer_vec_writer.hpp"
 #include "asio_rpc_context.hpp"
 #include "asio_rpc_status.hpp"
 #include "ytlib/ytrpc/rpc_util/buffer.hpp"
+#include "ytlib/ytrpc/rpc_util/pending_request.hpp"
+#include "ytlib/ytrpc/rpc_util/recv_buffer.hpp"
 
 #include "Head.pb.h"
 
@@ -29,21 +34,45 @@ namespace ytrpc {
 
 class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
  public:
+  /// 负载均衡策略
+  enum class LbPolicy {
+    kLeastPending,  // 选择正在进行的调用数最少的连接
+    kRoundRobin,    // 轮询
+  };
+
   /**
    * @brief 配置
    *
    */
   struct Cfg {
-    boost::asio::ip::tcp::endpoint svr_ep;                                           // 服务端地址
+    boost::asio::ip::tcp::endpoint svr_ep;                                           // 服务端地址，svr_ep_vec为空时使用
+    std::vector<boost::asio::ip::tcp::endpoint> svr_ep_vec;                          // 多个服务端地址
+    uint32_t conn_num_per_ep = 1;                                                    // 每个服务端地址的连接数
+    LbPolicy lb_policy = LbPolicy::kLeastPending;                                    // 负载均衡策略
+    uint32_t max_connect_fail_num = 3;                                               // 连续建立连接失败达到此次数时暂时剔除该服务端地址
+    uint32_t max_call_fail_num = 5;                                                  // 连续调用超时或连接异常断开达到此次数时暂时剔除该服务端地址
+    std::chrono::steady_clock::duration eject_time = std::chrono::seconds(10);       // 剔除时间，到期后重新尝试
     std::chrono::steady_clock::duration heart_beat_time = std::chrono::seconds(60);  // 心跳包间隔
     uint32_t max_recv_size = 1024 * 1024 * 10;                                       // 回包最大尺寸，最大10m
+    std::chrono::steady_clock::duration send_coalesce_window = {};                   // 发送合并窗口，为0时只合并发送协程忙碌期间积累的包
+    uint32_t send_coalesce_size = 64 * 1024;                                         // 合并窗口内积累的数据达到此大小时立即发送
 
     /// 校验配置
     static Cfg Verify(const Cfg& verify_cfg) {
       Cfg cfg(verify_cfg);
 
+      if (cfg.svr_ep_vec.empty()) cfg.svr_ep_vec.emplace_back(cfg.svr_ep);
+      if (cfg.conn_num_per_ep < 1) cfg.conn_num_per_ep = 1;
+      if (cfg.max_connect_fail_num < 1) cfg.max_connect_fail_num = 1;
+      if (cfg.max_call_fail_num < 1) cfg.max_call_fail_num = 1;
+      if (cfg.eject_time < std::chrono::milliseconds(100)) cfg.eject_time = std::chrono::milliseconds(100);
+
       if (cfg.heart_beat_time < std::chrono::milliseconds(100)) cfg.heart_beat_time = std::chrono::milliseconds(100);
 
+      if (cfg.send_coalesce_window < std::chrono::steady_clock::duration::zero()) cfg.send_coalesce_window = std::chrono::steady_clock::duration::zero();
+      if (cfg.send_coalesce_window > std::chrono::milliseconds(100)) cfg.send_coalesce_window = std::chrono::milliseconds(100);
+      if (cfg.send_coalesce_size < 1) cfg.send_coalesce_size = 1;
+
       return cfg;
     }
   };
@@ -58,7 +87,12 @@ class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
       : cfg_(AsioRpcClient::Cfg::Verify(cfg)),
         io_ptr_(io_ptr),
         session_cfg_ptr_(std::make_shared<const AsioRpcClient::SessionCfg>(cfg_)),
-        mgr_strand_(boost::asio::make_strand(*io_ptr_)) {}
+        mgr_strand_(boost::asio::make_strand(*io_ptr_)),
+        session_slot_vec_(cfg_.svr_ep_vec.size() * cfg_.conn_num_per_ep) {
+    for (const auto& ep : cfg_.svr_ep_vec) {
+      ep_state_ptr_vec_.emplace_back(std::make_shared<AsioRpcClient::EpState>(ep));
+    }
+  }
 
   ~AsioRpcClient() = default;
 
@@ -93,8 +127,10 @@ class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
 
     msg_ctx.req_buf_vec.CommitLastBuf(os.LastBufSize());
 
-    std::shared_ptr<AsioRpcClient::Session> cur_session_ptr;
-    std::atomic_store(&cur_session_ptr, session_ptr_);
+    const size_t slot_index = SelectSessionSlot();
+    AsioRpcClient::SessionSlot& slot = session_slot_vec_[slot_index];
+
+    std::shared_ptr<AsioRpcClient::Session> cur_session_ptr = std::atomic_load(&slot.session_ptr);
     while (!cur_session_ptr || !cur_session_ptr->IsRunning()) {
       if (!run_flag_) [[unlikely]] {
         co_return AsioRpcStatus(AsioRpcStatus::Code::CLI_IS_NOT_RUNNING);
@@ -102,33 +138,45 @@ class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
 
       co_await boost::asio::co_spawn(
           mgr_strand_,
-          [this]() -> boost::asio::awaitable<void> {
+          [this, &slot, slot_index]() -> boost::asio::awaitable<void> {
             if (!run_flag_) [[unlikely]]
               co_return;
 
-            std::shared_ptr<AsioRpcClient::Session> tmp_session_ptr;
-            std::atomic_store(&tmp_session_ptr, session_ptr_);
+            std::shared_ptr<AsioRpcClient::Session> tmp_session_ptr = std::atomic_load(&slot.session_ptr);
 
             if (!tmp_session_ptr || !tmp_session_ptr->IsRunning()) {
-              tmp_session_ptr = std::make_shared<AsioRpcClient::Session>(io_ptr_, session_cfg_ptr_);
+              const auto& ep_state_ptr = ep_state_ptr_vec_[slot_index % ep_state_ptr_vec_.size()];
+              slot.connecting_flag_ptr->store(true, std::memory_order_relaxed);
+              tmp_session_ptr = std::make_shared<AsioRpcClient::Session>(io_ptr_, session_cfg_ptr_, ep_state_ptr, slot.connecting_flag_ptr);
               tmp_session_ptr->Start();
-              std::atomic_store(&session_ptr_, tmp_session_ptr);
+              std::atomic_store(&slot.session_ptr, tmp_session_ptr);
             }
             co_return;
           },
           boost::asio::use_awaitable);
 
-      std::atomic_store(&cur_session_ptr, session_ptr_);
+      cur_session_ptr = std::atomic_load(&slot.session_ptr);
     }
 
+    slot.pending_num.fetch_add(1, std::memory_order_relaxed);
     co_await cur_session_ptr->Invoke(msg_ctx);
+    slot.pending_num.fetch_sub(1, std::memory_order_relaxed);
+
+    // 收到回包即说明服务端地址可用，超时计为一次失败。连接断开由session计一次失败，不按其上的调用数重复计数
+    const auto& ep_state_ptr = ep_state_ptr_vec_[slot_index % ep_state_ptr_vec_.size()];
+    if (msg_ctx.ret_status.Ret() == AsioRpcStatus::Code::TIMEOUT) [[unlikely]] {
+      ep_state_ptr->OnCall(false, cfg_.max_call_fail_num, cfg_.eject_time);
+    } else if (msg_ctx.ret_status.Ret() != AsioRpcStatus::Code::CLI_SESSION_CLOSED) [[likely]] {
+      ep_state_ptr->OnCall(true, cfg_.max_call_fail_num, cfg_.eject_time);
+    }
 
     if (msg_ctx.ret_status.Ret() != AsioRpcStatus::Code::OK) [[unlikely]] {
       msg_ctx.ctx.Done("call " + func_name + "failed, " + msg_ctx.ret_status.ToString());
       co_return std::move(msg_ctx.ret_status);
     }
 
-    if (!rsp.ParseFromArray(msg_ctx.rsp_buf + msg_ctx.rsp_pos, msg_ctx.rsp_buf_len - msg_ctx.rsp_pos)) [[unlikely]]
+    BufferVecZeroCopyInputStream rsp_is(msg_ctx.rsp_frame.Vec());
+    if (!rsp_is.Skip(msg_ctx.rsp_pos) || !rsp.ParseFromZeroCopyStream(&rsp_is)) [[unlikely]]
       co_return AsioRpcStatus(AsioRpcStatus::Code::CLI_PARSE_RSP_FAILED);
 
     co_return std::move(msg_ctx.ret_status);
@@ -147,12 +195,9 @@ class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
         [this, self]() {
           ASIO_DEBUG_HANDLE(rpc_cli_stop_co);
 
-          std::shared_ptr<AsioRpcClient::Session> cur_session_ptr;
-          std::atomic_store(&cur_session_ptr, session_ptr_);
-
-          if (cur_session_ptr) {
-            cur_session_ptr->Stop();
-            cur_session_ptr.reset();
+          for (auto& slot : session_slot_vec_) {
+            std::shared_ptr<AsioRpcClient::Session> cur_session_ptr = std::atomic_load(&slot.session_ptr);
+            if (cur_session_ptr) cur_session_ptr->Stop();
           }
         });
   }
@@ -172,84 +217,191 @@ class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
 
   uint32_t GetNewReqID() { return ++req_id_; }
 
-  struct MsgContext {
+  // 服务端地址的健康状态，由该地址的所有连接共享
+  struct EpState {
+    explicit EpState(const boost::asio::ip::tcp::endpoint& input_ep)
+        : ep(input_ep) {}
+
+    /// 当前是否没有被剔除
+    bool IsHealthy(std::chrono::steady_clock::time_point now) const {
+      return now.time_since_epoch().count() >= eject_end_time.load(std::memory_order_relaxed);
+    }
+
+    /// 记录一次建立连接的结果，连续失败达到上限时剔除一段时间。剔除到期后再次失败会立即重新剔除
+    void OnConnect(bool success, uint32_t max_connect_fail_num, std::chrono::steady_clock::duration eject_time) {
+      if (success) {
+        connect_fail_num.store(0, std::memory_order_relaxed);
+        return;
+      }
+
+      if (connect_fail_num.fetch_add(1, std::memory_order_relaxed) + 1 >= max_connect_fail_num) Eject(eject_time);
+    }
+
+    /// 记录一次调用的结果，连续失败达到上限时剔除一段时间。成功时只在有失败记录时才写，避免调用热路径上的缓存行争用
+    void OnCall(bool success, uint32_t max_call_fail_num, std::chrono::steady_clock::duration eject_time) {
+      if (success) {
+        if (call_fail_num.load(std::memory_order_relaxed) != 0) call_fail_num.store(0, std::memory_order_relaxed);
+        return;
+      }
+
+      if (call_fail_num.fetch_add(1, std::memory_order_relaxed) + 1 >= max_call_fail_num) {
+        call_fail_num.store(0, std::memory_order_relaxed);
+        Eject(eject_time);
+      }
+    }
+
+    void Eject(std::chrono::steady_clock::duration eject_time) {
+      eject_end_time.store((std::chrono::steady_clock::now() + eject_time).time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+    const boost::asio::ip::tcp::endpoint ep;
+    std::atomic_uint32_t connect_fail_num = 0;                       // 连续建立连接失败的次数
+    std::atomic_uint32_t call_fail_num = 0;                          // 连续调用失败的次数
+    std::atomic<std::chrono::steady_clock::rep> eject_end_time = 0;  // 剔除的截止时间
+  };
+
+  /**
+   * @brief 按负载均衡策略选择一个连接槽位
+   * @note 跳过被剔除的服务端地址，最少调用数策略下还跳过正在建立连接的槽位。
+   * 没有可选的槽位时不再跳过，按策略在全部槽位中选择
+   * @return size_t 槽位下标
+   */
+  size_t SelectSessionSlot() {
+    const size_t slot_num = session_slot_vec_.size();
+    if (slot_num == 1) return 0;
+
+    const size_t ep_num = ep_state_ptr_vec_.size();
+    const auto now = std::chrono::steady_clock::now();
+
+    // 轮询的起点，最少调用数策略下也从不同的起点开始扫描，使调用数相同的槽位被均匀选中
+    const size_t start_index = slot_rr_index_.fetch_add(1, std::memory_order_relaxed);
+
+    if (cfg_.lb_policy == LbPolicy::kRoundRobin) {
+      for (size_t ii = 0; ii < slot_num; ++ii) {
+        const size_t index = (start_index + ii) % slot_num;
+        if (ep_state_ptr_vec_[index % ep_num]->IsHealthy(now)) return index;
+      }
+      return start_index % slot_num;
+    }
+
+    size_t best_index = slot_num;
+    uint32_t best_pending_num = UINT32_MAX;
+    for (size_t ii = 0; ii < slot_num; ++ii) {
+      const size_t index = (start_index + ii) % slot_num;
+      const uint32_t pending_num = session_slot_vec_[index].pending_num.load(std::memory_order_relaxed);
+      if (pending_num < best_pending_num &&
+          !session_slot_vec_[index].connecting_flag_ptr->load(std::memory_order_relaxed) &&
+          ep_state_ptr_vec_[index % ep_num]->IsHealthy(now)) {
+        best_index = index;
+        best_pending_num = pending_num;
+        if (pending_num == 0) break;
+      }
+    }
+    if (best_index < slot_num) return best_index;
+
+    for (size_t ii = 0; ii < slot_num; ++ii) {
+      const size_t index = (start_index + ii) % slot_num;
+      const uint32_t pending_num = session_slot_vec_[index].pending_num.load(std::memory_order_relaxed);
+      if (pending_num < best_pending_num) {
+        best_index = index;
+        best_pending_num = pending_num;
+      }
+    }
+    return best_index;
+  }
+
+  // 调用方协程的完成回调，调用完成时在调用方的executor中恢复调用方协程
+  using DoneHandler = boost::asio::async_result<boost::asio::use_awaitable_t<>, void()>::handler_type;
+
+  // 调用上下文，位于调用方协程的栈帧中，等待回包期间直接挂在session的请求表与超时时间轮中
+  struct MsgContext : public PendingRequestHook {
     MsgContext(uint32_t input_req_id, const AsioRpcContext& input_ctx)
-        : req_id(input_req_id),
-          ctx(input_ctx) {}
+        : ctx(input_ctx) {
+      req_id = input_req_id;
+    }
 
     ~MsgContext() = default;
 
-    const uint32_t req_id;
     const AsioRpcContext& ctx;
 
     BufferVec req_buf_vec;
 
     AsioRpcStatus ret_status;
-    std::shared_ptr<char[]> read_buf_ptr;
-    const char* rsp_buf = nullptr;
-    uint32_t rsp_buf_len = 0;
+    RecvFrame rsp_frame;
     uint32_t rsp_pos = 0;
+
+    std::optional<DoneHandler> done_handler;
   };
 
   struct SessionCfg {
     SessionCfg(const Cfg& cfg)
-        : svr_ep(cfg.svr_ep),
+        : max_connect_fail_num(cfg.max_connect_fail_num),
+          max_call_fail_num(cfg.max_call_fail_num),
+          eject_time(cfg.eject_time),
           heart_beat_time(cfg.heart_beat_time),
-          max_recv_size(cfg.max_recv_size) {}
+          max_recv_size(cfg.max_recv_size),
+          send_coalesce_window(cfg.send_coalesce_window),
+          send_coalesce_size(cfg.send_coalesce_size) {}
 
-    boost::asio::ip::tcp::endpoint svr_ep;
+    uint32_t max_connect_fail_num;
+    uint32_t max_call_fail_num;
+    std::chrono::steady_clock::duration eject_time;
     std::chrono::steady_clock::duration heart_beat_time;
     uint32_t max_recv_size;
+    std::chrono::steady_clock::duration send_coalesce_window;
+    uint32_t send_coalesce_size;
   };
 
   class Session : public std::enable_shared_from_this<Session> {
    public:
     Session(const std::shared_ptr<boost::asio::io_context>& io_ptr,
-            const std::shared_ptr<const AsioRpcClient::SessionCfg>& session_cfg_ptr)
+            const std::shared_ptr<const AsioRpcClient::SessionCfg>& session_cfg_ptr,
+            const std::shared_ptr<AsioRpcClient::EpState>& ep_state_ptr,
+            const std::shared_ptr<std::atomic_bool>& connecting_flag_ptr)
         : session_cfg_ptr_(session_cfg_ptr),
+          ep_state_ptr_(ep_state_ptr),
+          connecting_flag_ptr_(connecting_flag_ptr),
           session_socket_strand_(boost::asio::make_strand(*io_ptr)),
           sock_(session_socket_strand_),
           send_sig_timer_(session_socket_strand_),
-          session_handle_strand_(boost::asio::make_strand(*io_ptr)) {}
+          deadline_timer_(session_socket_strand_) {}
 
     ~Session() = default;
 
     Session(const Session&) = delete;
     Session& operator=(const Session&) = delete;
 
+    /**
+     * @brief 发起调用并等待回包
+     * @note 只切换一次strand：在session_socket_strand_中登记请求并加入发送队列，
+     * 收到回包、超时或连接断开时直接恢复调用方协程。调用方需要持有session的智能指针直到调用完成
+     * @param[in] msg_ctx 调用上下文，结果写入其ret_status/rsp_frame/rsp_pos
+     * @return boost::asio::awaitable<void>
+     */
     boost::asio::awaitable<void> Invoke(MsgContext& msg_ctx) {
-      return boost::asio::co_spawn(
-          session_handle_strand_,
-          [this, &msg_ctx]() -> boost::asio::awaitable<void> {
-            MsgRecorder msg_recorder(msg_ctx, session_handle_strand_, msg_ctx.ctx.Deadline());
-            auto empalce_ret = msg_recorder_map_.emplace(msg_ctx.req_id, msg_recorder);
+      return boost::asio::async_initiate<decltype(boost::asio::use_awaitable), void()>(
+          [this](DoneHandler handler, MsgContext* msg_ctx_ptr) {
+            msg_ctx_ptr->done_handler.emplace(std::move(handler));
 
-            co_await boost::asio::co_spawn(
+            boost::asio::dispatch(
                 session_socket_strand_,
-                [this, &msg_ctx]() -> boost::asio::awaitable<void> {
-                  send_buffer_vec_.Merge(msg_ctx.req_buf_vec);
-                  send_sig_timer_.cancel();
-                  co_return;
-                },
-                boost::asio::use_awaitable);
+                [this, msg_ctx_ptr]() {
+                  if (!run_flag_) [[unlikely]] {
+                    msg_ctx_ptr->ret_status = AsioRpcStatus(AsioRpcStatus::Code::CLI_SESSION_CLOSED);
+                    Done(*msg_ctx_ptr);
+                    return;
+                  }
 
-            bool recv_flag = true;
-            try {
-              co_await msg_recorder.recv_sig_timer.async_wait(boost::asio::use_awaitable);
-              recv_flag = false;
-            } catch (const std::exception& e) {
-              DBG_PRINT("rpc cli session recv sig timer canceled, exception info: %s", e.what());
-            }
+                  pending_table_.Insert(msg_ctx_ptr);
 
-            if (!recv_flag) [[unlikely]] {
-              msg_ctx.ret_status = AsioRpcStatus(AsioRpcStatus::Code::TIMEOUT);
-            }
+                  // 截止时间早于超时检查协程当前等待的时间时，唤醒它重新等待
+                  const auto expire_time = deadline_wheel_.Insert(msg_ctx_ptr, ToSteadyDeadline(msg_ctx_ptr->ctx.Deadline()));
+                  if (expire_time < deadline_timer_.expiry()) deadline_timer_.cancel();
 
-            msg_recorder_map_.erase(empalce_ret.first);
-
-            co_return;
+                  PushSendBuffer(msg_ctx_ptr->req_buf_vec);
+                });
           },
-          boost::asio::use_awaitable);
+          boost::asio::use_awaitable, &msg_ctx);
     }
 
     void Start() {
@@ -261,9 +413,40 @@ class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
           [this, self]() -> boost::asio::awaitable<void> {
             ASIO_DEBUG_HANDLE(rpc_cli_session_start_co);
 
+            // 超时检查协程，建立连接期间发起的调用也需要按时超时
+            boost::asio::co_spawn(
+                session_socket_strand_,
+                [this, self]() -> boost::asio::awaitable<void> {
+                  ASIO_DEBUG_HANDLE(rpc_cli_session_deadline_co);
+
+                  while (run_flag_) {
+                    boost::system::error_code ec;
+                    deadline_timer_.expires_at(deadline_wheel_.NextExpireTime());
+                    co_await deadline_timer_.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+
+                    deadline_wheel_.Expire(std::chrono::steady_clock::now(), [this](MsgContext* msg_ctx_ptr) {
+                      pending_table_.Erase(msg_ctx_ptr->req_id);
+                      msg_ctx_ptr->ret_status = AsioRpcStatus(AsioRpcStatus::Code::TIMEOUT);
+                      Done(*msg_ctx_ptr);
+                    });
+                  }
+
+                  co_return;
+                },
+                boost::asio::detached);
+
             try {
-              DBG_PRINT("rpc cli session start create a new connect to %s", TcpEp2Str(session_cfg_ptr_->svr_ep).c_str());
-              co_await sock_.async_connect(session_cfg_ptr_->svr_ep, boost::asio::use_awaitable);
+              DBG_PRINT("rpc cli session start create a new connect to %s", TcpEp2Str(ep_state_ptr_->ep).c_str());
+
+              boost::system::error_code ec;
+              co_await sock_.async_connect(ep_state_ptr_->ep, boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+              if (ec != boost::asio::error::operation_aborted)
+                ep_state_ptr_->OnConnect(!ec, session_cfg_ptr_->max_connect_fail_num, session_cfg_ptr_->eject_time);
+              connecting_flag_ptr_->store(false, std::memory_order_relaxed);
+              if (ec) throw boost::system::system_error(ec);
+
+              // 发送协程自行合并小包，不需要Nagle算法
+              sock_.set_option(boost::asio::ip::tcp::no_delay(true));
 
               // 发送协程
               boost::asio::co_spawn(
@@ -272,23 +455,34 @@ class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
                     ASIO_DEBUG_HANDLE(rpc_cli_session_send_co);
 
                     try {
+                      AsioBufferVecWriter writer;
+
                       while (run_flag_) {
                         while (!send_buffer_vec_.Vec().empty()) {
+                          // 在合并窗口内等待更多的包，窗口结束或积累的数据足够多时一起发送
+                          if (session_cfg_ptr_->send_coalesce_window > std::chrono::steady_clock::duration::zero() &&
+                              send_buffer_size_ < session_cfg_ptr_->send_coalesce_size &&
+                              send_buffer_vec_.Vec().size() < AsioBufferVecWriter::kMaxIovNum) {
+                            send_co_state_ = SendCoState::kCoalescing;
+                            try {
+                              send_sig_timer_.expires_after(session_cfg_ptr_->send_coalesce_window);
+                              co_await send_sig_timer_.async_wait(boost::asio::use_awaitable);
+                            } catch (const std::exception& e) {
+                              DBG_PRINT("rpc cli session coalesce timer canceled, exception info: %s", e.what());
+                            }
+                            send_co_state_ = SendCoState::kSending;
+                          }
+
                           BufferVec tmp_send_buffer_vec;
                           tmp_send_buffer_vec.Swap(send_buffer_vec_);
+                          send_buffer_size_ = 0;
 
-                          const auto& buffer_vec = tmp_send_buffer_vec.Vec();
-                          std::vector<boost::asio::const_buffer> asio_const_buffer_vec;
-                          asio_const_buffer_vec.reserve(buffer_vec.size());
-                          for (const auto& buffer : buffer_vec) {
-                            asio_const_buffer_vec.emplace_back(buffer.first, buffer.second);
-                          }
-
-                          size_t write_data_size = co_await boost::asio::async_write(sock_, asio_const_buffer_vec, boost::asio::use_awaitable);
+                          size_t write_data_size = co_await writer.AsyncWrite(sock_, tmp_send_buffer_vec.Vec());
                           DBG_PRINT("rpc cli session async write %llu bytes", write_data_size);
                         }
 
                         bool heartbeat_flag = false;
+                        send_co_state_ = SendCoState::kIdle;
                         try {
                           send_sig_timer_.expires_after(session_cfg_ptr_->heart_beat_time);
                           co_await send_sig_timer_.async_wait(boost::asio::use_awaitable);
@@ -296,6 +490,7 @@ class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
                         } catch (const std::exception& e) {
                           DBG_PRINT("rpc cli session timer canceled, exception info: %s", e.what());
                         }
+                        send_co_state_ = SendCoState::kSending;
 
                         if (heartbeat_flag) {
                           // 心跳包仅用来保活，不传输业务/管理信息
@@ -310,6 +505,9 @@ class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
                       DBG_PRINT("rpc cli session send co get exception and exit, exception info: %s", e.what());
                     }
 
+                    // 不是主动停止时，连接异常断开计为一次调用失败
+                    if (run_flag_) ep_state_ptr_->OnCall(false, session_cfg_ptr_->max_call_fail_num, session_cfg_ptr_->eject_time);
+
                     Stop();
 
                     co_return;
@@ -323,109 +521,79 @@ class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
                     ASIO_DEBUG_HANDLE(rpc_cli_session_recv_co);
 
                     try {
-                      constexpr uint32_t min_read_buf_size = 256;
-                      uint32_t read_buf_size = min_read_buf_size;
-                      uint32_t read_buf_offset = 0;
-                      std::shared_ptr<char[]> read_buf_ptr = std::make_shared<char[]>(read_buf_size);
+                      RecvBuffer recv_buffer;
+                      std::vector<boost::asio::mutable_buffer> read_buf_vec;
+                      size_t next_read_size = 0;  // 当前不完整的包还需要接收的大小
+                      size_t last_pkg_size = 0;   // 上一个包的大小，用于预估本次需要准备的空间
 
                       while (run_flag_) {
-                        // 接收数据
-                        size_t read_data_size = co_await boost::asio::async_read(
-                            sock_, boost::asio::mutable_buffer(read_buf_ptr.get() + read_buf_offset, read_buf_size - read_buf_offset),
-                            [&](const boost::system::error_code& error, size_t bytes_transferred) -> size_t {
-                              if (error) [[unlikely]]
-                                return 0;
-
-                              bytes_transferred += read_buf_offset;  // buf中实际已经有的数据大小
-                              if (bytes_transferred < HEAD_SIZE) return read_buf_size - bytes_transferred;
-                              if (read_buf_ptr[0] != HEAD_BYTE_1 || read_buf_ptr[1] != HEAD_BYTE_2) return 0;
-                              if (bytes_transferred < (HEAD_SIZE + GetUint32FromBuf(read_buf_ptr.get() + 4))) return read_buf_size - bytes_transferred;
-                              return 0;
-                            },
-                            boost::asio::use_awaitable);
-                        DBG_PRINT("rpc cli session async read %llu bytes", read_data_size);
-
-                        read_data_size += read_buf_offset;  // buf中实际数据大小
+                        // 接收数据，直接分散写入接收缓冲区的内存块中
+                        read_buf_vec.clear();
+                        for (const auto& buf : recv_buffer.PrepareBuffer(std::max(next_read_size, last_pkg_size)))
+                          read_buf_vec.emplace_back(buf.first, buf.second);
 
-                        // 根据本次数据接收情况决定下次数据buf大小
-                        if (read_data_size < read_buf_size / 2) {
-                          read_buf_size = std::max(min_read_buf_size, read_buf_size / 2);
-                        } else if (read_data_size >= read_buf_size) {
-                          read_buf_size = std::min(session_cfg_ptr_->max_recv_size, read_buf_size * 2);
-                        }
+                        size_t read_data_size = co_await sock_.async_read_some(
+                            std::span<const boost::asio::mutable_buffer>(read_buf_vec), boost::asio::use_awaitable);
+                        DBG_PRINT("rpc cli session async read %llu bytes", read_data_size);
 
-                        uint32_t cur_handle_pos = 0;
-                        while (true) {
-                          const uint32_t cur_unhandle_size = read_data_size - cur_handle_pos;
+                        recv_buffer.Commit(read_data_size);
+                        next_read_size = 0;
 
-                          if (cur_unhandle_size < HEAD_SIZE) break;
+                        while (recv_buffer.Size() >= HEAD_SIZE) {
+                          char head_buf[HEAD_SIZE];
+                          recv_buffer.Peek(head_buf, HEAD_SIZE);
 
-                          if (read_buf_ptr[cur_handle_pos] != HEAD_BYTE_1 || read_buf_ptr[cur_handle_pos + 1] != HEAD_BYTE_2) [[unlikely]]
+                          if (head_buf[0] != HEAD_BYTE_1 || head_buf[1] != HEAD_BYTE_2) [[unlikely]]
                             throw std::runtime_error("Get an invalid head.");
 
                           // pb包头+pb业务包大小
-                          const uint32_t pb_msg_len = GetUint32FromBuf(read_buf_ptr.get() + cur_handle_pos + 4);
+                          const uint32_t pb_msg_len = GetUint32FromBuf(head_buf + 4);
 
                           if ((HEAD_SIZE + pb_msg_len) > session_cfg_ptr_->max_recv_size) [[unlikely]]
                             throw std::runtime_error("Msg too large.");
 
-                          // 如果HEAD_SIZE + pb_msg_len大于read_buf_size，则下次接收时buf会扩大
-                          if (cur_unhandle_size < (HEAD_SIZE + pb_msg_len)) {
-                            read_buf_size = std::max(read_buf_size, (HEAD_SIZE + pb_msg_len));
+                          if (recv_buffer.Size() < (HEAD_SIZE + pb_msg_len)) {
+                            next_read_size = HEAD_SIZE + pb_msg_len - recv_buffer.Size();
                             break;
                           }
 
-                          const char* rsp_buf = read_buf_ptr.get() + cur_handle_pos + HEAD_SIZE;
-                          const uint16_t pb_head_len = GetUint16FromBuf(read_buf_ptr.get() + cur_handle_pos + 2);
-
-                          boost::asio::post(
-                              session_handle_strand_,
-                              [this, self, read_buf_ptr, rsp_buf, pb_head_len, pb_msg_len]() {
-                                ASIO_DEBUG_HANDLE(rpc_cli_session_recv_handle_co);
-
-                                try {
-                                  RspHead rsp_head;
-                                  if (!rsp_head.ParseFromArray(rsp_buf, pb_head_len)) [[unlikely]]
-                                    throw std::runtime_error("Parse rsp head failed.");
-
-                                  auto finditr = msg_recorder_map_.find(rsp_head.req_id());
-                                  if (finditr == msg_recorder_map_.end()) [[unlikely]] {
-                                    DBG_PRINT("rpc cli session get a no owner pkg, req id:", rsp_head.req_id());
-                                    return;
-                                  }
-
-                                  finditr->second.msg_ctx.ret_status = AsioRpcStatus(
-                                      static_cast<AsioRpcStatus::Code>(rsp_head.ret_code()),
-                                      rsp_head.func_ret_code(),
-                                      rsp_head.func_ret_msg());
-                                  finditr->second.msg_ctx.read_buf_ptr = read_buf_ptr;
-                                  finditr->second.msg_ctx.rsp_buf = rsp_buf;
-                                  finditr->second.msg_ctx.rsp_buf_len = pb_msg_len;
-                                  finditr->second.msg_ctx.rsp_pos = pb_head_len;
-                                  finditr->second.recv_sig_timer.cancel();
-                                } catch (const std::exception& e) {
-                                  DBG_PRINT("rpc cli session recv handle co get exception and exit, exception info: %s", e.what());
-                                }
-                              });
-
-                          cur_handle_pos += (HEAD_SIZE + pb_msg_len);
-                        }
+                          const uint16_t pb_head_len = GetUint16FromBuf(head_buf + 2);
 
-                        read_buf_offset = read_data_size - cur_handle_pos;
+                          // 数据帧持有其所在内存块的引用，跨内存块时也不需要拷贝
+                          last_pkg_size = HEAD_SIZE + pb_msg_len;
+                          recv_buffer.Consume(HEAD_SIZE);
+                          RecvFrame rsp_frame = recv_buffer.PopFrame(pb_msg_len);
 
-                        if (read_buf_offset) {
-                          // todo：考虑使用vectorbuf，不用拷贝一次
-                          std::shared_ptr<char[]> last_read_buf_ptr = read_buf_ptr;
-                          read_buf_ptr = std::make_shared<char[]>(read_buf_size);
-                          memcpy(read_buf_ptr.get(), last_read_buf_ptr.get() + cur_handle_pos, read_buf_offset);
-                        } else {
-                          read_buf_ptr = std::make_shared<char[]>(read_buf_size);
+                          RspHead rsp_head;
+                          BufferVecZeroCopyInputStream rsp_head_is(rsp_frame.Vec());
+                          if (!rsp_head.ParseFromBoundedZeroCopyStream(&rsp_head_is, pb_head_len)) [[unlikely]] {
+                            DBG_PRINT("rpc cli session parse rsp head failed");
+                            continue;
+                          }
+
+                          MsgContext* msg_ctx_ptr = pending_table_.Erase(rsp_head.req_id());
+                          if (msg_ctx_ptr == nullptr) [[unlikely]] {
+                            DBG_PRINT("rpc cli session get a no owner pkg, req id: %u", rsp_head.req_id());
+                            continue;
+                          }
+                          deadline_wheel_.Remove(msg_ctx_ptr);
+
+                          msg_ctx_ptr->ret_status = AsioRpcStatus(
+                              static_cast<AsioRpcStatus::Code>(rsp_head.ret_code()),
+                              rsp_head.func_ret_code(),
+                              rsp_head.func_ret_msg());
+                          msg_ctx_ptr->rsp_frame = std::move(rsp_frame);
+                          msg_ctx_ptr->rsp_pos = pb_head_len;
+                          Done(*msg_ctx_ptr);
                         }
                       }
                     } catch (const std::exception& e) {
                       DBG_PRINT("rpc cli session recv co get exception and exit, exception info: %s", e.what());
                     }
 
+                    // 不是主动停止时，连接异常断开计为一次调用失败
+                    if (run_flag_) ep_state_ptr_->OnCall(false, session_cfg_ptr_->max_call_fail_num, session_cfg_ptr_->eject_time);
+
                     Stop();
 
                     co_return;
@@ -459,15 +627,18 @@ class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
                     send_sig_timer_.cancel();
                     ++stop_step;
                   case 2:
-                    sock_.shutdown(boost::asio::ip::tcp::socket::shutdown_both);
+                    deadline_timer_.cancel();
                     ++stop_step;
                   case 3:
-                    sock_.cancel();
+                    sock_.shutdown(boost::asio::ip::tcp::socket::shutdown_both);
                     ++stop_step;
                   case 4:
-                    sock_.close();
+                    sock_.cancel();
                     ++stop_step;
                   case 5:
+                    sock_.close();
+                    ++stop_step;
+                  case 6:
                     sock_.release();
                     ++stop_step;
                   default:
@@ -479,34 +650,81 @@ class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
                 ++stop_step;
               }
             }
+
+            // 连接已断开，未完成的调用不再等待超时
+            pending_table_.Clear([this](MsgContext* msg_ctx_ptr) {
+              deadline_wheel_.Remove(msg_ctx_ptr);
+              msg_ctx_ptr->ret_status = AsioRpcStatus(AsioRpcStatus::Code::CLI_SESSION_CLOSED);
+              Done(*msg_ctx_ptr);
+            });
           });
     }
 
     const std::atomic_bool& IsRunning() { return run_flag_; }
 
    private:
-    struct MsgRecorder {
-      MsgRecorder(MsgContext& input_msg_ctx,
-                  const boost::asio::strand<boost::asio::io_context::executor_type>& session_strand,
-                  const std::chrono::system_clock::time_point& ddl)
-          : msg_ctx(input_msg_ctx),
-            recv_sig_timer(session_strand, ddl) {}
-      ~MsgRecorder() = default;
-
-      MsgContext& msg_ctx;
-      boost::asio::system_timer recv_sig_timer;
+    // 发送协程的状态
+    enum class SendCoState {
+      kSending,     // 正在发送，新加入的包会在本次发送完成后继续发送，不需要唤醒
+      kCoalescing,  // 正在合并窗口内等待，积累的数据足够多时需要唤醒
+      kIdle,        // 空闲，有新的包时需要唤醒
     };
 
+    // 将待发送的数据加入发送队列，必要时唤醒发送协程，需要在session_socket_strand_中调用
+    void PushSendBuffer(BufferVec& buffer_vec) {
+      for (const auto& buffer : buffer_vec.Vec()) {
+        send_buffer_size_ += buffer.second;
+      }
+      send_buffer_vec_.Merge(buffer_vec);
+
+      if (send_co_state_ == SendCoState::kIdle ||
+          (send_co_state_ == SendCoState::kCoalescing &&
+           (send_buffer_size_ >= session_cfg_ptr_->send_coalesce_size || send_buffer_vec_.Vec().size() >= AsioBufferVecWriter::kMaxIovNum))) {
+        send_co_state_ = SendCoState::kSending;
+        send_sig_timer_.cancel();
+      }
+    }
+
+    // 完成调用，在调用方的executor中恢复调用方协程。调用方随时可能销毁msg_ctx，之后不能再访问
+    static void Done(MsgContext& msg_ctx) {
+      DoneHandler handler(std::move(*msg_ctx.done_handler));
+      msg_ctx.done_handler.reset();
+      boost::asio::post(std::move(handler));
+    }
+
+    // 将调用的截止时间转换为steady_clock的时间点，没有截止时间时返回time_point::max()
+    static std::chrono::steady_clock::time_point ToSteadyDeadline(const std::chrono::system_clock::time_point& ddl) {
+      if (ddl == std::chrono::system_clock::time_point::max()) return std::chrono::steady_clock::time_point::max();
+
+      const auto steady_now = std::chrono::steady_clock::now();
+      const auto left_time = std::chrono::duration_cast<std::chrono::steady_clock::duration>(ddl - std::chrono::system_clock::now());
+      if (left_time >= std::chrono::steady_clock::time_point::max() - steady_now) return std::chrono::steady_clock::time_point::max();
+      return steady_now + left_time;
+    }
+
     std::shared_ptr<const AsioRpcClient::SessionCfg> session_cfg_ptr_;
+    std::shared_ptr<AsioRpcClient::EpState> ep_state_ptr_;
+    std::shared_ptr<std::atomic_bool> connecting_flag_ptr_;  // 所在槽位是否正在建立连接，与槽位共享
     std::atomic_bool run_flag_ = true;
 
     boost::asio::strand<boost::asio::io_context::executor_type> session_socket_strand_;
     boost::asio::ip::tcp::socket sock_;
     boost::asio::steady_timer send_sig_timer_;
+    SendCoState send_co_state_ = SendCoState::kSending;
     BufferVec send_buffer_vec_;
+    size_t send_buffer_size_ = 0;
+
+    // 等待回包的调用，只在session_socket_strand_中访问
+    PendingRequestTable<MsgContext> pending_table_;
+    DeadlineWheel<MsgContext> deadline_wheel_;
+    boost::asio::steady_timer deadline_timer_;
+  };
 
-    boost::asio::strand<boost::asio::io_context::executor_type> session_handle_strand_;
-    std::unordered_map<uint32_t, MsgRecorder&> msg_recorder_map_;
+  // 连接槽位，第ii个槽位连接第(ii % 服务端地址数)个服务端地址
+  struct SessionSlot {
+    std::shared_ptr<AsioRpcClient::Session> session_ptr;  // 使用std::atomic_load/std::atomic_store访问
+    std::atomic_uint32_t pending_num = 0;                 // 正在进行的调用数
+    std::shared_ptr<std::atomic_bool> connecting_flag_ptr = std::make_shared<std::atomic_bool>(false);  // 是否正在建立连接
   };
 
  private:
@@ -516,7 +734,9 @@ class AsioRpcClient : public std::enable_shared_from_this<AsioRpcClient> {
   std::shared_ptr<const AsioRpcClient::SessionCfg> session_cfg_ptr_;
 
   boost::asio::strand<boost::asio::io_context::executor_type> mgr_strand_;
-  std::shared_ptr<AsioRpcClient::Session> session_ptr_;
+  std::vector<std::shared_ptr<AsioRpcClient::EpState>> ep_state_ptr_vec_;
+  std::vector<AsioRpcClient::SessionSlot> session_slot_vec_;
+  std::atomic_size_t slot_rr_index_ = 0;
 
   std::atomic_uint32_t req_id_ = 0;
 };
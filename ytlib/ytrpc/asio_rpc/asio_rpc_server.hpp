@@ -11,8 +11,10 @@
 #include <concepts>
 #include <list>
 #include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/asio.hpp>
 
@@ -20,9 +22,11 @@
 #include "ytlib/boost_tools_asio/net_util.hpp"
 #include "ytlib/misc/misc_macro.h"
 
+#include "asio_buffer_vec_writer.hpp"
 #include "asio_rpc_context.hpp"
 #include "asio_rpc_status.hpp"
 #include "ytlib/ytrpc/rpc_util/buffer.hpp"
+#include "ytlib/ytrpc/rpc_util/recv_buffer.hpp"
 
 #include "Head.pb.h"
 
@@ -79,6 +83,8 @@ class AsioRpcServer : public std::enable_shared_from_this<AsioRpcServer> {
     std::chrono::steady_clock::duration mgr_timer_dt = std::chrono::seconds(10);                               // 管理协程定时器间隔
     std::chrono::steady_clock::duration max_no_data_duration = std::chrono::seconds(300);                      // 最长无数据时间
     uint32_t max_recv_size = 1024 * 1024 * 10;                                                                 // 包最大尺寸，最大10m
+    std::chrono::steady_clock::duration send_coalesce_window = {};                                             // 发送合并窗口，为0时只合并发送协程忙碌期间积累的包
+    uint32_t send_coalesce_size = 64 * 1024;                                                                   // 合并窗口内积累的数据达到此大小时立即发送
 
     /// 校验配置
     static Cfg Verify(const Cfg& verify_cfg) {
@@ -91,6 +97,10 @@ class AsioRpcServer : public std::enable_shared_from_this<AsioRpcServer> {
 
       if (cfg.max_no_data_duration < std::chrono::seconds(10)) cfg.max_no_data_duration = std::chrono::seconds(10);
 
+      if (cfg.send_coalesce_window < std::chrono::steady_clock::duration::zero()) cfg.send_coalesce_window = std::chrono::steady_clock::duration::zero();
+      if (cfg.send_coalesce_window > std::chrono::milliseconds(100)) cfg.send_coalesce_window = std::chrono::milliseconds(100);
+      if (cfg.send_coalesce_size < 1) cfg.send_coalesce_size = 1;
+
       return cfg;
     }
   };
@@ -258,10 +268,14 @@ class AsioRpcServer : public std::enable_shared_from_this<AsioRpcServer> {
   struct SessionCfg {
     SessionCfg(const Cfg& cfg)
         : max_no_data_duration(cfg.max_no_data_duration),
-          max_recv_size(cfg.max_recv_size) {}
+          max_recv_size(cfg.max_recv_size),
+          send_coalesce_window(cfg.send_coalesce_window),
+          send_coalesce_size(cfg.send_coalesce_size) {}
 
     std::chrono::steady_clock::duration max_no_data_duration;
     uint32_t max_recv_size;
+    std::chrono::steady_clock::duration send_coalesce_window;
+    uint32_t send_coalesce_size;
   };
 
   class Session : public std::enable_shared_from_this<Session> {
@@ -286,6 +300,13 @@ class AsioRpcServer : public std::enable_shared_from_this<AsioRpcServer> {
     void Start() {
       auto self = shared_from_this();
 
+      // 发送协程自行合并小包，不需要Nagle算法
+      boost::system::error_code ec;
+      sock_.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+      if (ec) {
+        DBG_PRINT("rpc svr session set no delay failed, error info: %s", ec.message().c_str());
+      }
+
       // 发送协程
       boost::asio::co_spawn(
           session_socket_strand_,
@@ -293,28 +314,40 @@ class AsioRpcServer : public std::enable_shared_from_this<AsioRpcServer> {
             ASIO_DEBUG_HANDLE(rpc_svr_session_send_co);
 
             try {
+              AsioBufferVecWriter writer;
+
               while (run_flag_) {
                 while (!send_buffer_vec_.Vec().empty()) {
+                  // 在合并窗口内等待更多的包，窗口结束或积累的数据足够多时一起发送
+                  if (session_cfg_ptr_->send_coalesce_window > std::chrono::steady_clock::duration::zero() &&
+                      send_buffer_size_ < session_cfg_ptr_->send_coalesce_size &&
+                      send_buffer_vec_.Vec().size() < AsioBufferVecWriter::kMaxIovNum) {
+                    send_co_state_ = SendCoState::kCoalescing;
+                    try {
+                      send_sig_timer_.expires_after(session_cfg_ptr_->send_coalesce_window);
+                      co_await send_sig_timer_.async_wait(boost::asio::use_awaitable);
+                    } catch (const std::exception& e) {
+                      DBG_PRINT("rpc svr session coalesce timer canceled, exception info: %s", e.what());
+                    }
+                    send_co_state_ = SendCoState::kSending;
+                  }
+
                   BufferVec tmp_send_buffer_vec;
                   tmp_send_buffer_vec.Swap(send_buffer_vec_);
+                  send_buffer_size_ = 0;
 
-                  const auto& buffer_vec = tmp_send_buffer_vec.Vec();
-                  std::vector<boost::asio::const_buffer> asio_const_buffer_vec;
-                  asio_const_buffer_vec.reserve(buffer_vec.size());
-                  for (const auto& buffer : buffer_vec) {
-                    asio_const_buffer_vec.emplace_back(buffer.first, buffer.second);
-                  }
-
-                  size_t write_data_size = co_await boost::asio::async_write(sock_, asio_const_buffer_vec, boost::asio::use_awaitable);
+                  size_t write_data_size = co_await writer.AsyncWrite(sock_, tmp_send_buffer_vec.Vec());
                   DBG_PRINT("rpc svr session async write %llu bytes", write_data_size);
                 }
 
+                send_co_state_ = SendCoState::kIdle;
                 try {
                   send_sig_timer_.expires_at(std::chrono::steady_clock::time_point::max());
                   co_await send_sig_timer_.async_wait(boost::asio::use_awaitable);
                 } catch (const std::exception& e) {
                   DBG_PRINT("rpc svr session timer canceled, exception info: %s", e.what());
                 }
+                send_co_state_ = SendCoState::kSending;
               }
             } catch (const std::exception& e) {
               DBG_PRINT("rpc svr session send co get exception and exit, exception info: %s", e.what());
@@ -333,73 +366,62 @@ class AsioRpcServer : public std::enable_shared_from_this<AsioRpcServer> {
             ASIO_DEBUG_HANDLE(rpc_svr_session_recv_co);
 
             try {
-              constexpr uint32_t min_read_buf_size = 256;
-              uint32_t read_buf_size = min_read_buf_size;
-              uint32_t read_buf_offset = 0;
-              std::shared_ptr<char[]> read_buf_ptr = std::make_shared<char[]>(read_buf_size);
+              RecvBuffer recv_buffer;
+              std::vector<boost::asio::mutable_buffer> read_buf_vec;
+              size_t next_read_size = 0;  // 当前不完整的包还需要接收的大小
+              size_t last_pkg_size = 0;   // 上一个包的大小，用于预估本次需要准备的空间
 
               while (run_flag_) {
-                // 接收数据
-                size_t read_data_size = co_await boost::asio::async_read(
-                    sock_, boost::asio::mutable_buffer(read_buf_ptr.get() + read_buf_offset, read_buf_size - read_buf_offset),
-                    [&](const boost::system::error_code& error, size_t bytes_transferred) -> size_t {
-                      if (error) [[unlikely]]
-                        return 0;
-
-                      bytes_transferred += read_buf_offset;  // buf中实际已经有的数据大小
-                      if (bytes_transferred < HEAD_SIZE) return read_buf_size - bytes_transferred;
-                      if (read_buf_ptr[0] != HEAD_BYTE_1 || read_buf_ptr[1] != HEAD_BYTE_2) return 0;
-                      if (bytes_transferred < (HEAD_SIZE + GetUint32FromBuf(read_buf_ptr.get() + 4))) return read_buf_size - bytes_transferred;
-                      return 0;
-                    },
-                    boost::asio::use_awaitable);
+                // 接收数据，直接分散写入接收缓冲区的内存块中
+                read_buf_vec.clear();
+                for (const auto& buf : recv_buffer.PrepareBuffer(std::max(next_read_size, last_pkg_size)))
+                  read_buf_vec.emplace_back(buf.first, buf.second);
+
+                size_t read_data_size = co_await sock_.async_read_some(
+                    std::span<const boost::asio::mutable_buffer>(read_buf_vec), boost::asio::use_awaitable);
                 DBG_PRINT("rpc svr session async read %llu bytes", read_data_size);
                 tick_has_data_ = true;
 
-                read_data_size += read_buf_offset;  // buf中实际数据大小
+                recv_buffer.Commit(read_data_size);
+                next_read_size = 0;
 
-                // 根据本次数据接收情况决定下次数据buf大小
-                if (read_data_size < read_buf_size / 2) {
-                  read_buf_size = std::max(min_read_buf_size, read_buf_size / 2);
-                } else if (read_data_size >= read_buf_size) {
-                  read_buf_size = std::min(session_cfg_ptr_->max_recv_size, read_buf_size * 2);
-                }
-
-                uint32_t cur_handle_pos = 0;
-                while (true) {
-                  const uint32_t cur_unhandle_size = read_data_size - cur_handle_pos;
-
-                  if (cur_unhandle_size < HEAD_SIZE) break;
+                while (recv_buffer.Size() >= HEAD_SIZE) {
+                  char head_buf[HEAD_SIZE];
+                  recv_buffer.Peek(head_buf, HEAD_SIZE);
 
-                  if (read_buf_ptr[cur_handle_pos] != HEAD_BYTE_1 || read_buf_ptr[cur_handle_pos + 1] != HEAD_BYTE_2) [[unlikely]]
+                  if (head_buf[0] != HEAD_BYTE_1 || head_buf[1] != HEAD_BYTE_2) [[unlikely]]
                     throw std::runtime_error("Get an invalid head.");
 
                   // pb包头+pb业务包大小
-                  const uint32_t pb_msg_len = GetUint32FromBuf(read_buf_ptr.get() + cur_handle_pos + 4);
+                  const uint32_t pb_msg_len = GetUint32FromBuf(head_buf + 4);
 
                   // msg长度为0表示是心跳包
                   if (pb_msg_len == 0) [[unlikely]] {
-                    cur_handle_pos += HEAD_SIZE;
+                    recv_buffer.Consume(HEAD_SIZE);
                     continue;
                   }
 
                   if ((HEAD_SIZE + pb_msg_len) > session_cfg_ptr_->max_recv_size) [[unlikely]]
                     throw std::runtime_error("Msg too large.");
 
-                  // 如果HEAD_SIZE + pb_msg_len大于read_buf_size，则下次接收时buf会扩大
-                  if (cur_unhandle_size < (HEAD_SIZE + pb_msg_len)) {
-                    read_buf_size = std::max(read_buf_size, (HEAD_SIZE + pb_msg_len));
+                  if (recv_buffer.Size() < (HEAD_SIZE + pb_msg_len)) {
+                    next_read_size = HEAD_SIZE + pb_msg_len - recv_buffer.Size();
                     break;
                   }
 
-                  const char* req_buf = read_buf_ptr.get() + cur_handle_pos + HEAD_SIZE;
-                  const uint16_t pb_head_len = GetUint16FromBuf(read_buf_ptr.get() + cur_handle_pos + 2);
+                  const uint16_t pb_head_len = GetUint16FromBuf(head_buf + 2);
+
+                  // 数据帧持有其所在内存块的引用，跨内存块时也不需要拷贝
+                  last_pkg_size = HEAD_SIZE + pb_msg_len;
+                  recv_buffer.Consume(HEAD_SIZE);
+                  RecvFrame req_frame = recv_buffer.PopFrame(pb_msg_len);
 
                   // 处理数据，需要post到整个io_ctx上
-                  auto handle = [this, self, read_buf_ptr, req_buf, pb_head_len, pb_msg_len]() -> boost::asio::awaitable<void> {
+                  auto handle = [this, self, req_frame{std::move(req_frame)}, pb_head_len]() -> boost::asio::awaitable<void> {
                     try {
                       ReqHead req_head;
-                      if (!req_head.ParseFromArray(req_buf, pb_head_len)) [[unlikely]]
+                      BufferVecZeroCopyInputStream req_head_is(req_frame.Vec());
+                      if (!req_head.ParseFromBoundedZeroCopyStream(&req_head_is, pb_head_len)) [[unlikely]]
                         throw std::runtime_error("Parse req head failed.");
 
                       BufferVec rsp_buf_vec;
@@ -419,7 +441,8 @@ class AsioRpcServer : public std::enable_shared_from_this<AsioRpcServer> {
                         // 调用func
                         const AsioRpcService::FuncAdapter& func_adapter = finditr->second;
                         std::unique_ptr<google::protobuf::Message> req_ptr = func_adapter.req_ptr_gener();
-                        if (!req_ptr->ParseFromArray(req_buf + pb_head_len, pb_msg_len - pb_head_len)) [[unlikely]] {
+                        BufferVecZeroCopyInputStream req_is(req_frame.Vec());
+                        if (!req_is.Skip(pb_head_len) || !req_ptr->ParseFromZeroCopyStream(&req_is)) [[unlikely]] {
                           rsp_head.set_ret_code(static_cast<int32_t>(AsioRpcStatus::Code::SVR_PARSE_REQ_FAILED));
                         } else {
                           std::shared_ptr<AsioRpcContext> ctx_ptr = std::make_shared<AsioRpcContext>();
@@ -451,8 +474,7 @@ class AsioRpcServer : public std::enable_shared_from_this<AsioRpcServer> {
                       boost::asio::dispatch(
                           session_socket_strand_,
                           [this, self, rsp_buf_vec{std::move(rsp_buf_vec)}]() mutable {
-                            send_buffer_vec_.Merge(rsp_buf_vec);
-                            send_sig_timer_.cancel();
+                            PushSendBuffer(rsp_buf_vec);
                           });
 
                     } catch (const std::exception& e) {
@@ -470,19 +492,6 @@ class AsioRpcServer : public std::enable_shared_from_this<AsioRpcServer> {
                             std::move(handle),
                             boost::asio::detached);
                       });
-
-                  cur_handle_pos += (HEAD_SIZE + pb_msg_len);
-                }
-
-                read_buf_offset = read_data_size - cur_handle_pos;
-
-                if (read_buf_offset) {
-                  // todo：考虑使用vectorbuf，不用拷贝一次
-                  std::shared_ptr<char[]> last_read_buf_ptr = read_buf_ptr;
-                  read_buf_ptr = std::make_shared<char[]>(read_buf_size);
-                  memcpy(read_buf_ptr.get(), last_read_buf_ptr.get() + cur_handle_pos, read_buf_offset);
-                } else {
-                  read_buf_ptr = std::make_shared<char[]>(read_buf_size);
                 }
               }
             } catch (const std::exception& e) {
@@ -595,6 +604,28 @@ class AsioRpcServer : public std::enable_shared_from_this<AsioRpcServer> {
     const std::atomic_bool& IsRunning() { return run_flag_; }
 
    private:
+    // 发送协程的状态
+    enum class SendCoState {
+      kSending,     // 正在发送，新加入的包会在本次发送完成后继续发送，不需要唤醒
+      kCoalescing,  // 正在合并窗口内等待，积累的数据足够多时需要唤醒
+      kIdle,        // 空闲，有新的包时需要唤醒
+    };
+
+    // 将待发送的数据加入发送队列，必要时唤醒发送协程，需要在session_socket_strand_中调用
+    void PushSendBuffer(BufferVec& buffer_vec) {
+      for (const auto& buffer : buffer_vec.Vec()) {
+        send_buffer_size_ += buffer.second;
+      }
+      send_buffer_vec_.Merge(buffer_vec);
+
+      if (send_co_state_ == SendCoState::kIdle ||
+          (send_co_state_ == SendCoState::kCoalescing &&
+           (send_buffer_size_ >= session_cfg_ptr_->send_coalesce_size || send_buffer_vec_.Vec().size() >= AsioBufferVecWriter::kMaxIovNum))) {
+        send_co_state_ = SendCoState::kSending;
+        send_sig_timer_.cancel();
+      }
+    }
+
     std::shared_ptr<const AsioRpcServer::SessionCfg> session_cfg_ptr_;
     std::atomic_bool run_flag_ = true;
     std::shared_ptr<boost::asio::io_context> io_ptr_;
@@ -607,7 +638,9 @@ class AsioRpcServer : public std::enable_shared_from_this<AsioRpcServer> {
     boost::asio::steady_timer timer_;
 
     std::atomic_bool tick_has_data_ = false;
+    SendCoState send_co_state_ = SendCoState::kSending;
     BufferVec send_buffer_vec_;
+    size_t send_buffer_size_ = 0;
 
     const std::shared_ptr<const std::unordered_map<std::string, AsioRpcService::FuncAdapter>> func_map_ptr_;
   };
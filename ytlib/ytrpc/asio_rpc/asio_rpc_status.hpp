@@ -22,6 +22,7 @@ class AsioRpcStatus {
     // cli side
     CLI_PARSE_RSP_FAILED,  // 客户端解析rsp包出错
     CLI_IS_NOT_RUNNING,    // 客户端已关闭
+    CLI_SESSION_CLOSED,    // 等待回包时连接已断开
 
     MAX_NUM,
   };
@@ -1,21 +1,28 @@
 #pragma once
 
-#include <cstdlib>
+#include <algorithm>
 #include <memory>
+#include <span>
 #include <vector>
 
 #include <google/protobuf/io/zero_copy_stream.h>
 
+#include "buffer_pool.hpp"
+
 namespace ytlib {
 namespace ytrpc {
 
+/**
+ * @brief 多段内存组成的缓冲区
+ * @note 各段内存从BufferPool申请，析构时归还，可以在与申请时不同的线程中析构
+ */
 class BufferVec {
  public:
   BufferVec() = default;
 
   ~BufferVec() {
     for (auto& buffer : buffer_vec_) {
-      std::free(buffer.first);
+      BufferPool::Deallocate(buffer.first);
     }
   }
 
@@ -39,7 +46,7 @@ class BufferVec {
   }
 
   const std::pair<void*, size_t>& NewBuffer(size_t buf_size) {
-    return buffer_vec_.emplace_back(std::malloc(buf_size), buf_size);
+    return buffer_vec_.emplace_back(BufferPool::Allocate(buf_size), buf_size);
   }
 
   const std::pair<void*, size_t>& CurBuffer() const {
@@ -72,7 +79,8 @@ class BufferVecZeroCopyOutputStream : public ::google::protobuf::io::ZeroCopyOut
 
   bool Next(void** data, int* size) override {
     if (cur_buf_used_size_ == cur_block_size) {
-      *data = buffer_vec_.NewBuffer(cur_block_size <<= 1).first;
+      cur_block_size = std::min<size_t>(cur_block_size << 1, kMaxBlockSize);
+      *data = buffer_vec_.NewBuffer(cur_block_size).first;
       byte_count_ += (*size = cur_buf_used_size_ = cur_block_size);
     } else {
       *data = static_cast<char*>(buffer_vec_.CurBuffer().first) + cur_buf_used_size_;
@@ -107,7 +115,9 @@ class BufferVecZeroCopyOutputStream : public ::google::protobuf::io::ZeroCopyOut
   }
 
  private:
-  enum { kInitBlockSize = 256 };
+  // 块大小从kInitBlockSize开始倍增，最大不超过内存池的最大一级，保证所有块都可以由内存池复用
+  enum { kInitBlockSize = BufferPool::kMinBlockSize,
+         kMaxBlockSize = BufferPool::kMaxBlockSize };
 
   BufferVec& buffer_vec_;
   size_t cur_block_size = kInitBlockSize / 2;
@@ -120,13 +130,13 @@ class BufferVecZeroCopyInputStream : public ::google::protobuf::io::ZeroCopyInpu
   explicit BufferVecZeroCopyInputStream(BufferVec& buffer_vec)
       : buffer_vec_(buffer_vec.Vec()) {}
 
-  explicit BufferVecZeroCopyInputStream(const std::vector<std::pair<void*, size_t>>& buffer_vec)
+  explicit BufferVecZeroCopyInputStream(std::span<const std::pair<void*, size_t>> buffer_vec)
       : buffer_vec_(buffer_vec) {}
 
   virtual ~BufferVecZeroCopyInputStream() = default;
 
   bool Next(const void** data, int* size) override {
-    if (cur_buf_index_ >= buffer_vec_.size())
+    if (cur_buf_unused_size_ == 0 && cur_buf_index_ >= buffer_vec_.size())
       return false;
 
     if (cur_buf_unused_size_ == 0) {
@@ -175,7 +185,7 @@ class BufferVecZeroCopyInputStream : public ::google::protobuf::io::ZeroCopyInpu
   }
 
  private:
-  const std::vector<std::pair<void*, size_t>>& buffer_vec_;
+  std::span<const std::pair<void*, size_t>> buffer_vec_;
   size_t cur_buf_unused_size_ = 0;
   size_t cur_buf_index_ = 0;
   int64_t byte_count_ = 0;
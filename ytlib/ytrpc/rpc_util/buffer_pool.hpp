@@ -0,0 +1,118 @@
+/**
+ * @file buffer_pool.hpp
+ * @brief 按大小分级的缓冲区内存池
+ * @note 从kMinBlockSize到kMaxBlockSize按2的幂分级，每一级是一个线程缓存的对象池。
+ * 每个线程（包括运行io_context的线程）各自缓存一部分空闲内存块，在一个线程中申请、在另一个线程中释放也不会加锁。
+ * 超过kMaxBlockSize的申请直接使用malloc
+ * @author WT
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+#include "ytlib/thread/object_pool.hpp"
+
+namespace ytlib {
+namespace ytrpc {
+
+/**
+ * @brief 按大小分级的缓冲区内存池
+ * @note 只有静态接口，所有线程共用。申请到的内存大小向上取整到所在级别的大小，
+ * 内存块前有一个16字节的头部记录所在级别，因此释放时不需要传入大小
+ */
+class BufferPool {
+ public:
+  static constexpr size_t kMinBlockSize = 256;        // 最小一级的内存块大小
+  static constexpr size_t kMaxBlockSize = 64 * 1024;  // 最大一级的内存块大小
+  static constexpr size_t kClassNum = std::countr_zero(kMaxBlockSize) - std::countr_zero(kMinBlockSize) + 1;
+
+  /**
+   * @brief 申请内存
+   * @note 可以由任意线程调用，返回的内存按16字节对齐
+   * @param[in] size 需要的大小
+   * @return void* 内存地址，需要使用Deallocate释放
+   */
+  static void* Allocate(size_t size) {
+    if (size > kMaxBlockSize) [[unlikely]] {
+      Head* head = static_cast<Head*>(std::malloc(sizeof(Head) + size));
+      if (head == nullptr) [[unlikely]]
+        throw std::bad_alloc();
+      head->class_index = kClassNum;
+      return head + 1;
+    }
+
+    const size_t class_index = ClassIndex(size);
+    Head* head = AllocateFromClass(class_index, std::make_index_sequence<kClassNum>{});
+    head->class_index = class_index;
+    return head + 1;
+  }
+
+  /**
+   * @brief 释放内存
+   * @note 可以由任意线程调用，不要求与申请时是同一个线程
+   * @param[in] ptr 由Allocate申请的内存地址，可以为nullptr
+   */
+  static void Deallocate(void* ptr) {
+    if (ptr == nullptr) return;
+
+    Head* head = static_cast<Head*>(ptr) - 1;
+    if (head->class_index == kClassNum) [[unlikely]] {
+      std::free(head);
+      return;
+    }
+
+    DeallocateToClass(head, std::make_index_sequence<kClassNum>{});
+  }
+
+  /// size所在级别的内存块大小，超过kMaxBlockSize时返回size本身
+  static constexpr size_t BlockSize(size_t size) {
+    if (size > kMaxBlockSize) return size;
+    return kMinBlockSize << ClassIndex(size);
+  }
+
+ private:
+  struct alignas(16) Head {
+    size_t class_index;
+  };
+
+  template <size_t Size>
+  struct Block {
+    // 不初始化data，避免对象池值初始化时清零整个内存块
+    Block() {}
+
+    Head head;
+    unsigned char data[Size];
+  };
+
+  // 每一级的线程缓存按字节数而不是块数限制：每批约64KB，全局每一级最多缓存约1MB
+  static constexpr size_t kBatchBytes = 64 * 1024;
+  static constexpr size_t kMaxGlobalBatchNum = 16;
+
+  template <size_t Size>
+  using Pool = ObjectPool<Block<Size>, (kBatchBytes / Size > 0 ? kBatchBytes / Size : 1), kMaxGlobalBatchNum>;
+
+  static constexpr size_t ClassIndex(size_t size) {
+    if (size <= kMinBlockSize) return 0;
+    return std::bit_width(size - 1) - std::countr_zero(kMinBlockSize);
+  }
+
+  template <size_t... Indexes>
+  static Head* AllocateFromClass(size_t class_index, std::index_sequence<Indexes...>) {
+    Head* head = nullptr;
+    ((class_index == Indexes && (head = &(Pool<(kMinBlockSize << Indexes)>::New()->head))) || ...);
+    return head;
+  }
+
+  template <size_t... Indexes>
+  static void DeallocateToClass(Head* head, std::index_sequence<Indexes...>) {
+    ((head->class_index == Indexes && (Pool<(kMinBlockSize << Indexes)>::Delete(reinterpret_cast<Block<(kMinBlockSize << Indexes)>*>(head)), true)) || ...);
+  }
+};
+
+}  // namespace ytrpc
+}  // namespace ytlib
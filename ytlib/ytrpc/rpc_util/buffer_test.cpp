@@ -1,7 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <cstring>
+#include <thread>
+
 #include "Head.pb.h"
 #include "buffer.hpp"
+#include "buffer_pool.hpp"
+#include "recv_buffer.hpp"
 #include "ytlib/pb_tools/pb_tools.hpp"
 
 namespace ytlib {
@@ -130,5 +135,220 @@ TEST(RPC_UTIL_TEST, BufferVec_MISC) {
   EXPECT_STREQ(Pb2PrettyJson(req_head).c_str(), Pb2PrettyJson(req_head_1).c_str());
 }
 
+TEST(RPC_UTIL_TEST, BufferVecZeroCopyInputStream_BackUpLastBuf) {
+  BufferVec buffer_vec;
+  buffer_vec.NewBuffer(10);
+
+  BufferVecZeroCopyInputStream is(buffer_vec);
+
+  const void* data;
+  int size;
+  EXPECT_TRUE(is.Skip(4));
+
+  EXPECT_TRUE(is.Next(&data, &size));
+  EXPECT_EQ(size, 6);
+
+  is.BackUp(2);
+  EXPECT_TRUE(is.Next(&data, &size));
+  EXPECT_EQ(size, 2);
+  EXPECT_EQ(is.ByteCount(), 10);
+
+  EXPECT_FALSE(is.Next(&data, &size));
+}
+
+TEST(RPC_UTIL_TEST, BufferVecZeroCopyOutputStream_MaxBlockSize) {
+  BufferVec buffer_vec;
+  BufferVecZeroCopyOutputStream os(buffer_vec);
+
+  void* data;
+  int size;
+  size_t expect_size = BufferPool::kMinBlockSize;
+  for (size_t ii = 0; ii < 12; ++ii) {
+    EXPECT_TRUE(os.Next(&data, &size));
+    EXPECT_EQ(size, expect_size);
+    std::memset(data, 0, size);
+    expect_size = std::min(expect_size * 2, BufferPool::kMaxBlockSize);
+  }
+}
+
+TEST(RPC_UTIL_TEST, BufferPool) {
+  EXPECT_EQ(BufferPool::BlockSize(1), 256);
+  EXPECT_EQ(BufferPool::BlockSize(256), 256);
+  EXPECT_EQ(BufferPool::BlockSize(257), 512);
+  EXPECT_EQ(BufferPool::BlockSize(10000), 16384);
+  EXPECT_EQ(BufferPool::BlockSize(BufferPool::kMaxBlockSize), BufferPool::kMaxBlockSize);
+  EXPECT_EQ(BufferPool::BlockSize(BufferPool::kMaxBlockSize + 1), BufferPool::kMaxBlockSize + 1);
+
+  for (size_t size : {1, 256, 300, 4096, 50000, 65536, 100000}) {
+    void* buf = BufferPool::Allocate(size);
+    ASSERT_NE(buf, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buf) % 16, 0);
+    std::memset(buf, 0, BufferPool::BlockSize(size));
+
+    // 同一线程中释放后再申请同一级别的内存，会复用刚释放的内存块
+    BufferPool::Deallocate(buf);
+    if (size <= BufferPool::kMaxBlockSize) {
+      void* buf_2 = BufferPool::Allocate(BufferPool::BlockSize(size));
+      EXPECT_EQ(buf_2, buf);
+      BufferPool::Deallocate(buf_2);
+    }
+  }
+
+  BufferPool::Deallocate(nullptr);
+}
+
+TEST(RPC_UTIL_TEST, BufferPool_CrossThread) {
+  // 在一个线程中申请，在另一个线程中释放
+  std::vector<BufferVec> buffer_vecs(100);
+  for (auto& buffer_vec : buffer_vecs) {
+    BufferVecZeroCopyOutputStream os(buffer_vec);
+    void* data;
+    int size;
+    for (size_t ii = 0; ii < 8; ++ii) {
+      EXPECT_TRUE(os.Next(&data, &size));
+      std::memset(data, static_cast<int>(ii), size);
+    }
+  }
+
+  std::thread t([buffer_vecs{std::move(buffer_vecs)}]() mutable { buffer_vecs.clear(); });
+  t.join();
+
+  BufferVec buffer_vec;
+  const auto& buf = buffer_vec.NewBuffer(1024);
+  std::memset(buf.first, 0, buf.second);
+}
+
+TEST(RPC_UTIL_TEST, RecvBuffer) {
+  RecvBuffer recv_buffer;
+  EXPECT_EQ(recv_buffer.Size(), 0);
+
+  auto buf_vec = recv_buffer.PrepareBuffer();
+  ASSERT_EQ(buf_vec.size(), 1);
+  auto buf = buf_vec[0];
+  ASSERT_EQ(buf.second, RecvChunk::kDataSize);
+  memcpy(buf.first, "0123456789", 10);
+  recv_buffer.Commit(10);
+  EXPECT_EQ(recv_buffer.Size(), 10);
+
+  char head[4];
+  recv_buffer.Peek(head, 4);
+  EXPECT_EQ(std::string(head, 4), "0123");
+  EXPECT_EQ(recv_buffer.Size(), 10);
+
+  recv_buffer.Consume(2);
+  RecvFrame frame = recv_buffer.PopFrame(5);
+  EXPECT_EQ(recv_buffer.Size(), 3);
+  ASSERT_EQ(frame.Vec().size(), 1);
+  EXPECT_EQ(frame.Size(), 5);
+  EXPECT_EQ(std::string(static_cast<char*>(frame.Vec()[0].first), frame.Vec()[0].second), "23456");
+
+  // 数据帧直接引用内存块中的数据，后续写入追加在同一个内存块中
+  auto buf_vec_2 = recv_buffer.PrepareBuffer();
+  ASSERT_EQ(buf_vec_2.size(), 2);
+  EXPECT_EQ(static_cast<char*>(buf_vec_2[0].first), static_cast<char*>(buf.first) + 10);
+  EXPECT_EQ(buf_vec_2[0].second, RecvChunk::kDataSize - 10);
+  EXPECT_EQ(buf_vec_2[1].second, RecvChunk::kDataSize);
+  recv_buffer.Consume(3);
+
+  // 数据取完且没有数据帧引用时从头复用内存块
+  frame.Reset();
+  EXPECT_TRUE(frame.Empty());
+  auto buf_vec_3 = recv_buffer.PrepareBuffer();
+  EXPECT_EQ(buf_vec_3[0].first, buf.first);
+  EXPECT_EQ(buf_vec_3[0].second, RecvChunk::kDataSize);
+
+  // 按期望大小准备多个内存块，但不超过上限
+  EXPECT_EQ(recv_buffer.PrepareBuffer(RecvChunk::kDataSize * 3).size(), 3);
+  EXPECT_EQ(recv_buffer.PrepareBuffer(RecvChunk::kDataSize * 1000).size(), RecvBuffer::kMaxPrepareChunkNum);
+}
+
+TEST(RPC_UTIL_TEST, RecvBuffer_CrossChunk) {
+  RecvBuffer recv_buffer;
+
+  // 写入3.5个内存块大小的数据
+  const size_t data_size = RecvChunk::kDataSize * 7 / 2;
+  std::string data(data_size, '\0');
+  for (size_t ii = 0; ii < data_size; ++ii) data[ii] = static_cast<char>(ii * 7);
+
+  // 一次分散写入
+  size_t write_pos = 0;
+  for (const auto& buf : recv_buffer.PrepareBuffer(data_size)) {
+    const size_t len = std::min(buf.second, data_size - write_pos);
+    memcpy(buf.first, data.data() + write_pos, len);
+    write_pos += len;
+  }
+  recv_buffer.Commit(data_size);
+  EXPECT_EQ(recv_buffer.Size(), data_size);
+
+  const size_t offset = RecvChunk::kDataSize - 3;
+  char head[8];
+  recv_buffer.Consume(offset);
+  recv_buffer.Peek(head, 8);
+  EXPECT_EQ(std::string(head, 8), data.substr(offset, 8));
+
+  // 跨越2个内存块
+  RecvFrame frame = recv_buffer.PopFrame(10);
+  ASSERT_EQ(frame.Vec().size(), 2);
+  EXPECT_EQ(frame.Vec()[0].second, 3);
+
+  // 跨越3个内存块
+  RecvFrame frame_2 = recv_buffer.PopFrame(RecvChunk::kDataSize * 2);
+  ASSERT_EQ(frame_2.Vec().size(), 3);
+  EXPECT_EQ(recv_buffer.Size(), data_size - offset - 10 - RecvChunk::kDataSize * 2);
+
+  std::string frame_data;
+  BufferVecZeroCopyInputStream is(frame_2.Vec());
+  const void* p;
+  int size;
+  while (is.Next(&p, &size)) frame_data.append(static_cast<const char*>(p), size);
+  EXPECT_EQ(frame_data, data.substr(offset + 10, RecvChunk::kDataSize * 2));
+
+  RecvFrame frame_3(std::move(frame_2));
+  EXPECT_TRUE(frame_2.Empty());
+  EXPECT_EQ(frame_3.Vec().size(), 3);
+  frame_2 = std::move(frame);
+  EXPECT_EQ(frame_2.Size(), 10);
+}
+
+TEST(RPC_UTIL_TEST, RecvBuffer_ParsePb) {
+  ReqHead req_head;
+  req_head.set_req_id(12345);
+  req_head.set_func("/test.helloworld.gre/testfun");
+  req_head.set_ddl_ms(987654321);
+  const std::string req_head_str = req_head.SerializeAsString();
+
+  RspHead rsp_head;
+  rsp_head.set_req_id(54321);
+  rsp_head.set_func_ret_msg(std::string(RecvChunk::kDataSize, 'x'));
+  const std::string rsp_head_str = rsp_head.SerializeAsString();
+
+  const std::string data = req_head_str + rsp_head_str;
+
+  RecvBuffer recv_buffer;
+  size_t write_pos = 0;
+  while (write_pos < data.size()) {
+    auto buf = recv_buffer.PrepareBuffer()[0];
+    const size_t len = std::min<size_t>({buf.second, data.size() - write_pos, 1000});
+    memcpy(buf.first, data.data() + write_pos, len);
+    recv_buffer.Commit(len);
+    write_pos += len;
+  }
+
+  RecvFrame frame = recv_buffer.PopFrame(data.size());
+  ASSERT_EQ(frame.Vec().size(), 2);
+
+  ReqHead req_head_1;
+  BufferVecZeroCopyInputStream is(frame.Vec());
+  EXPECT_TRUE(req_head_1.ParseFromBoundedZeroCopyStream(&is, req_head_str.size()));
+  EXPECT_STREQ(Pb2PrettyJson(req_head).c_str(), Pb2PrettyJson(req_head_1).c_str());
+
+  RspHead rsp_head_1;
+  BufferVecZeroCopyInputStream is_2(frame.Vec());
+  EXPECT_TRUE(is_2.Skip(req_head_str.size()));
+  EXPECT_TRUE(rsp_head_1.ParseFromZeroCopyStream(&is_2));
+  EXPECT_EQ(rsp_head_1.req_id(), 54321);
+  EXPECT_EQ(rsp_head_1.func_ret_msg(), rsp_head.func_ret_msg());
+}
+
 }  // namespace ytrpc
 }  // namespace ytlib
@@ -0,0 +1,278 @@
+/**
+ * @file pending_request.hpp
+ * @brief 等待回包的请求表与超时时间轮
+ * @note 两者都是侵入式的，请求对象继承PendingRequestHook，加入/移除时不申请内存。
+ * 都不是线程安全的，需要在同一个strand中使用
+ * @author WT
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace ytlib {
+namespace ytrpc {
+
+/**
+ * @brief 等待回包的请求的挂钩
+ * @note 请求对象需要继承此结构，同时挂在PendingRequestTable与DeadlineWheel中
+ */
+struct PendingRequestHook {
+  uint32_t req_id = 0;
+
+  PendingRequestHook* table_next = nullptr;  // 请求表同一个桶中的下一个请求
+
+  uint64_t wheel_tick = 0;                   // 在时间轮中到期的tick
+  PendingRequestHook* wheel_prev = nullptr;  // 时间轮同一个槽位中的上一个请求
+  PendingRequestHook* wheel_next = nullptr;  // 时间轮同一个槽位中的下一个请求
+  bool wheel_linked = false;                 // 是否在时间轮中
+};
+
+/**
+ * @brief 按req_id索引的等待回包请求表
+ * @note 开链哈希表，桶数为2的幂，请求数超过桶数时翻倍。req_id是递增分配的，直接取低位即可均匀分布
+ * @tparam T 请求类型，需要继承PendingRequestHook
+ */
+template <typename T>
+  requires std::is_base_of_v<PendingRequestHook, T>
+class PendingRequestTable {
+ public:
+  explicit PendingRequestTable(size_t init_bucket_num = 64)
+      : bucket_vec_(std::bit_ceil(std::max<size_t>(init_bucket_num, 1)), nullptr) {}
+
+  ~PendingRequestTable() = default;
+
+  PendingRequestTable(const PendingRequestTable&) = delete;
+  PendingRequestTable& operator=(const PendingRequestTable&) = delete;
+
+  /**
+   * @brief 加入请求
+   * @param[in] req 请求，其req_id不能与表中已有的请求重复
+   */
+  void Insert(T* req) {
+    if (size_ >= bucket_vec_.size()) [[unlikely]]
+      Rehash(bucket_vec_.size() << 1);
+
+    PendingRequestHook*& head = bucket_vec_[req->req_id & (bucket_vec_.size() - 1)];
+    req->table_next = head;
+    head = req;
+    ++size_;
+  }
+
+  /**
+   * @brief 取出req_id对应的请求
+   * @param[in] req_id 请求id
+   * @return T* 请求，不存在时返回nullptr
+   */
+  T* Erase(uint32_t req_id) {
+    for (PendingRequestHook** cur_ptr = &bucket_vec_[req_id & (bucket_vec_.size() - 1)]; *cur_ptr != nullptr; cur_ptr = &((*cur_ptr)->table_next)) {
+      PendingRequestHook* req = *cur_ptr;
+      if (req->req_id == req_id) {
+        *cur_ptr = req->table_next;
+        req->table_next = nullptr;
+        --size_;
+        return static_cast<T*>(req);
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief 取出所有请求
+   * @param[in] func 对每个取出的请求调用func(T*)，调用时请求已经不在表中
+   */
+  template <typename Func>
+  void Clear(Func&& func) {
+    for (auto& head : bucket_vec_) {
+      while (head != nullptr) {
+        PendingRequestHook* req = head;
+        head = req->table_next;
+        req->table_next = nullptr;
+        --size_;
+        func(static_cast<T*>(req));
+      }
+    }
+  }
+
+  size_t Size() const { return size_; }
+
+  bool Empty() const { return size_ == 0; }
+
+ private:
+  void Rehash(size_t bucket_num) {
+    std::vector<PendingRequestHook*> new_bucket_vec(bucket_num, nullptr);
+    for (auto head : bucket_vec_) {
+      while (head != nullptr) {
+        PendingRequestHook* req = head;
+        head = req->table_next;
+
+        PendingRequestHook*& new_head = new_bucket_vec[req->req_id & (bucket_num - 1)];
+        req->table_next = new_head;
+        new_head = req;
+      }
+    }
+    bucket_vec_.swap(new_bucket_vec);
+  }
+
+  std::vector<PendingRequestHook*> bucket_vec_;
+  size_t size_ = 0;
+};
+
+/**
+ * @brief 等待回包请求的超时时间轮
+ * @note 哈希时间轮，每个槽位是一个双向链表，加入/移除都是O(1)。
+ * 超过一圈的请求留在槽位中，直到所在的tick到来才取出。请求最多比deadline晚一个tick超时，不会提前超时。
+ * 外部只需要一个定时器，等待到NextExpireTime后调用Expire
+ * @tparam T 请求类型，需要继承PendingRequestHook
+ */
+template <typename T>
+  requires std::is_base_of_v<PendingRequestHook, T>
+class DeadlineWheel {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief 时间轮构造函数
+   *
+   * @param[in] tick 精度
+   * @param[in] slot_num 槽位数，向上取整为2的幂
+   * @param[in] start_time 第0个tick的时间
+   */
+  explicit DeadlineWheel(Clock::duration tick = std::chrono::milliseconds(1), size_t slot_num = 1024, Clock::time_point start_time = Clock::now())
+      : tick_(std::max(tick, Clock::duration(1))),
+        start_time_(start_time),
+        slot_vec_(std::bit_ceil(std::max<size_t>(slot_num, 1)), nullptr) {}
+
+  ~DeadlineWheel() = default;
+
+  DeadlineWheel(const DeadlineWheel&) = delete;
+  DeadlineWheel& operator=(const DeadlineWheel&) = delete;
+
+  /**
+   * @brief 加入请求
+   * @note 已经过期的请求会在下一个tick到期
+   * @param[in] req 请求，不能已经在时间轮中
+   * @param[in] deadline 截止时间，为Clock::time_point::max()时表示不会超时，不加入时间轮
+   * @return Clock::time_point 请求实际到期的时间，不加入时间轮时返回Clock::time_point::max()
+   */
+  Clock::time_point Insert(T* req, Clock::time_point deadline) {
+    if (deadline == Clock::time_point::max()) return Clock::time_point::max();
+
+    uint64_t expire_tick = 0;
+    if (deadline > start_time_) {
+      const Clock::duration diff = deadline - start_time_;
+      expire_tick = diff / tick_ + ((diff % tick_) != Clock::duration::zero());
+    }
+    expire_tick = std::max(expire_tick, cur_tick_ + 1);
+
+    PendingRequestHook*& head = slot_vec_[expire_tick & (slot_vec_.size() - 1)];
+    req->wheel_tick = expire_tick;
+    req->wheel_prev = nullptr;
+    req->wheel_next = head;
+    if (head != nullptr) head->wheel_prev = req;
+    head = req;
+    req->wheel_linked = true;
+    ++size_;
+
+    return TickTime(expire_tick);
+  }
+
+  /**
+   * @brief 移除请求
+   * @param[in] req 请求，不在时间轮中时什么都不做
+   */
+  void Remove(T* req) {
+    if (!req->wheel_linked) return;
+
+    Unlink(req);
+  }
+
+  /**
+   * @brief 取出所有在now之前到期的请求
+   * @param[in] now 当前时间
+   * @param[in] func 对每个到期的请求调用func(T*)，调用时所有到期的请求都已经不在时间轮中
+   */
+  template <typename Func>
+  void Expire(Clock::time_point now, Func&& func) {
+    if (now < start_time_) return;
+
+    const uint64_t now_tick = (now - start_time_) / tick_;
+    if (now_tick <= cur_tick_) return;
+
+    // 先把到期的请求摘下来串成单链表，再统一回调，回调中可以再操作时间轮
+    PendingRequestHook* expired_head = nullptr;
+    const uint64_t step_num = std::min<uint64_t>(now_tick - cur_tick_, slot_vec_.size());
+    for (uint64_t ii = 1; ii <= step_num && size_ > 0; ++ii) {
+      PendingRequestHook* req = slot_vec_[(cur_tick_ + ii) & (slot_vec_.size() - 1)];
+      while (req != nullptr) {
+        PendingRequestHook* next_req = req->wheel_next;
+        if (req->wheel_tick <= now_tick) {
+          Unlink(req);
+          req->wheel_next = expired_head;
+          expired_head = req;
+        }
+        req = next_req;
+      }
+    }
+    cur_tick_ = now_tick;
+
+    while (expired_head != nullptr) {
+      PendingRequestHook* req = expired_head;
+      expired_head = req->wheel_next;
+      req->wheel_next = nullptr;
+      func(static_cast<T*>(req));
+    }
+  }
+
+  /**
+   * @brief 下一次需要调用Expire的时间
+   * @note 返回最近一个非空槽位的时间，槽位中的请求可能要在之后的某一圈才到期
+   * @return Clock::time_point 时间轮为空时返回Clock::time_point::max()
+   */
+  Clock::time_point NextExpireTime() const {
+    if (size_ == 0) return Clock::time_point::max();
+
+    for (uint64_t ii = 1; ii <= slot_vec_.size(); ++ii) {
+      if (slot_vec_[(cur_tick_ + ii) & (slot_vec_.size() - 1)] != nullptr)
+        return TickTime(cur_tick_ + ii);
+    }
+    return Clock::time_point::max();
+  }
+
+  size_t Size() const { return size_; }
+
+  bool Empty() const { return size_ == 0; }
+
+ private:
+  Clock::time_point TickTime(uint64_t tick) const {
+    return start_time_ + tick_ * static_cast<Clock::rep>(tick);
+  }
+
+  void Unlink(PendingRequestHook* req) {
+    if (req->wheel_prev != nullptr) {
+      req->wheel_prev->wheel_next = req->wheel_next;
+    } else {
+      slot_vec_[req->wheel_tick & (slot_vec_.size() - 1)] = req->wheel_next;
+    }
+    if (req->wheel_next != nullptr) req->wheel_next->wheel_prev = req->wheel_prev;
+
+    req->wheel_prev = nullptr;
+    req->wheel_next = nullptr;
+    req->wheel_linked = false;
+    --size_;
+  }
+
+  const Clock::duration tick_;
+  const Clock::time_point start_time_;
+  std::vector<PendingRequestHook*> slot_vec_;
+  uint64_t cur_tick_ = 0;  // 已经处理过的最后一个tick
+  size_t size_ = 0;
+};
+
+}  // namespace ytrpc
+}  // namespace ytlib
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <vector>
+
+#include "pending_request.hpp"
+
+namespace ytlib {
+namespace ytrpc {
+
+struct TestPendingRequest : public PendingRequestHook {
+  explicit TestPendingRequest(uint32_t input_req_id) { req_id = input_req_id; }
+};
+
+TEST(RPC_UTIL_TEST, PendingRequestTable) {
+  PendingRequestTable<TestPendingRequest> table(4);
+
+  std::vector<TestPendingRequest> req_vec;
+  for (uint32_t ii = 0; ii < 100; ++ii) req_vec.emplace_back(ii * 3 + 1);
+
+  for (auto& req : req_vec) table.Insert(&req);
+  EXPECT_EQ(table.Size(), req_vec.size());
+
+  // 扩容后仍然能找到所有请求
+  for (uint32_t ii = 0; ii < 100; ii += 2) {
+    EXPECT_EQ(table.Erase(ii * 3 + 1), &req_vec[ii]);
+  }
+  EXPECT_EQ(table.Size(), 50);
+
+  EXPECT_EQ(table.Erase(1), nullptr);
+  EXPECT_EQ(table.Erase(2), nullptr);
+  EXPECT_EQ(table.Size(), 50);
+
+  std::set<uint32_t> clear_id_set;
+  table.Clear([&clear_id_set](TestPendingRequest* req) { clear_id_set.emplace(req->req_id); });
+  EXPECT_TRUE(table.Empty());
+  EXPECT_EQ(clear_id_set.size(), 50);
+  for (uint32_t ii = 1; ii < 100; ii += 2) {
+    EXPECT_TRUE(clear_id_set.contains(ii * 3 + 1));
+  }
+}
+
+TEST(RPC_UTIL_TEST, DeadlineWheel) {
+  using Clock = DeadlineWheel<TestPendingRequest>::Clock;
+  const auto start_time = Clock::now();
+  const auto tick = std::chrono::milliseconds(1);
+
+  DeadlineWheel<TestPendingRequest> wheel(tick, 8, start_time);
+  EXPECT_EQ(wheel.NextExpireTime(), Clock::time_point::max());
+
+  TestPendingRequest req1(1), req2(2), req3(3), req4(4), req5(5);
+
+  // 不满一个tick的向上取整，不会提前超时
+  EXPECT_EQ(wheel.Insert(&req1, start_time + std::chrono::microseconds(2500)), start_time + 3 * tick);
+  EXPECT_EQ(wheel.Insert(&req2, start_time + 3 * tick), start_time + 3 * tick);
+  // 超过一圈
+  EXPECT_EQ(wheel.Insert(&req3, start_time + 11 * tick), start_time + 11 * tick);
+  // 不会超时
+  EXPECT_EQ(wheel.Insert(&req4, Clock::time_point::max()), Clock::time_point::max());
+  // 已经过期
+  EXPECT_EQ(wheel.Insert(&req5, start_time - tick), start_time + tick);
+
+  EXPECT_EQ(wheel.Size(), 4);
+  EXPECT_EQ(wheel.NextExpireTime(), start_time + tick);
+
+  std::set<uint32_t> expired_id_set;
+  auto expire_func = [&expired_id_set](TestPendingRequest* req) { expired_id_set.emplace(req->req_id); };
+
+  wheel.Expire(start_time + tick, expire_func);
+  EXPECT_EQ(expired_id_set, std::set<uint32_t>({5}));
+  EXPECT_EQ(wheel.NextExpireTime(), start_time + 3 * tick);
+
+  wheel.Remove(&req2);
+  wheel.Remove(&req4);
+  EXPECT_EQ(wheel.Size(), 2);
+
+  expired_id_set.clear();
+  wheel.Expire(start_time + std::chrono::microseconds(2900), expire_func);
+  EXPECT_TRUE(expired_id_set.empty());
+
+  wheel.Expire(start_time + 3 * tick, expire_func);
+  EXPECT_EQ(expired_id_set, std::set<uint32_t>({1}));
+
+  // req3所在的槽位在第3个tick之后第一次出现，此时还没有到期
+  EXPECT_EQ(wheel.NextExpireTime(), start_time + 11 * tick);
+
+  expired_id_set.clear();
+  wheel.Expire(start_time + 10 * tick, expire_func);
+  EXPECT_TRUE(expired_id_set.empty());
+
+  // 跳过多圈时也能取出
+  wheel.Expire(start_time + 100 * tick, expire_func);
+  EXPECT_EQ(expired_id_set, std::set<uint32_t>({3}));
+  EXPECT_TRUE(wheel.Empty());
+  EXPECT_EQ(wheel.NextExpireTime(), Clock::time_point::max());
+
+  // 回调中可以重新加入
+  expired_id_set.clear();
+  wheel.Insert(&req1, start_time + 101 * tick);
+  wheel.Expire(start_time + 101 * tick, [&](TestPendingRequest* req) {
+    expired_id_set.emplace(req->req_id);
+    if (req->req_id == 1) wheel.Insert(&req2, start_time + 102 * tick);
+  });
+  EXPECT_EQ(expired_id_set, std::set<uint32_t>({1}));
+  EXPECT_EQ(wheel.NextExpireTime(), start_time + 102 * tick);
+}
+
+}  // namespace ytrpc
+}  // namespace ytlib
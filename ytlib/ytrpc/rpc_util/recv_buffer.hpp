@@ -0,0 +1,352 @@
+/**
+ * @file recv_buffer.hpp
+ * @brief 基于引用计数内存块链的接收缓冲区
+ * @note 内存块从对象池中分配，从缓冲区中切出的数据帧持有其所在内存块的引用，不需要拷贝数据。
+ * 跨内存块的数据帧可以通过BufferVecZeroCopyInputStream解析
+ * @author WT
+ * @date 2026-10-17
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "ytlib/thread/object_pool.hpp"
+
+namespace ytlib {
+namespace ytrpc {
+
+/**
+ * @brief 接收缓冲区的内存块
+ * @note 定长，带引用计数，引用计数归零时归还到对象池
+ */
+class RecvChunk {
+ public:
+  static constexpr size_t kChunkSize = 8192;                            // 内存块总大小
+  static constexpr size_t kDataSize = kChunkSize - 2 * sizeof(void*);  // 内存块中可存放数据的大小
+
+  /// 创建一个内存块，引用计数为1
+  static RecvChunk* New() { return Pool::New(); }
+
+  // 不初始化data_，避免对象池值初始化时清零整个内存块
+  RecvChunk() {}
+  ~RecvChunk() = default;
+
+  RecvChunk(const RecvChunk&) = delete;
+  RecvChunk& operator=(const RecvChunk&) = delete;
+
+  void AddRef() { ref_count_.fetch_add(1, std::memory_order_relaxed); }
+
+  void Release() {
+    if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) Pool::Delete(this);
+  }
+
+  /// 是否只有一个引用
+  bool Unique() const { return ref_count_.load(std::memory_order_acquire) == 1; }
+
+  char* Data() { return data_; }
+
+  /// 链中的下一个内存块，只有在本内存块已写满且持有下一个内存块的引用时才能访问
+  RecvChunk* Next() const { return next_; }
+
+ private:
+  friend class RecvBuffer;
+
+  using Pool = ObjectPool<RecvChunk, 8, 64>;
+
+  std::atomic<uint32_t> ref_count_ = 1;
+  RecvChunk* next_ = nullptr;
+  char data_[kDataSize];
+};
+
+static_assert(sizeof(RecvChunk) == RecvChunk::kChunkSize, "RecvChunk size mismatch");
+
+/**
+ * @brief 从接收缓冲区中切出的一段数据
+ * @note 持有数据所在的各个内存块的引用，只能移动。可以在任意线程中使用和销毁
+ */
+class RecvFrame {
+ public:
+  RecvFrame() = default;
+  ~RecvFrame() { Reset(); }
+
+  RecvFrame(RecvFrame&& other) noexcept { MoveFrom(other); }
+
+  RecvFrame& operator=(RecvFrame&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  RecvFrame(const RecvFrame&) = delete;
+  RecvFrame& operator=(const RecvFrame&) = delete;
+
+  /// 数据总大小
+  size_t Size() const { return size_; }
+
+  bool Empty() const { return size_ == 0; }
+
+  /// 数据所在的各段内存，可用于构造BufferVecZeroCopyInputStream
+  std::span<const std::pair<void*, size_t>> Vec() const {
+    if (chunk_num_ <= inline_vec_.size()) return {inline_vec_.data(), chunk_num_};
+    return vec_;
+  }
+
+  /// 释放持有的内存块
+  void Reset() {
+    // 最后一个内存块的next_可能正在被接收缓冲区修改，不能读取
+    RecvChunk* chunk = first_chunk_;
+    for (size_t ii = 1; ii < chunk_num_; ++ii) {
+      RecvChunk* next = chunk->Next();
+      chunk->Release();
+      chunk = next;
+    }
+    if (chunk != nullptr) chunk->Release();
+
+    first_chunk_ = nullptr;
+    chunk_num_ = 0;
+    size_ = 0;
+    vec_.clear();
+  }
+
+ private:
+  friend class RecvBuffer;
+
+  void Append(RecvChunk* chunk, void* data, size_t len) {
+    chunk->AddRef();
+    if (chunk_num_ == 0) first_chunk_ = chunk;
+
+    if (chunk_num_ < inline_vec_.size()) {
+      inline_vec_[chunk_num_] = {data, len};
+    } else {
+      if (chunk_num_ == inline_vec_.size()) vec_.assign(inline_vec_.begin(), inline_vec_.end());
+      vec_.emplace_back(data, len);
+    }
+
+    ++chunk_num_;
+    size_ += len;
+  }
+
+  void MoveFrom(RecvFrame& other) {
+    first_chunk_ = std::exchange(other.first_chunk_, nullptr);
+    chunk_num_ = std::exchange(other.chunk_num_, 0);
+    size_ = std::exchange(other.size_, 0);
+    inline_vec_ = other.inline_vec_;
+    vec_ = std::move(other.vec_);
+    other.vec_.clear();
+  }
+
+  RecvChunk* first_chunk_ = nullptr;
+  size_t chunk_num_ = 0;
+  size_t size_ = 0;
+
+  // 绝大多数数据帧最多跨越2个内存块，此时不需要申请内存
+  std::array<std::pair<void*, size_t>, 2> inline_vec_;
+  std::vector<std::pair<void*, size_t>> vec_;
+};
+
+/**
+ * @brief 接收缓冲区
+ * @note 由内存块组成的链，新数据依次写入各个内存块，可以一次准备多个内存块用于分散读。
+ * 数据全部被取走且当前写入的内存块没有被数据帧引用时，从头复用该内存块。非线程安全
+ */
+class RecvBuffer {
+ public:
+  static constexpr size_t kMaxPrepareChunkNum = 64;  // 一次最多准备的内存块数
+
+  RecvBuffer() = default;
+
+  ~RecvBuffer() {
+    while (head_ != nullptr) {
+      RecvChunk* next = (head_ == tail_) ? nullptr : head_->next_;
+      head_->Release();
+      head_ = next;
+    }
+  }
+
+  RecvBuffer(const RecvBuffer&) = delete;
+  RecvBuffer& operator=(const RecvBuffer&) = delete;
+
+  /**
+   * @brief 获取可写入的空间
+   * @note 至少准备一个内存块大小的空间，可以通过min_size多准备一些，但不超过kMaxPrepareChunkNum个内存块，
+   * 之前多准备的内存块会被释放。写入后需要调用Commit提交实际写入的大小，
+   * 返回值在下次调用PrepareBuffer之前有效
+   * @param[in] min_size 期望的最小可写入空间
+   * @return std::span<const std::pair<void*, size_t>> 可写入的各段空间
+   */
+  std::span<const std::pair<void*, size_t>> PrepareBuffer(size_t min_size = 0) {
+    if (tail_ == nullptr) {
+      head_ = write_chunk_ = tail_ = RecvChunk::New();
+    } else if (size_ == 0 && write_chunk_->Unique()) {
+      // 数据已全部取走，且没有数据帧引用当前写入的内存块，从头复用
+      read_pos_ = write_pos_ = 0;
+    } else if (write_pos_ == RecvChunk::kDataSize) {
+      // 此时write_chunk_一定是tail_
+      RecvChunk* chunk = RecvChunk::New();
+      if (size_ == 0) {
+        tail_->Release();
+        head_ = chunk;
+        read_pos_ = 0;
+      } else {
+        tail_->next_ = chunk;
+      }
+      write_chunk_ = tail_ = chunk;
+      write_pos_ = 0;
+    }
+
+    // 按目标大小保留预先准备的内存块，多余的释放，不足的追加
+    const size_t max_size = RecvChunk::kDataSize * kMaxPrepareChunkNum;
+    const size_t target_size = std::min(std::max(min_size, RecvChunk::kDataSize), max_size);
+    size_t writable_size = RecvChunk::kDataSize - write_pos_;
+    RecvChunk* last_chunk = write_chunk_;
+    size_t spare_chunk_num = 0;
+    while (writable_size < target_size && last_chunk != tail_) {
+      last_chunk = last_chunk->next_;
+      ++spare_chunk_num;
+      writable_size += RecvChunk::kDataSize;
+    }
+
+    if (last_chunk != tail_) {
+      RecvChunk* chunk = last_chunk->next_;
+      while (chunk != nullptr) {
+        RecvChunk* next = (chunk == tail_) ? nullptr : chunk->next_;
+        chunk->Release();
+        chunk = next;
+      }
+      last_chunk->next_ = nullptr;
+      tail_ = last_chunk;
+    }
+
+    while (writable_size < target_size) {
+      RecvChunk* chunk = RecvChunk::New();
+      tail_->next_ = chunk;
+      tail_ = chunk;
+      ++spare_chunk_num;
+      writable_size += RecvChunk::kDataSize;
+    }
+    spare_chunk_num_ = spare_chunk_num;
+
+    prepared_vec_.clear();
+    prepared_vec_.emplace_back(write_chunk_->Data() + write_pos_, RecvChunk::kDataSize - write_pos_);
+    for (RecvChunk* chunk = write_chunk_; chunk != tail_;) {
+      chunk = chunk->next_;
+      prepared_vec_.emplace_back(chunk->Data(), RecvChunk::kDataSize);
+    }
+
+    return prepared_vec_;
+  }
+
+  /// 提交实际写入的大小，必须不大于PrepareBuffer返回的空间大小
+  void Commit(size_t len) {
+    size_ += len;
+    for (;;) {
+      const size_t cur_len = std::min(len, RecvChunk::kDataSize - write_pos_);
+      write_pos_ += cur_len;
+      len -= cur_len;
+
+      if (write_pos_ == RecvChunk::kDataSize && write_chunk_ != tail_) {
+        write_chunk_ = write_chunk_->next_;
+        write_pos_ = 0;
+        --spare_chunk_num_;
+      }
+
+      if (len == 0) break;
+    }
+  }
+
+  /// 未取走的数据大小
+  size_t Size() const { return size_; }
+
+  /**
+   * @brief 拷贝出开头的一段数据，不取走
+   * @note 用于读取包头，len必须不大于Size()
+   * @param[out] buf
+   * @param[in] len
+   */
+  void Peek(void* buf, size_t len) const {
+    char* out = static_cast<char*>(buf);
+    RecvChunk* chunk = head_;
+    size_t pos = read_pos_;
+    while (len) {
+      if (pos == RecvChunk::kDataSize) {
+        chunk = chunk->next_;
+        pos = 0;
+      }
+      const size_t cur_len = std::min(len, ChunkEnd(chunk) - pos);
+      memcpy(out, chunk->Data() + pos, cur_len);
+      out += cur_len;
+      pos += cur_len;
+      len -= cur_len;
+    }
+  }
+
+  /// 丢弃开头的len字节数据，len必须不大于Size()
+  void Consume(size_t len) {
+    Advance(len, [](RecvChunk*, char*, size_t) {});
+  }
+
+  /**
+   * @brief 取走开头的len字节数据
+   * @note len必须不大于Size()
+   * @param[in] len
+   * @return RecvFrame 持有数据所在内存块引用的数据帧
+   */
+  RecvFrame PopFrame(size_t len) {
+    RecvFrame frame;
+    if (len == 0) return frame;
+
+    const size_t chunk_num = (read_pos_ + len + RecvChunk::kDataSize - 1) / RecvChunk::kDataSize;
+    if (chunk_num > frame.inline_vec_.size()) frame.vec_.reserve(chunk_num);
+
+    Advance(len, [&frame](RecvChunk* chunk, char* data, size_t cur_len) {
+      frame.Append(chunk, data, cur_len);
+    });
+    return frame;
+  }
+
+ private:
+  size_t ChunkEnd(const RecvChunk* chunk) const {
+    return (chunk == write_chunk_) ? write_pos_ : RecvChunk::kDataSize;
+  }
+
+  template <typename F>
+  void Advance(size_t len, F&& f) {
+    size_ -= len;
+    while (len) {
+      const size_t cur_len = std::min(len, ChunkEnd(head_) - read_pos_);
+      f(head_, head_->Data() + read_pos_, cur_len);
+      read_pos_ += cur_len;
+      len -= cur_len;
+
+      // 已写满的内存块读完后释放
+      if (read_pos_ == RecvChunk::kDataSize && head_ != write_chunk_) {
+        RecvChunk* next = head_->next_;
+        head_->Release();
+        head_ = next;
+        read_pos_ = 0;
+      }
+    }
+  }
+
+  RecvChunk* head_ = nullptr;         // 第一个有未取走数据的内存块
+  RecvChunk* write_chunk_ = nullptr;  // 正在写入的内存块
+  RecvChunk* tail_ = nullptr;         // 最后一个内存块，write_chunk_之后的内存块都是预先准备的空内存块
+  size_t read_pos_ = 0;               // head_中未取走数据的起始位置
+  size_t write_pos_ = 0;              // write_chunk_中已写入数据的结束位置
+  size_t spare_chunk_num_ = 0;        // write_chunk_之后的内存块数
+  size_t size_ = 0;                   // 未取走的数据大小
+
+  std::vector<std::pair<void*, size_t>> prepared_vec_;
+};
+
+}  // namespace ytrpc
+}  // namespace ytlib